@@ -0,0 +1,70 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <string>
+
+#include <APMath/APFloat.h>
+
+#include "Bench.h"
+
+using namespace APMath;
+using bench::name;
+
+/// `APFloat` only supports single and double precision, so it is measured at
+/// 32 and 64 bits
+TEST_CASE("APFloat arithmetic", "[APFloat]") {
+    APFloatPrec const prec =
+        GENERATE(APFloatPrec::Single(), APFloatPrec::Double());
+    size_t const bw = prec.totalBitwidth();
+    APFloat const x(1.2345, prec);
+    APFloat const y(0.6789, prec);
+    BENCHMARK(name("APFloat.add", bw)) { return add(x, y); };
+    BENCHMARK(name("APFloat.sub", bw)) { return sub(x, y); };
+    BENCHMARK(name("APFloat.mul", bw)) { return mul(x, y); };
+    BENCHMARK(name("APFloat.div", bw)) { return div(x, y); };
+    BENCHMARK(name("APFloat.negate", bw)) { return negate(x); };
+    BENCHMARK(name("APFloat.abs", bw)) { return abs(x); };
+    BENCHMARK(name("APFloat.cmp", bw)) { return cmp(x, y); };
+    BENCHMARK(name("APFloat.precisionCast", bw)) {
+        return precisionCast(x, APFloatPrec::Double());
+    };
+    BENCHMARK(name("APFloat.hash", bw)) { return x.hash(); };
+}
+
+TEST_CASE("APFloat math functions", "[APFloat]") {
+    APFloatPrec const prec =
+        GENERATE(APFloatPrec::Single(), APFloatPrec::Double());
+    size_t const bw = prec.totalBitwidth();
+    APFloat const x(1.2345, prec);
+    /// Inside the domain of `asin()` and `acos()`
+    APFloat const y(0.6789, prec);
+    BENCHMARK(name("APFloat.exp", bw)) { return exp(x); };
+    BENCHMARK(name("APFloat.exp2", bw)) { return exp2(x); };
+    BENCHMARK(name("APFloat.exp10", bw)) { return exp10(x); };
+    BENCHMARK(name("APFloat.log", bw)) { return log(x); };
+    BENCHMARK(name("APFloat.log2", bw)) { return log2(x); };
+    BENCHMARK(name("APFloat.log10", bw)) { return log10(x); };
+    BENCHMARK(name("APFloat.pow", bw)) { return pow(x, y); };
+    BENCHMARK(name("APFloat.sqrt", bw)) { return sqrt(x); };
+    BENCHMARK(name("APFloat.cbrt", bw)) { return cbrt(x); };
+    BENCHMARK(name("APFloat.hypot", bw)) { return hypot(x, y); };
+    BENCHMARK(name("APFloat.sin", bw)) { return sin(x); };
+    BENCHMARK(name("APFloat.cos", bw)) { return cos(x); };
+    BENCHMARK(name("APFloat.tan", bw)) { return tan(x); };
+    BENCHMARK(name("APFloat.asin", bw)) { return asin(y); };
+    BENCHMARK(name("APFloat.acos", bw)) { return acos(y); };
+    BENCHMARK(name("APFloat.atan", bw)) { return atan(x); };
+}
+
+TEST_CASE("APFloat string conversion", "[APFloat]") {
+    APFloatPrec const prec =
+        GENERATE(APFloatPrec::Single(), APFloatPrec::Double());
+    size_t const bw = prec.totalBitwidth();
+    APFloat const x(1.2345, prec);
+    std::string const str = x.toString();
+    BENCHMARK(name("APFloat.toString", bw)) { return x.toString(); };
+    BENCHMARK(name("APFloat.parse", bw)) {
+        return APFloat::parse(str, prec);
+    };
+}
@@ -0,0 +1,177 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <vector>
+
+#include <APMath/APInt.h>
+
+#include "Bench.h"
+
+using namespace APMath;
+using bench::name;
+using bench::randomAPInt;
+
+/// Random operands of one bitwidth that satisfy the preconditions of all
+/// benchmarked operations
+struct Operands {
+    explicit Operands(size_t bitwidth): rng(bitwidth), bw(bitwidth) {
+        a = randomAPInt(rng, bw);
+        b = randomAPInt(rng, bw);
+        /// Nonzero and at most half as wide as the operands, so divisions
+        /// compute a quotient of nontrivial length
+        divisor = btwor(lshr(randomAPInt(rng, bw), int(bw / 2)),
+                        APInt(1, bw));
+        /// The product has its top bit clear, so it is also exactly divisible
+        /// by `divisor` when interpreted as a signed integer
+        int const quotientShift = int(std::min(bw - bw / 2 + 1, bw - 1));
+        multiple = mul(lshr(randomAPInt(rng, bw), quotientShift), divisor);
+        shift = int(bw / 3);
+    }
+
+    std::mt19937_64 rng;
+    size_t bw;
+    APInt a, b, divisor, multiple;
+    int shift;
+};
+
+TEST_CASE("APInt arithmetic", "[APInt]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    Operands ops(bw);
+    BENCHMARK(name("APInt.add", bw)) { return add(ops.a, ops.b); };
+    BENCHMARK(name("APInt.sub", bw)) { return sub(ops.a, ops.b); };
+    BENCHMARK(name("APInt.mul", bw)) { return mul(ops.a, ops.b); };
+    BENCHMARK(name("APInt.negate", bw)) { return negate(ops.a); };
+    BENCHMARK(name("APInt.abs", bw)) { return abs(ops.a); };
+}
+
+TEST_CASE("APInt division", "[APInt]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    Operands ops(bw);
+    BENCHMARK(name("APInt.udivrem", bw)) {
+        return udivrem(ops.a, ops.divisor);
+    };
+    BENCHMARK(name("APInt.udiv", bw)) { return udiv(ops.a, ops.divisor); };
+    BENCHMARK(name("APInt.urem", bw)) { return urem(ops.a, ops.divisor); };
+    BENCHMARK(name("APInt.sdivrem", bw)) {
+        return sdivrem(ops.a, ops.divisor);
+    };
+    BENCHMARK(name("APInt.sdiv", bw)) { return sdiv(ops.a, ops.divisor); };
+    BENCHMARK(name("APInt.srem", bw)) { return srem(ops.a, ops.divisor); };
+    BENCHMARK(name("APInt.divExact", bw)) {
+        return divExact(ops.multiple, ops.divisor);
+    };
+    BENCHMARK(name("APInt.sdivExact", bw)) {
+        return sdivExact(ops.multiple, ops.divisor);
+    };
+}
+
+TEST_CASE("APInt bitwise", "[APInt]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    Operands ops(bw);
+    BENCHMARK(name("APInt.btwand", bw)) { return btwand(ops.a, ops.b); };
+    BENCHMARK(name("APInt.btwor", bw)) { return btwor(ops.a, ops.b); };
+    BENCHMARK(name("APInt.btwxor", bw)) { return btwxor(ops.a, ops.b); };
+    BENCHMARK(name("APInt.btwnot", bw)) { return btwnot(ops.a); };
+    BENCHMARK(name("APInt.lshl", bw)) { return lshl(ops.a, ops.shift); };
+    BENCHMARK(name("APInt.lshr", bw)) { return lshr(ops.a, ops.shift); };
+    BENCHMARK(name("APInt.ashl", bw)) { return ashl(ops.a, ops.shift); };
+    BENCHMARK(name("APInt.ashr", bw)) { return ashr(ops.a, ops.shift); };
+    BENCHMARK(name("APInt.rotl", bw)) { return rotl(ops.a, ops.shift); };
+    BENCHMARK(name("APInt.rotr", bw)) { return rotr(ops.a, ops.shift); };
+    BENCHMARK(name("APInt.fshl", bw)) { return fshl(ops.a, ops.b, ops.shift); };
+    BENCHMARK(name("APInt.fshr", bw)) { return fshr(ops.a, ops.b, ops.shift); };
+    if (bw % 8 == 0) {
+        BENCHMARK(name("APInt.bswap", bw)) { return bswap(ops.a); };
+    }
+    BENCHMARK(name("APInt.bitreverse", bw)) { return bitreverse(ops.a); };
+    BENCHMARK(name("APInt.popcount", bw)) { return ops.a.popcount(); };
+    BENCHMARK(name("APInt.clz", bw)) { return ops.divisor.clz(); };
+    BENCHMARK(name("APInt.ctz", bw)) { return ops.multiple.ctz(); };
+    BENCHMARK(name("APInt.extractBits", bw)) {
+        return ops.a.extractBits(size_t(ops.shift), bw - size_t(ops.shift));
+    };
+}
+
+TEST_CASE("APInt comparison", "[APInt]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    Operands ops(bw);
+    /// Equal operands, so all limbs have to be compared
+    APInt const c = ops.a;
+    BENCHMARK(name("APInt.ucmp", bw)) { return ucmp(ops.a, c); };
+    BENCHMARK(name("APInt.scmp", bw)) { return scmp(ops.a, c); };
+    BENCHMARK(name("APInt.umin", bw)) { return umin(ops.a, ops.b); };
+    BENCHMARK(name("APInt.umax", bw)) { return umax(ops.a, ops.b); };
+    BENCHMARK(name("APInt.smin", bw)) { return smin(ops.a, ops.b); };
+    BENCHMARK(name("APInt.smax", bw)) { return smax(ops.a, ops.b); };
+    BENCHMARK(name("APInt.hash", bw)) { return ops.a.hash(); };
+}
+
+TEST_CASE("APInt extension", "[APInt]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    Operands ops(bw);
+    BENCHMARK(name("APInt.zext", bw)) { return zext(ops.a, 2 * bw); };
+    BENCHMARK(name("APInt.sext", bw)) { return sext(ops.a, 2 * bw); };
+    BENCHMARK(name("APInt.trunc", bw)) { return zext(ops.a, (bw + 1) / 2); };
+}
+
+TEST_CASE("APInt string and byte conversion", "[APInt]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    Operands ops(bw);
+    std::string const decimal = ops.a.toString(10);
+    std::string const hex = ops.a.toString(16);
+    std::vector<std::byte> bytes((bw + 7) / 8);
+    BENCHMARK(name("APInt.toString10", bw)) { return ops.a.toString(10); };
+    BENCHMARK(name("APInt.toString16", bw)) { return ops.a.toString(16); };
+    BENCHMARK(name("APInt.signedToString", bw)) {
+        return ops.a.signedToString(10);
+    };
+    BENCHMARK(name("APInt.toBytes", bw)) {
+        ops.a.toBytes(bytes, std::endian::little);
+        return bytes[0];
+    };
+    BENCHMARK(name("APInt.fromBytes", bw)) {
+        return APInt::fromBytes(bytes, std::endian::little, bw);
+    };
+    if (bw > bench::MaxParseWidth) {
+        return;
+    }
+    BENCHMARK(name("APInt.parse10", bw)) {
+        return APInt::parse(decimal, 10, bw);
+    };
+    BENCHMARK(name("APInt.parse16", bw)) { return APInt::parse(hex, 16, bw); };
+}
+
+TEST_CASE("APInt number theory", "[APInt]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    Operands ops(bw);
+    APInt const nonzero = btwor(ops.a, APInt(1, bw));
+    BENCHMARK(name("APInt.gcd", bw)) { return gcd(ops.a, ops.b); };
+    BENCHMARK(name("APInt.egcd", bw)) { return egcd(ops.a, ops.b); };
+    BENCHMARK(name("APInt.lcm", bw)) { return lcm(ops.a, ops.b); };
+    BENCHMARK(name("APInt.modInverse", bw)) {
+        return modInverse(ops.a, ops.divisor);
+    };
+    BENCHMARK(name("APInt.isqrt", bw)) { return isqrt(ops.a); };
+    BENCHMARK(name("APInt.iroot", bw)) { return iroot(ops.a, 3); };
+    BENCHMARK(name("APInt.ilog2", bw)) { return ilog2(nonzero); };
+    BENCHMARK(name("APInt.ilog", bw)) { return ilog(nonzero, 10); };
+    BENCHMARK(name("APInt.numDigits", bw)) { return numDigits(ops.a); };
+    if (bw > bench::MaxNumberTheoryWidth) {
+        return;
+    }
+    BENCHMARK(name("APInt.powMod", bw)) {
+        return powMod(ops.a, ops.b, ops.divisor);
+    };
+    BENCHMARK(name("APInt.nextPrime", bw)) { return nextPrime(ops.a); };
+    /// A prime, so the full primality test runs instead of trial division
+    APInt const prime =
+        nextPrime(lshr(ops.a, int(bw > 1))).value_or(APInt(0, bw));
+    BENCHMARK(name("APInt.isProbablePrime", bw)) {
+        return isProbablePrime(prime);
+    };
+}
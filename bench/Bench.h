@@ -0,0 +1,51 @@
+#ifndef APMATH_BENCH_BENCH_H_
+#define APMATH_BENCH_BENCH_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <APMath/APInt.h>
+
+/// Helpers shared by the benchmarks.
+///
+/// Benchmarks are named `"<type>.<operation>/<bitwidth>"`, e.g.
+/// `"APInt.mul/1024"`. The names are the keys of the JSON output, so they must
+/// be unique and should not change between versions, otherwise `compare.py`
+/// cannot match the results of two runs.
+
+namespace APMath::bench {
+
+/// The bitwidths every `APInt` operation is measured at
+inline constexpr std::array<std::size_t, 10> Widths = {
+    1, 8, 32, 64, 65, 128, 256, 1024, 8192, 65536
+};
+
+/// Number theoretic operations with superquadratic cost are only measured up
+/// to this bitwidth to keep the run time of the suite reasonable
+inline constexpr std::size_t MaxNumberTheoryWidth = 1024;
+
+/// Parsing is quadratic in the number of digits and takes seconds at 65536
+/// bits, so it is only measured up to this bitwidth
+inline constexpr std::size_t MaxParseWidth = 8192;
+
+/// \Returns the benchmark name of \p op at bitwidth \p bitwidth
+inline std::string name(std::string const& op, std::size_t bitwidth) {
+    return op + "/" + std::to_string(bitwidth);
+}
+
+/// \Returns a uniformly distributed \p bitwidth bit integer
+inline APInt randomAPInt(std::mt19937_64& rng, std::size_t bitwidth) {
+    std::vector<std::uint64_t> limbs((bitwidth + 63) / 64);
+    for (auto& limb: limbs) {
+        limb = rng();
+    }
+    return APInt(limbs, bitwidth);
+}
+
+} // namespace APMath::bench
+
+#endif // APMATH_BENCH_BENCH_H_
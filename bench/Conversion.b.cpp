@@ -0,0 +1,56 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include <random>
+#include <string>
+
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+#include <APMath/Conversion.h>
+
+#include "Bench.h"
+
+using namespace APMath;
+using bench::name;
+using bench::randomAPInt;
+
+/// Conversions are measured at the widths of the list that they support.
+/// Integers of any width can be converted to floating point, but the other
+/// conversions only support the native integer and floating point widths.
+TEST_CASE("Conversion", "[Conversion]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    std::mt19937_64 rng(bw);
+    APInt const a = randomAPInt(rng, bw);
+    for (APFloatPrec prec: { APFloatPrec::Single(), APFloatPrec::Double() }) {
+        size_t const fw = prec.totalBitwidth();
+        std::string const suffix = std::to_string(fw);
+        BENCHMARK(name("Conversion.valuecastToF" + suffix, bw)) {
+            return valuecast<APFloat>(a, fw);
+        };
+        BENCHMARK(name("Conversion.signedValuecastToF" + suffix, bw)) {
+            return signedValuecast<APFloat>(a, fw);
+        };
+        if (bw != 8 && bw != 32 && bw != 64) {
+            continue;
+        }
+        APFloat const x(42.75, prec);
+        APFloat const negX = negate(x);
+        BENCHMARK(name("Conversion.valuecastFromF" + suffix, bw)) {
+            return valuecast<APInt>(x, bw);
+        };
+        BENCHMARK(name("Conversion.signedValuecastFromF" + suffix, bw)) {
+            return signedValuecast<APInt>(negX, bw);
+        };
+        if (bw != fw) {
+            continue;
+        }
+        BENCHMARK(name("Conversion.bitcastToAPInt", bw)) {
+            return bitcast<APInt>(x);
+        };
+        BENCHMARK(name("Conversion.bitcastToAPFloat", bw)) {
+            return bitcast<APFloat>(a);
+        };
+    }
+}
@@ -0,0 +1,112 @@
+#include <catch2/catch_session.hpp>
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// Driver of the benchmark suite. In addition to the options of Catch2 it
+/// accepts `--json <path>` to write the results of all benchmarks to `path`:
+///
+///     { "benchmarks": { "<name>": { "samples": ..., "iterations": ...,
+///                                   "mean": ..., "lowMean": ...,
+///                                   "highMean": ..., "standardDeviation": ...
+///                                 }, ... } }
+///
+/// Times are in nanoseconds per call. `lowMean` and `highMean` bound the
+/// confidence interval of the mean. Use `compare.py` to compare two files.
+
+namespace {
+
+struct Result {
+    std::string name;
+    std::size_t samples;
+    std::size_t iterations;
+    double mean;
+    double lowMean;
+    double highMean;
+    double standardDeviation;
+};
+
+std::vector<Result> results;
+
+class ResultCollector: public Catch::EventListenerBase {
+public:
+    using EventListenerBase::EventListenerBase;
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const& stats) override {
+        auto nanoseconds = [](auto duration) {
+            return std::chrono::duration<double, std::nano>(duration).count();
+        };
+        results.push_back({
+            stats.info.name,
+            static_cast<std::size_t>(stats.info.samples),
+            static_cast<std::size_t>(stats.info.iterations),
+            nanoseconds(stats.mean.point),
+            nanoseconds(stats.mean.lower_bound),
+            nanoseconds(stats.mean.upper_bound),
+            nanoseconds(stats.standardDeviation.point),
+        });
+    }
+};
+
+} // namespace
+
+CATCH_REGISTER_LISTENER(ResultCollector)
+
+static std::string escape(std::string const& str) {
+    std::string result;
+    for (char c: str) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result;
+}
+
+static bool writeJSON(std::string const& path) {
+    std::ofstream file(path);
+    file << "{\"benchmarks\":{";
+    char number[64];
+    auto field = [&](char const* name, double value) {
+        std::snprintf(number, sizeof(number), "%.3f", value);
+        file << ",\"" << name << "\":" << number;
+    };
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        Result const& result = results[i];
+        file << (i == 0 ? "\n" : ",\n");
+        file << "\"" << escape(result.name) << "\":{";
+        file << "\"samples\":" << result.samples;
+        file << ",\"iterations\":" << result.iterations;
+        field("mean", result.mean);
+        field("lowMean", result.lowMean);
+        field("highMean", result.highMean);
+        field("standardDeviation", result.standardDeviation);
+        file << "}";
+    }
+    file << "\n}}\n";
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char* argv[]) {
+    Catch::Session session;
+    std::string jsonPath;
+    using Catch::Clara::Opt;
+    session.cli(session.cli() |
+                Opt(jsonPath, "path")["--json"](
+                    "write the benchmark results as JSON to <path>"));
+    if (int const status = session.applyCommandLine(argc, argv); status != 0) {
+        return status;
+    }
+    int const status = session.run();
+    if (!jsonPath.empty() && !writeJSON(jsonPath)) {
+        std::fprintf(stderr, "Failed to write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    return status;
+}
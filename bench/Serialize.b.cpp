@@ -0,0 +1,48 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include <span>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/Serialize.h>
+
+#include "Bench.h"
+
+using namespace APMath;
+using bench::name;
+using bench::randomAPInt;
+
+/// Number of values converted per round trip
+static constexpr size_t NumValues = 100;
+
+/// The text round trip parses `NumValues` numbers and is only measured up to
+/// this bitwidth, see `bench::MaxParseWidth`
+static constexpr size_t MaxTextWidth = 1024;
+
+/// Compares the binary format of `Serialize.h` with the decimal text format
+/// for values of random length up to the bitwidth
+TEST_CASE("Serialize round trip", "[Serialize]") {
+    size_t const bw = GENERATE(from_range(bench::Widths));
+    std::mt19937_64 rng(bw);
+    std::vector<APInt> values;
+    for (size_t i = 0; i < NumValues; ++i) {
+        values.push_back(lshr(randomAPInt(rng, bw), int(rng() % bw)));
+    }
+    BENCHMARK(name("Serialize.binaryRoundTrip", bw)) {
+        auto const buffer = serialize(std::span<APInt const>(values));
+        return deserializeAPInts(buffer);
+    };
+    if (bw > MaxTextWidth) {
+        return;
+    }
+    BENCHMARK(name("Serialize.textRoundTrip", bw)) {
+        std::vector<APInt> result;
+        for (auto& value: values) {
+            result.push_back(*APInt::parse(value.toString(), 10, bw));
+        }
+        return result;
+    };
+}
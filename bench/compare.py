@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Compare two JSON files written by `bench --json <path>`.
+
+A benchmark counts as a regression if its mean time grew by more than the
+threshold and the confidence intervals of both runs do not overlap, so noise
+within the measured confidence is not reported. Improvements are detected the
+same way. The exit status is 1 if any benchmark regressed.
+
+Usage: compare.py [--threshold PERCENT] [--filter REGEX] [--all] OLD NEW
+"""
+
+import argparse
+import json
+import re
+import sys
+
+
+def load(path):
+    with open(path) as file:
+        return json.load(file)["benchmarks"]
+
+
+def format_time(nanoseconds):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if nanoseconds >= scale:
+            return f"{nanoseconds / scale:.3f} {unit}"
+    return f"{nanoseconds:.1f} ns"
+
+
+def classify(old, new, threshold):
+    ratio = new["mean"] / old["mean"] if old["mean"] > 0 else 1.0
+    if ratio > 1 + threshold and new["lowMean"] > old["highMean"]:
+        return ratio, "REGRESSION"
+    if ratio < 1 / (1 + threshold) and new["highMean"] < old["lowMean"]:
+        return ratio, "improvement"
+    return ratio, ""
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare two benchmark runs and report regressions")
+    parser.add_argument("old", help="JSON results of the baseline run")
+    parser.add_argument("new", help="JSON results of the run to check")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="minimum change of the mean in percent "
+                        "(default: 5)")
+    parser.add_argument("--filter", default="",
+                        help="only compare benchmarks matching this regex")
+    parser.add_argument("--all", action="store_true",
+                        help="also list benchmarks that did not change")
+    args = parser.parse_args()
+
+    old = load(args.old)
+    new = load(args.new)
+    pattern = re.compile(args.filter)
+    threshold = args.threshold / 100
+    names = [name for name in old if name in new and pattern.search(name)]
+
+    regressions = 0
+    improvements = 0
+    rows = []
+    for name in names:
+        ratio, verdict = classify(old[name], new[name], threshold)
+        regressions += verdict == "REGRESSION"
+        improvements += verdict == "improvement"
+        if verdict or args.all:
+            rows.append((name, format_time(old[name]["mean"]),
+                         format_time(new[name]["mean"]),
+                         f"{(ratio - 1) * 100:+.1f}%", verdict))
+
+    if rows:
+        width = max(len(row[0]) for row in rows)
+        print(f"{'Benchmark':<{width}} {'Old':>12} {'New':>12} "
+              f"{'Change':>9}")
+        for name, before, after, change, verdict in rows:
+            print(f"{name:<{width}} {before:>12} {after:>12} {change:>9} "
+                  f"{verdict}")
+        print()
+
+    for label, missing in (("Only in old", set(old) - set(new)),
+                           ("Only in new", set(new) - set(old))):
+        missing = sorted(name for name in missing if pattern.search(name))
+        if missing:
+            print(f"{label}: {', '.join(missing)}")
+
+    print(f"{len(names)} benchmarks compared, {regressions} regressions, "
+          f"{improvements} improvements")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,6 +1,7 @@
 #ifndef APMATH_APINT_H_
 #define APMATH_APINT_H_
 
+#include <bit>
 #include <cassert>
 #include <climits>
 #include <cstddef>
@@ -12,7 +13,9 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include <APMath/API.h>
 
@@ -27,11 +30,63 @@ static constexpr Limb LimbMax = Limb(-1);
 std::size_t ceilDiv(std::size_t a, std::size_t b);
 std::size_t ceilRem(std::size_t a, std::size_t b);
 
+/// Secret constants of the multiply-fold hash
+inline constexpr std::uint64_t HashSecret[4] = { 0x2D35'8DCC'AA6C'78A5,
+                                                 0x8BB8'4B93'962E'ACC9,
+                                                 0x4B33'A62E'D433'D4A3,
+                                                 0x4D5A'2DA5'1DE1'AA47 };
+
+/// Seed of `APInt::hash()`
+inline constexpr std::uint64_t DefaultHashSeed = 0x9E37'79B9'7F4A'7C15;
+
+/// Multiply-fold mixing step: \Returns the XOR of the low and the high half of
+/// the 128 bit product `a * b`
+inline std::uint64_t hashMix(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    /// `__extension__` keeps `-Wpedantic` quiet in every includer
+    __extension__ using UInt128 = unsigned __int128;
+    auto const p = static_cast<UInt128>(a) * b;
+    return static_cast<std::uint64_t>(p) ^ static_cast<std::uint64_t>(p >> 64);
+#else
+    std::uint64_t const a0 = a & 0xFFFF'FFFF, a1 = a >> 32;
+    std::uint64_t const b0 = b & 0xFFFF'FFFF, b1 = b >> 32;
+    std::uint64_t const p00 = a0 * b0, p01 = a0 * b1;
+    std::uint64_t const p10 = a1 * b0, p11 = a1 * b1;
+    std::uint64_t const mid = (p00 >> 32) + (p01 & 0xFFFF'FFFF) +
+                              (p10 & 0xFFFF'FFFF);
+    std::uint64_t const hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    return (a * b) ^ hi;
+#endif
+}
+
+/// \Returns the seed with the bitwidth mixed in
+inline std::uint64_t hashSeed(std::size_t bitwidth, std::uint64_t seed) {
+    return seed ^ hashMix(seed ^ HashSecret[0], bitwidth ^ HashSecret[1]);
+}
+
+/// Hash of a single limb integer. Equal to `hashLimbs(&limb, 1, ...)`
+inline std::uint64_t hashLimb(Limb limb,
+                              std::size_t bitwidth,
+                              std::uint64_t seed) {
+    seed = hashSeed(bitwidth, seed);
+    return hashMix(LimbSize ^ HashSecret[1],
+                   hashMix(limb ^ HashSecret[1], seed ^ HashSecret[3]));
+}
+
+/// Hash of the \p numLimbs limbs \p limbs of a \p bitwidth bit integer
+APMATH_API std::uint64_t hashLimbs(Limb const* limbs,
+                                   std::size_t numLimbs,
+                                   std::size_t bitwidth,
+                                   std::uint64_t seed);
+
+struct APIntAccess;
+
 } // namespace APMath::internal
 
 namespace APMath {
 
 class APInt;
+class APIntRef;
 
 /// Compute sum of \p lhs and \p rhs
 APMATH_API APInt add(APInt lhs, APInt const& rhs);
@@ -55,6 +110,12 @@ APMATH_API APInt udiv(APInt const& lhs, APInt const& rhs);
 /// Operands are interpreted as unsigned integers.
 APMATH_API APInt urem(APInt const& lhs, APInt const& rhs);
 
+/// Compute quotient of \p lhs and \p rhs where \p lhs is known to be a
+/// multiple of \p rhs. This is considerably faster than `udiv()`.
+/// Operands are interpreted as unsigned integers.
+/// \pre `urem(lhs, rhs) == 0`
+APMATH_API APInt divExact(APInt const& lhs, APInt const& rhs);
+
 /// Compute quotient and remainder of \p lhs and \p rhs
 /// Operands are interpreted as signed integers. Quotient is truncated towards
 /// 0.
@@ -69,6 +130,12 @@ APMATH_API APInt sdiv(APInt const& lhs, APInt const& rhs);
 /// Operands are interpreted as signed integers.
 APMATH_API APInt srem(APInt const& lhs, APInt const& rhs);
 
+/// Compute quotient of \p lhs and \p rhs where \p lhs is known to be a
+/// multiple of \p rhs. This is considerably faster than `sdiv()`.
+/// Operands are interpreted as signed integers.
+/// \pre `srem(lhs, rhs) == 0`
+APMATH_API APInt sdivExact(APInt const& lhs, APInt const& rhs);
+
 /// Compute bitwise AND of \p lhs and \p rhs
 APMATH_API APInt btwand(APInt lhs, APInt const& rhs);
 
@@ -91,11 +158,32 @@ APMATH_API APInt ashl(APInt operand, int numBits);
 APMATH_API APInt ashr(APInt operand, int numBits);
 
 /// Left rotate \p operand by \p numBits bits.
+/// \p numBits is taken modulo the bitwidth.
 APMATH_API APInt rotl(APInt operand, int numBits);
 
 /// Right rotate \p operand by \p numBits bits.
+/// \p numBits is taken modulo the bitwidth.
 APMATH_API APInt rotr(APInt operand, int numBits);
 
+/// Funnel shift left: Concatenate \p hi and \p lo to a value of twice the
+/// bitwidth, shift it left by \p numBits and return the high half.
+/// \p numBits is taken modulo the bitwidth. `fshl(x, x, n)` equals
+/// `rotl(x, n)`.
+APMATH_API APInt fshl(APInt const& hi, APInt const& lo, int numBits);
+
+/// Funnel shift right: Concatenate \p hi and \p lo to a value of twice the
+/// bitwidth, shift it right by \p numBits and return the low half.
+/// \p numBits is taken modulo the bitwidth. `fshr(x, x, n)` equals
+/// `rotr(x, n)`.
+APMATH_API APInt fshr(APInt const& hi, APInt const& lo, int numBits);
+
+/// Reverse the order of the bytes of \p operand
+/// \pre The bitwidth must be a multiple of 8
+APMATH_API APInt bswap(APInt operand);
+
+/// Reverse the order of the bits of \p operand
+APMATH_API APInt bitreverse(APInt operand);
+
 /// Compute arithmetic signed complement of \p operand
 APMATH_API APInt negate(APInt operand);
 
@@ -122,6 +210,91 @@ APMATH_API int ucmp(std::uint64_t lhs, APInt const& rhs);
 /// Perform signed comparison between \p lhs and \p rhs
 APMATH_API int scmp(APInt const& lhs, APInt const& rhs);
 
+/// \Returns the lesser of \p lhs and \p rhs interpreted as unsigned integers
+APMATH_API APInt umin(APInt const& lhs, APInt const& rhs);
+
+/// \Returns the greater of \p lhs and \p rhs interpreted as unsigned
+/// integers
+APMATH_API APInt umax(APInt const& lhs, APInt const& rhs);
+
+/// \Returns the lesser of \p lhs and \p rhs interpreted as signed integers
+APMATH_API APInt smin(APInt const& lhs, APInt const& rhs);
+
+/// \Returns the greater of \p lhs and \p rhs interpreted as signed integers
+APMATH_API APInt smax(APInt const& lhs, APInt const& rhs);
+
+/// Compute the absolute value of \p operand interpreted as a signed integer.
+/// The minimum signed value is returned unchanged.
+APMATH_API APInt abs(APInt operand);
+
+/// ## Number theory
+
+/// Compute the greatest common divisor of \p a and \p b
+/// Operands are interpreted as unsigned integers. `gcd(0, 0)` is 0.
+APMATH_API APInt gcd(APInt const& a, APInt const& b);
+
+/// Compute the greatest common divisor `g` of \p a and \p b and Bezout
+/// coefficients `x` and `y` such that `a * x + b * y == g`.
+/// Operands are interpreted as unsigned integers, the coefficients are signed
+/// and satisfy `|x| <= max(1, b / 2g)` and `|y| <= max(1, a / 2g)`.
+/// \Returns the tuple `(g, x, y)`
+APMATH_API std::tuple<APInt, APInt, APInt> egcd(APInt const& a,
+                                               APInt const& b);
+
+/// Compute the multiplicative inverse of \p a modulo \p m
+/// Operands are interpreted as unsigned integers.
+/// \Returns the inverse in the range `[0, m)` or `std::nullopt` if \p a and
+/// \p m are not coprime or \p m is zero
+APMATH_API std::optional<APInt> modInverse(APInt const& a, APInt const& m);
+
+/// Compute \p base raised to the power of \p exp modulo \p mod
+/// Operands are interpreted as unsigned integers. Odd moduli use Montgomery
+/// multiplication.
+/// \pre \p mod must not be zero
+APMATH_API APInt powMod(APInt const& base, APInt const& exp, APInt const& mod);
+
+/// Test whether \p n is prime. \p n is interpreted as an unsigned integer.
+/// After trial division by small primes, values of up to 64 bits are tested
+/// with a deterministic set of Miller-Rabin bases, so the result is exact.
+/// Wider values are subjected to the Baillie-PSW test, for which no
+/// counterexample is known.
+APMATH_API bool isProbablePrime(APInt const& n);
+
+/// Compute the smallest (probable) prime greater than \p n
+/// \p n is interpreted as an unsigned integer.
+/// \Returns `std::nullopt` if there is no such prime within the bitwidth of
+/// \p n
+APMATH_API std::optional<APInt> nextPrime(APInt const& n);
+
+/// Compute the integer square root of \p n, i.e. the largest `r` with
+/// `r * r <= n`. \p n is interpreted as an unsigned integer.
+APMATH_API APInt isqrt(APInt const& n);
+
+/// Compute the integer \p k th root of \p n, i.e. the largest `r` with
+/// `r^k <= n`. \p n is interpreted as an unsigned integer.
+/// \pre \p k must be positive
+APMATH_API APInt iroot(APInt const& n, unsigned k);
+
+/// Compute the integer logarithm base 2 of \p n, i.e. the index of the most
+/// significant set bit. \p n is interpreted as an unsigned integer.
+/// \pre \p n must not be zero
+APMATH_API std::size_t ilog2(APInt const& n);
+
+/// Compute the integer logarithm base \p base of \p n, i.e. the largest `e`
+/// with `base^e <= n`. \p n is interpreted as an unsigned integer.
+/// \pre \p n must not be zero and \p base must be at least 2
+APMATH_API std::size_t ilog(APInt const& n, unsigned base);
+
+/// Compute the number of digits of \p n when printed in base \p base
+/// \p n is interpreted as an unsigned integer. Zero has one digit.
+/// \pre \p base must be at least 2
+APMATH_API std::size_t numDigits(APInt const& n, unsigned base = 10);
+
+/// Compute the least common multiple of \p a and \p b
+/// Operands are interpreted as unsigned integers. The result is truncated to
+/// the bitwidth of the operands. If either operand is zero the result is zero.
+APMATH_API APInt lcm(APInt const& a, APInt const& b);
+
 /// Arbitraty width integer.
 /// Bit width is specified on construction and can be modified with `zext()`
 /// and `sext()`. Operations involving multiple integers usually require the
@@ -177,6 +350,22 @@ public:
     /// Swap `*this` and \p rhs
     void swap(APInt& rhs) noexcept;
 
+    /// Move the limbs of `*this` to reference counted storage that is shared
+    /// by all copies. Copying a shared integer is O(1) and thread safe. The
+    /// first mutation of a copy whose storage is also referenced by other
+    /// integers copies the limbs to new shared storage (copy-on-write).
+    /// Integers with a single limb are never shared.
+    /// Sharing pays off for large values that are copied often but rarely
+    /// modified, such as constants.
+    APInt& share();
+
+    /// \Returns `true` if the limbs of `*this` are in shared storage
+    bool isShared() const { return !isLocal() && sharedLimbs; }
+
+    /// \Returns the number of integers referencing the storage of `*this`.
+    /// This is 1 if the storage is not shared.
+    std::size_t useCount() const;
+
     /// `*this += rhs`
     APInt& add(APInt const& rhs);
 
@@ -202,6 +391,14 @@ public:
     /// Both operands are interpreted as signed integers
     APInt& srem(APInt const& rhs);
 
+    /// `*this /= rhs` where `*this` is known to be a multiple of \p rhs
+    /// Both operands are interpreted as unsigned integers
+    APInt& divExact(APInt const& rhs);
+
+    /// `*this /= rhs` where `*this` is known to be a multiple of \p rhs
+    /// Both operands are interpreted as signed integers
+    APInt& sdivExact(APInt const& rhs);
+
     /// `*this &= rhs`
     APInt& btwand(APInt const& rhs);
 
@@ -224,11 +421,20 @@ public:
     APInt& ashr(int numBits);
 
     /// Left rotate `*this` by \p numBits bits.
+    /// \p numBits is taken modulo the bitwidth.
     APInt& rotl(int numBits);
 
     /// Right rotate `*this` by \p numBits bits.
+    /// \p numBits is taken modulo the bitwidth.
     APInt& rotr(int numBits);
 
+    /// Reverse the order of the bytes of `*this`.
+    /// \pre The bitwidth must be a multiple of 8
+    APInt& bswap();
+
+    /// Reverse the order of the bits of `*this`.
+    APInt& bitreverse();
+
     /// Compute and assign arithmetic signed complement of `*this`
     APInt& negate();
 
@@ -247,6 +453,27 @@ public:
     /// Flip all bits.
     APInt& flip();
 
+    /// Overwrite the bits `[lo, lo + value.bitwidth())` with \p value
+    APInt& insertBits(APInt const& value, size_t lo);
+
+    /// Set the bits `[lo, hi)` to `true`
+    APInt& setBits(size_t lo, size_t hi);
+
+    /// Set the bits `[lo, hi)` to `false`
+    APInt& clearBits(size_t lo, size_t hi);
+
+    /// \Returns the \p width bits starting at bit \p lo as a \p width bit
+    /// integer. `lo + width` must not exceed the bitwidth.
+    APInt extractBits(size_t lo, size_t width) const;
+
+    /// \Returns the index of the lowest set bit at or above \p pos or
+    /// `bitwidth()` if there is none
+    size_t findNextSet(size_t pos) const;
+
+    /// \Returns the index of the highest set bit at or below \p pos or
+    /// `bitwidth()` if there is none
+    size_t findPrevSet(size_t pos) const;
+
     /// Test the \p n th bit.
     bool test(size_t n) const;
 
@@ -332,11 +559,51 @@ public:
     template <typename T>
     typename std::enable_if<std::is_integral<T>::value, T>::type to() const;
 
-    /// Compute a 64 bit hash of this integer.
+    /// Compute a 64 bit hash of this integer. The bitwidth is part of the
+    /// hash, so equal values of different widths hash differently.
     ///
     /// Note that this is meant for use with unordered containers and is not a
     /// cryptographic hash.
-    std::size_t hash() const;
+    std::size_t hash() const { return hash(internal::DefaultHashSeed); }
+
+    /// Compute a 64 bit hash of this integer with the seed \p seed.
+    /// The result only depends on the seed, the bitwidth and the value. It is
+    /// the same on all platforms and is kept stable across versions, so it
+    /// can be used as a key in persistent caches.
+    std::uint64_t hash(std::uint64_t seed) const {
+        if (isLocal()) {
+            return internal::hashLimb(singleLimb, _bitwidth, seed);
+        }
+        return internal::hashLimbs(heapLimbs, numLimbs(), _bitwidth, seed);
+    }
+
+    /// Read a \p bitwidth bit integer from the first `ceil(bitwidth / 8)`
+    /// bytes of \p bytes stored in byte order \p endian. Bits of the top byte
+    /// above the bitwidth are ignored.
+    static APInt fromBytes(std::span<std::byte const> bytes,
+                           std::endian endian,
+                           std::size_t bitwidth);
+
+    /// Read `bytes.size() / stride` consecutive \p bitwidth bit integers from
+    /// \p bytes. Every value occupies the first `ceil(bitwidth / 8)` bytes of
+    /// its \p stride bytes. A \p stride of zero means `ceil(bitwidth / 8)`.
+    static std::vector<APInt> fromBytes(std::span<std::byte const> bytes,
+                                        std::endian endian,
+                                        std::size_t bitwidth,
+                                        std::size_t stride);
+
+    /// Write `*this` to the first `ceil(bitwidth() / 8)` bytes of \p bytes in
+    /// byte order \p endian
+    void toBytes(std::span<std::byte> bytes, std::endian endian) const;
+
+    /// Write \p values, which must have the same bitwidth, to consecutive
+    /// slots of \p stride bytes of \p bytes. Every value occupies the first
+    /// `ceil(bitwidth / 8)` bytes of its slot, padding bytes are set to zero. A
+    /// \p stride of zero means `ceil(bitwidth / 8)`.
+    static void toBytes(std::span<APInt const> values,
+                        std::span<std::byte> bytes,
+                        std::endian endian,
+                        std::size_t stride);
 
     /// Try to convert \p str to `APInt`
     ///
@@ -364,6 +631,8 @@ public:
     bool operator==(std::uint64_t rhs) const { return ucmp(rhs) == 0; }
 
 private:
+    friend struct internal::APIntAccess;
+    friend class APIntRef;
     friend APInt mul(APInt const& lhs, APInt const& rhs);
     friend std::pair<APInt, APInt> udivrem(APInt const& numerator,
                                            APInt const& divisor);
@@ -384,16 +653,31 @@ private:
     }
 
     Limb const* limbPtr() const { return isLocal() ? &singleLimb : heapLimbs; }
+
+    /// Mutable access to the limbs. Makes shared storage unique first.
     Limb* limbPtr() {
+        if (isShared()) {
+            makeUnique();
+        }
         return const_cast<Limb*>(static_cast<APInt const*>(this)->limbPtr());
     }
 
     Limb* allocate(std::size_t numLimbs);
     void deallocate(Limb* ptr, std::size_t numLimbs);
 
+    /// Copies shared limbs that are referenced by other integers
+    void makeUnique();
+
+    /// Frees the \p numLimbs heap limbs or releases the reference to shared
+    /// limbs
+    void releaseHeapLimbs(std::size_t numLimbs);
+
 private:
     std::uint32_t _bitwidth;
-    std::uint32_t topLimbActiveBits;
+    std::uint16_t topLimbActiveBits;
+    /// `heapLimbs` points into a reference counted block. Only meaningful if
+    /// the integer is not local.
+    bool sharedLimbs = false;
     union {
         Limb singleLimb;
         Limb* heapLimbs;
@@ -0,0 +1,87 @@
+#ifndef APMATH_APINTACCUMULATOR_H_
+#define APMATH_APINTACCUMULATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <APMath/API.h>
+#include <APMath/APInt.h>
+
+namespace APMath {
+
+/// Accumulator for long chains of additions, subtractions and multiply-adds of
+/// `APInt`s of a fixed bitwidth.
+///
+/// Repeated `APInt::add()` propagates the carry through all limbs for every
+/// term. The accumulator instead keeps a redundant representation: Every limb
+/// has a sum and a signed counter of the carries (and borrows) it produced.
+/// Terms are added limb by limb without any carry propagation, which is
+/// deferred until the value is requested with `value()`.
+/// As with `APInt` arithmetic the result is computed modulo `2^bitwidth()`.
+class APMATH_API APIntAccumulator {
+public:
+    /// Construct an accumulator with \p bitwidth bits and value 0
+    explicit APIntAccumulator(std::size_t bitwidth);
+
+    /// Construct an accumulator with the bitwidth and value of \p value
+    explicit APIntAccumulator(APInt const& value);
+
+    /// `*this += value`
+    APIntAccumulator& add(APInt const& value);
+
+    /// \overload
+    APIntAccumulator& add(std::uint64_t value);
+
+    /// `*this -= value`
+    APIntAccumulator& sub(APInt const& value);
+
+    /// \overload
+    APIntAccumulator& sub(std::uint64_t value);
+
+    /// `*this += lhs * rhs`
+    APIntAccumulator& mulAdd(APInt const& lhs, APInt const& rhs);
+
+    /// \overload
+    APIntAccumulator& mulAdd(APInt const& lhs, std::uint64_t rhs);
+
+    /// Reset the value to 0
+    void clear();
+
+    /// Normalize the accumulated value and convert it to `APInt`
+    APInt value() const;
+
+    /// The bitwidth of this accumulator.
+    std::size_t bitwidth() const { return _bitwidth; }
+
+private:
+    using Limb = APInt::Limb;
+
+    /// Make sure every carry counter can be incremented \p count more times,
+    /// folding the counters into the sums otherwise.
+    void reserveCarries(std::uint64_t count);
+
+    /// Propagate the carry counters into \p result
+    void normalize(Limb* result) const;
+
+    void accumulate(std::size_t index, Limb value) {
+        Limb& sum = _sums[index];
+        sum += value;
+        _carries[index] += sum < value;
+    }
+
+    void deduct(std::size_t index, Limb value) {
+        Limb& sum = _sums[index];
+        _carries[index] -= sum < value;
+        sum -= value;
+    }
+
+    std::size_t _bitwidth;
+    std::uint64_t _headroom;
+    std::vector<Limb> _sums;
+    std::vector<std::int64_t> _carries;
+};
+
+} // namespace APMath
+
+#endif // APMATH_APINTACCUMULATOR_H_
@@ -0,0 +1,196 @@
+#ifndef APMATH_APINTARRAY_H_
+#define APMATH_APINTARRAY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <APMath/API.h>
+#include <APMath/APInt.h>
+
+namespace APMath {
+
+/// Array of integers of one bitwidth, densely packed at that bitwidth.
+/// Element `i` occupies the bits `[i * bitwidth, (i + 1) * bitwidth)` of the
+/// underlying limbs, so an array of `i8` values needs one byte per element
+/// instead of the size of an `APInt`. Elements are accessed through proxy
+/// references that convert to and from `APInt`.
+class APMATH_API APIntArray {
+public:
+    using Limb = APInt::Limb;
+
+    class Reference;
+
+    /// Read-only proxy to an element
+    class ConstReference {
+    public:
+        /// \Returns the value of the element
+        APInt value() const { return array->load(index); }
+
+        /// \overload
+        operator APInt() const { return value(); }
+
+        /// The bitwidth of the element
+        std::size_t bitwidth() const { return array->bitwidth(); }
+
+        /// \Returns the value of the element as `uint64_t`. Higher bits are
+        /// truncated.
+        std::uint64_t to64() const { return array->loadLowBits(index, 64); }
+
+        /// Compare the element to \p rhs as unsigned integers
+        int ucmp(APInt const& rhs) const { return value().ucmp(rhs); }
+
+        /// Compare the element to \p rhs as signed integers
+        int scmp(APInt const& rhs) const { return value().scmp(rhs); }
+
+        bool operator==(APInt const& rhs) const { return value() == rhs; }
+
+    private:
+        friend class APIntArray;
+        friend class Reference;
+
+        ConstReference(APIntArray const* array, std::size_t index):
+            array(array), index(index) {}
+
+        APIntArray const* array;
+        std::size_t index;
+    };
+
+    /// Mutable proxy to an element
+    class Reference: public ConstReference {
+    public:
+        /// Sets the element to \p value
+        Reference& operator=(APInt const& value) {
+            mutableArray()->store(index, value);
+            return *this;
+        }
+
+        /// Sets the element to the value of \p rhs
+        Reference& operator=(Reference const& rhs) {
+            return *this = rhs.value();
+        }
+
+        /// Sets the element to \p value truncated to the bitwidth
+        Reference& operator=(std::uint64_t value) {
+            return *this = APInt(value, bitwidth());
+        }
+
+        /// `*this = *this + rhs`
+        Reference& add(APInt const& rhs) { return *this = value().add(rhs); }
+
+        /// `*this = *this - rhs`
+        Reference& sub(APInt const& rhs) { return *this = value().sub(rhs); }
+
+        /// `*this = *this * rhs`
+        Reference& mul(APInt const& rhs) { return *this = value().mul(rhs); }
+
+        /// `*this = *this & rhs`
+        Reference& btwand(APInt const& rhs) {
+            return *this = value().btwand(rhs);
+        }
+
+        /// `*this = *this | rhs`
+        Reference& btwor(APInt const& rhs) {
+            return *this = value().btwor(rhs);
+        }
+
+        /// `*this = *this ^ rhs`
+        Reference& btwxor(APInt const& rhs) {
+            return *this = value().btwxor(rhs);
+        }
+
+    private:
+        friend class APIntArray;
+
+        using ConstReference::ConstReference;
+
+        APIntArray* mutableArray() const {
+            return const_cast<APIntArray*>(array);
+        }
+    };
+
+    /// Construct an empty array of 1 bit elements
+    APIntArray(): APIntArray(0, 1) {}
+
+    /// Construct an array of \p size elements of \p bitwidth bits with value 0
+    explicit APIntArray(std::size_t size, std::size_t bitwidth);
+
+    /// Construct an array from \p elements. All elements must have the same
+    /// bitwidth.
+    explicit APIntArray(std::span<APInt const> elements);
+
+    /// \overload
+    explicit APIntArray(std::vector<APInt> const& elements):
+        APIntArray(std::span<APInt const>(elements)) {}
+
+    /// Convert to a vector of `APInt`s
+    std::vector<APInt> toAPInts() const;
+
+    /// \Returns a proxy to the element at \p index
+    Reference operator[](std::size_t index) { return { this, index }; }
+
+    /// \overload
+    ConstReference operator[](std::size_t index) const {
+        return { this, index };
+    }
+
+    /// Sets all elements to \p value
+    void fill(APInt const& value);
+
+    /// Sets the elements `[index, index + count)` to \p value
+    void fill(std::size_t index, std::size_t count, APInt const& value);
+
+    /// Copies the elements `[srcIndex, srcIndex + count)` of \p src to
+    /// `[destIndex, destIndex + count)` of \p dest. The ranges may overlap.
+    static void copy(APIntArray& dest,
+                     std::size_t destIndex,
+                     APIntArray const& src,
+                     std::size_t srcIndex,
+                     std::size_t count);
+
+    /// \Returns `true` if the elements `[lhsIndex, lhsIndex + count)` of
+    /// \p lhs are equal to `[rhsIndex, rhsIndex + count)` of \p rhs
+    static bool equal(APIntArray const& lhs,
+                      std::size_t lhsIndex,
+                      APIntArray const& rhs,
+                      std::size_t rhsIndex,
+                      std::size_t count);
+
+    /// Resizes the array to \p size elements. New elements are zero.
+    void resize(std::size_t size);
+
+    /// Appends \p value to the end of the array
+    void push_back(APInt const& value);
+
+    /// The number of elements
+    std::size_t size() const { return _size; }
+
+    /// The bitwidth of the elements
+    std::size_t bitwidth() const { return _bitwidth; }
+
+    /// The packed elements
+    std::span<Limb const> limbs() const { return _limbs; }
+
+    /// Arrays are equal if they have the same bitwidth and equal elements
+    bool operator==(APIntArray const& rhs) const {
+        return _bitwidth == rhs._bitwidth && _size == rhs._size &&
+               _limbs == rhs._limbs;
+    }
+
+private:
+    APInt load(std::size_t index) const;
+    void store(std::size_t index, APInt const& value);
+
+    /// \Returns the low \p numBits `<= 64` bits of the element at \p index
+    Limb loadLowBits(std::size_t index, std::size_t numBits) const;
+
+    std::size_t _size;
+    std::size_t _bitwidth;
+    /// Bits past the last element are always zero
+    std::vector<Limb> _limbs;
+};
+
+} // namespace APMath
+
+#endif // APMATH_APINTARRAY_H_
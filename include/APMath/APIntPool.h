@@ -0,0 +1,80 @@
+#ifndef APMATH_APINTPOOL_H_
+#define APMATH_APINTPOOL_H_
+
+#include <cstddef>
+#include <memory>
+
+#include <APMath/API.h>
+#include <APMath/APIntRef.h>
+
+namespace APMath {
+
+/// Pool of unique immutable integers. Interning a value returns a view of the
+/// one copy of that value (keyed by bitwidth and limbs) owned by the pool, so
+/// interned values can be compared for identity by comparing their limb
+/// pointers. The limbs of all values are stored in arenas owned by the pool
+/// and remain valid until the pool is destroyed.
+///
+/// The pool is split into independently locked shards selected by the hash of
+/// the value, so multiple threads can intern concurrently.
+class APMATH_API APIntPool {
+public:
+    using Limb = APInt::Limb;
+
+    /// Memory and usage statistics
+    struct Statistics {
+        /// Number of unique values in the pool
+        std::size_t numValues = 0;
+
+        /// Number of calls to `intern()`
+        std::size_t numLookups = 0;
+
+        /// Number of calls to `intern()` that found an existing value
+        std::size_t numHits = 0;
+
+        /// Number of bytes occupied by the limbs of the values
+        std::size_t limbBytes = 0;
+
+        /// Number of bytes allocated for limb arenas
+        std::size_t arenaBytes = 0;
+
+        /// Approximate number of bytes used by the hash tables
+        std::size_t tableBytes = 0;
+    };
+
+    /// Construct an empty pool with \p numShards shards. The number of shards
+    /// is rounded up to a power of two.
+    explicit APIntPool(std::size_t numShards = 16);
+
+    APIntPool(APIntPool const&) = delete;
+    APIntPool& operator=(APIntPool const&) = delete;
+
+    ~APIntPool();
+
+    /// \Returns a view of the pooled value equal to \p value. The value is
+    /// copied into the pool if it is not present yet. Thread safe.
+    APIntView intern(APIntView value);
+
+    /// \Returns `true` if a value equal to \p value has been interned.
+    /// Thread safe.
+    bool contains(APIntView value) const;
+
+    /// The number of unique values in the pool. Thread safe.
+    std::size_t size() const;
+
+    /// \Returns statistics about the pool. Thread safe, but the result is not
+    /// a consistent snapshot while other threads intern values.
+    Statistics statistics() const;
+
+private:
+    struct Shard;
+
+    Shard& shardFor(std::size_t hash) const;
+
+    std::unique_ptr<Shard[]> shards;
+    std::size_t shardMask;
+};
+
+} // namespace APMath
+
+#endif // APMATH_APINTPOOL_H_
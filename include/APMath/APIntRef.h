@@ -0,0 +1,256 @@
+#ifndef APMATH_APINTREF_H_
+#define APMATH_APINTREF_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include <APMath/API.h>
+#include <APMath/APInt.h>
+
+namespace APMath {
+
+/// Non-owning read-only view of an integer stored in external limbs.
+/// The limbs are a little endian array of `ceil(bitwidth / 64)` limbs. Bits
+/// above the bitwidth must be zero. Views of `APInt`s and `APInt`s with equal
+/// values compare and hash equal.
+class APMATH_API APIntView {
+public:
+    using Limb = APInt::Limb;
+
+    /// Construct a view of the \p bitwidth bit integer stored in \p limbs
+    explicit APIntView(Limb const* limbs, std::size_t bitwidth):
+        _limbs(limbs), _bitwidth(bitwidth) {
+        assert(bitwidth > 0);
+    }
+
+    /// Construct a view of \p value
+    APIntView(APInt const& value):
+        APIntView(value.limbs().data(), value.bitwidth()) {}
+
+    /// Copy the viewed value into an `APInt`
+    APInt toAPInt() const { return APInt(limbs(), bitwidth()); }
+
+    /// Test the \p n th bit.
+    bool test(std::size_t n) const {
+        assert(n < bitwidth());
+        return (_limbs[n / internal::LimbBitSize] >>
+                (n % internal::LimbBitSize)) &
+               1;
+    }
+
+    /// Test if all bits are set.
+    bool all() const;
+
+    /// Test if any bit is set.
+    bool any() const { return !none(); }
+
+    /// Test if no bits are set.
+    bool none() const;
+
+    /// Number of bits set.
+    std::size_t popcount() const;
+
+    /// Number of leading zeros, starting at the most significant bit position.
+    std::size_t clz() const;
+
+    /// Number of trailing zeros, starting at the least significant bit position
+    std::size_t ctz() const;
+
+    /// \Returns the \p width bits starting at bit \p lo as a \p width bit
+    /// integer. `lo + width` must not exceed the bitwidth.
+    APInt extractBits(std::size_t lo, std::size_t width) const;
+
+    /// \Returns the index of the lowest set bit at or above \p pos or
+    /// `bitwidth()` if there is none
+    std::size_t findNextSet(std::size_t pos) const;
+
+    /// \Returns the index of the highest set bit at or below \p pos or
+    /// `bitwidth()` if there is none
+    std::size_t findPrevSet(std::size_t pos) const;
+
+    /// Perform unsigned comparison between `*this` and \p rhs
+    int ucmp(APIntView rhs) const;
+
+    /// \overload
+    int ucmp(std::uint64_t rhs) const;
+
+    /// Perform signed comparison between `*this` and \p rhs
+    int scmp(APIntView rhs) const;
+
+    /// \Returns `true` if this is negative when interpreted as signed
+    bool negative() const { return highbit() != 0; }
+
+    /// \Returns 1 if the high bit is set, 0 otherwise
+    int highbit() const { return test(bitwidth() - 1); }
+
+    /// The bitwidth of the viewed integer.
+    std::size_t bitwidth() const { return _bitwidth; }
+
+    /// The number of limbs of the viewed integer.
+    std::size_t numLimbs() const {
+        return internal::ceilDiv(_bitwidth, internal::LimbBitSize);
+    }
+
+    /// View over limbs
+    std::span<Limb const> limbs() const { return { _limbs, numLimbs() }; }
+
+    /// Access the limb at index \p index
+    /// \p index must be less than `numLimbs()`
+    Limb limb(std::size_t index) const {
+        assert(index < numLimbs());
+        return _limbs[index];
+    }
+
+    /// Convert to native integral type.
+    /// Truncates if `*this` is wider than `T`
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, T>::type to() const {
+        T result = 0;
+        std::memcpy(&result, _limbs, std::min(numLimbs() * sizeof(Limb),
+                                              sizeof(T)));
+        return result;
+    }
+
+    /// Convert `*this` to a string in the specified base.
+    /// \param *this is interpreted as an unsigned integer.
+    /// \param base must be between 2 and 36 (inclusive)
+    std::string toString(int base = 10) const;
+
+    /// Convert `*this` to a string in the specified base.
+    /// \param *this is interpreted as a signed integer.
+    /// \param base must be between 2 and 36 (inclusive)
+    std::string signedToString(int base = 10) const;
+
+    /// Compute a 64 bit hash of the viewed integer. Equal to the hash of an
+    /// `APInt` with the same bitwidth and value.
+    std::size_t hash() const { return hash(internal::DefaultHashSeed); }
+
+    /// Compute a 64 bit hash of the viewed integer with the seed \p seed.
+    /// Equal to `APInt::hash(seed)` of an `APInt` with the same bitwidth and
+    /// value.
+    std::uint64_t hash(std::uint64_t seed) const {
+        return internal::hashLimbs(_limbs, numLimbs(), _bitwidth, seed);
+    }
+
+    /// Compare integers for equality.
+    bool operator==(APIntView const& rhs) const { return ucmp(rhs) == 0; }
+
+    /// \overload
+    bool operator==(std::uint64_t rhs) const { return ucmp(rhs) == 0; }
+
+protected:
+    Limb const* _limbs;
+    std::size_t _bitwidth;
+};
+
+/// Non-owning mutable reference to an integer stored in external limbs.
+/// Operations modify the referenced limbs in place and keep the bits above
+/// the bitwidth cleared. The operands of binary operations must have the same
+/// bitwidth as `*this` and may alias it.
+class APMATH_API APIntRef: public APIntView {
+public:
+    /// Construct a reference to the \p bitwidth bit integer stored in
+    /// \p limbs
+    explicit APIntRef(Limb* limbs, std::size_t bitwidth):
+        APIntView(limbs, bitwidth) {}
+
+    /// Construct a reference to \p value
+    APIntRef(APInt& value): APIntRef(value.limbPtr(), value.bitwidth()) {}
+
+    /// Copy the value of \p rhs into the referenced limbs
+    APIntRef& assign(APIntView rhs);
+
+    /// `*this += rhs`
+    APIntRef& add(APIntView rhs);
+
+    /// `*this -= rhs`
+    APIntRef& sub(APIntView rhs);
+
+    /// `*this *= rhs`
+    APIntRef& mul(APIntView rhs);
+
+    /// `*this &= rhs`
+    APIntRef& btwand(APIntView rhs);
+
+    /// `*this |= rhs`
+    APIntRef& btwor(APIntView rhs);
+
+    /// `*this ^= rhs`
+    APIntRef& btwxor(APIntView rhs);
+
+    /// Logical left shift `*this` by \p numBits bits.
+    APIntRef& lshl(int numBits);
+
+    /// Logical right shift `*this` by \p numBits bits.
+    APIntRef& lshr(int numBits);
+
+    /// Arithmetic right shift `*this` by \p numBits bits.
+    APIntRef& ashr(int numBits);
+
+    /// Rotate `*this` left by \p numBits bits. \p numBits is taken modulo the
+    /// bitwidth.
+    APIntRef& rotl(int numBits);
+
+    /// Rotate `*this` right by \p numBits bits. \p numBits is taken modulo
+    /// the bitwidth.
+    APIntRef& rotr(int numBits);
+
+    /// Reverse the order of the bytes of `*this`.
+    /// \pre The bitwidth must be a multiple of 8
+    APIntRef& bswap();
+
+    /// Reverse the order of the bits of `*this`.
+    APIntRef& bitreverse();
+
+    /// Compute and assign arithmetic signed complement of `*this`
+    APIntRef& negate();
+
+    /// Set the \p n th bit to \p value
+    APIntRef& set(std::size_t n, bool value);
+
+    /// Set the \p n th bit to `true`.
+    APIntRef& set(std::size_t n);
+
+    /// Set the \p n th bit to `false`.
+    APIntRef& clear(std::size_t n);
+
+    /// Flip the \p n th bit.
+    APIntRef& flip(std::size_t n);
+
+    /// Flip all bits.
+    APIntRef& flip();
+
+    /// Overwrite the bits `[lo, lo + value.bitwidth())` with \p value
+    APIntRef& insertBits(APIntView value, std::size_t lo);
+
+    /// Set the bits `[lo, hi)` to `true`
+    APIntRef& setBits(std::size_t lo, std::size_t hi);
+
+    /// Set the bits `[lo, hi)` to `false`
+    APIntRef& clearBits(std::size_t lo, std::size_t hi);
+
+    /// Mutable view over limbs
+    std::span<Limb> limbs() const { return { limbPtr(), numLimbs() }; }
+
+private:
+    Limb* limbPtr() const { return const_cast<Limb*>(_limbs); }
+
+    void clearUnusedBits();
+};
+
+} // namespace APMath
+
+template <>
+struct std::hash<APMath::APIntView> {
+    std::size_t operator()(APMath::APIntView const& value) const {
+        return value.hash();
+    }
+};
+
+#endif // APMATH_APINTREF_H_
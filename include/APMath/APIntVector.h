@@ -0,0 +1,171 @@
+#ifndef APMATH_APINTVECTOR_H_
+#define APMATH_APINTVECTOR_H_
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <APMath/API.h>
+#include <APMath/APInt.h>
+
+namespace APMath {
+
+class APIntVector;
+
+/// Predicates for the elementwise comparison of `APIntVector`s
+enum class CmpPredicate { EQ, NE, ULT, ULE, UGT, UGE, SLT, SLE, SGT, SGE };
+
+/// Compute elementwise sum of \p lhs and \p rhs
+APMATH_API APIntVector add(APIntVector lhs, APIntVector const& rhs);
+
+/// Compute elementwise difference of \p lhs and \p rhs
+APMATH_API APIntVector sub(APIntVector lhs, APIntVector const& rhs);
+
+/// Compute elementwise product of \p lhs and \p rhs
+APMATH_API APIntVector mul(APIntVector lhs, APIntVector const& rhs);
+
+/// Compute elementwise bitwise AND of \p lhs and \p rhs
+APMATH_API APIntVector btwand(APIntVector lhs, APIntVector const& rhs);
+
+/// Compute elementwise bitwise OR of \p lhs and \p rhs
+APMATH_API APIntVector btwor(APIntVector lhs, APIntVector const& rhs);
+
+/// Compute elementwise bitwise XOR of \p lhs and \p rhs
+APMATH_API APIntVector btwxor(APIntVector lhs, APIntVector const& rhs);
+
+/// Logical left shift every element of \p operand by \p numBits bits.
+APMATH_API APIntVector lshl(APIntVector operand, int numBits);
+
+/// Logical right shift every element of \p operand by \p numBits bits.
+APMATH_API APIntVector lshr(APIntVector operand, int numBits);
+
+/// Arithmetic right shift every element of \p operand by \p numBits bits.
+APMATH_API APIntVector ashr(APIntVector operand, int numBits);
+
+/// Compute arithmetic signed complement of every element of \p operand
+APMATH_API APIntVector negate(APIntVector operand);
+
+/// Compute bitwise complement of every element of \p operand
+APMATH_API APIntVector btwnot(APIntVector operand);
+
+/// Compare \p lhs and \p rhs elementwise
+/// \Returns a vector of 1 bit elements that are set where \p predicate holds
+APMATH_API APIntVector cmp(CmpPredicate predicate,
+                           APIntVector const& lhs,
+                           APIntVector const& rhs);
+
+/// Select elements of \p ifTrue where \p mask is set and of \p ifFalse
+/// otherwise. \p mask must be a vector of 1 bit elements.
+APMATH_API APIntVector select(APIntVector const& mask,
+                              APIntVector const& ifTrue,
+                              APIntVector ifFalse);
+
+/// Vector of `APInt`s of the same bitwidth.
+/// Elements are stored contiguously as a structure of arrays: The `j`-th limbs
+/// of all elements are adjacent in memory. Operations are computed limb by
+/// limb for all elements at once, so the inner loops run over contiguous lanes
+/// and are vectorized by the compiler. Elements of at most 64 bits occupy a
+/// single limb, wider elements propagate carries and borrows per lane.
+class APMATH_API APIntVector {
+public:
+    using Limb = APInt::Limb;
+
+    /// Construct an empty vector of 1 bit elements
+    APIntVector(): APIntVector(0, 1) {}
+
+    /// Construct a vector of \p size elements of \p bitwidth bits with value 0
+    explicit APIntVector(std::size_t size, std::size_t bitwidth);
+
+    /// Construct a vector from \p elements. All elements must have the same
+    /// bitwidth.
+    explicit APIntVector(std::span<APInt const> elements);
+
+    /// \overload
+    explicit APIntVector(std::vector<APInt> const& elements):
+        APIntVector(std::span<APInt const>(elements)) {}
+
+    /// Convert to a vector of `APInt`s
+    std::vector<APInt> toAPInts() const;
+
+    /// \Returns the element at \p index
+    APInt element(std::size_t index) const;
+
+    /// Set the element at \p index to \p value
+    void setElement(std::size_t index, APInt const& value);
+
+    /// `*this = *this + rhs`
+    APIntVector& add(APIntVector const& rhs);
+
+    /// `*this = *this - rhs`
+    APIntVector& sub(APIntVector const& rhs);
+
+    /// `*this = *this * rhs`
+    APIntVector& mul(APIntVector const& rhs);
+
+    /// `*this = *this & rhs`
+    APIntVector& btwand(APIntVector const& rhs);
+
+    /// `*this = *this | rhs`
+    APIntVector& btwor(APIntVector const& rhs);
+
+    /// `*this = *this ^ rhs`
+    APIntVector& btwxor(APIntVector const& rhs);
+
+    /// `*this = *this << numBits`
+    APIntVector& lshl(int numBits);
+
+    /// `*this = *this >> numBits` (logical)
+    APIntVector& lshr(int numBits);
+
+    /// `*this = *this >> numBits` (arithmetic)
+    APIntVector& ashr(int numBits);
+
+    /// `*this = -*this`
+    APIntVector& negate();
+
+    /// `*this = ~*this`
+    APIntVector& btwnot();
+
+    /// The number of elements
+    std::size_t size() const { return _size; }
+
+    /// The bitwidth of the elements
+    std::size_t bitwidth() const { return _bitwidth; }
+
+    /// The number of limbs of every element
+    std::size_t numLimbs() const { return _numLimbs; }
+
+    /// \Returns the \p index -th limbs of all elements
+    std::span<Limb const> limbs(std::size_t index) const {
+        return { _limbs.data() + index * _size, _size };
+    }
+
+    bool operator==(APIntVector const& rhs) const = default;
+
+private:
+    friend APIntVector cmp(CmpPredicate,
+                           APIntVector const&,
+                           APIntVector const&);
+    friend APIntVector select(APIntVector const&,
+                              APIntVector const&,
+                              APIntVector);
+
+    Limb* row(std::size_t index) { return _limbs.data() + index * _size; }
+    Limb const* row(std::size_t index) const {
+        return _limbs.data() + index * _size;
+    }
+
+    Limb topLimbMask() const;
+
+    /// Clears the bits above the bitwidth of every element
+    void clearUnusedBits();
+
+    std::size_t _size;
+    std::size_t _bitwidth;
+    std::size_t _numLimbs;
+    std::vector<Limb> _limbs;
+};
+
+} // namespace APMath
+
+#endif // APMATH_APINTVECTOR_H_
@@ -0,0 +1,79 @@
+#ifndef APMATH_BATCH_H_
+#define APMATH_BATCH_H_
+
+#include <span>
+
+#include <APMath/API.h>
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+
+namespace APMath {
+
+/// Binary operations on `APInt`s that can be evaluated in batches
+enum class APIntOp {
+    Add,
+    Sub,
+    Mul,
+    UDiv,
+    URem,
+    SDiv,
+    SRem,
+    BtwAnd,
+    BtwOr,
+    BtwXor,
+    /// Shifts take the shift amount from the right hand side operand, which
+    /// must be less than the bitwidth of the left hand side
+    LShl,
+    LShr,
+    AShr,
+    /// Comparisons yield a 1 bit integer
+    CmpEQ,
+    CmpNE,
+    CmpULT,
+    CmpULE,
+    CmpUGT,
+    CmpUGE,
+    CmpSLT,
+    CmpSLE,
+    CmpSGT,
+    CmpSGE,
+};
+
+/// Descriptor of the operation `op(*lhs, *rhs)`
+struct APIntOperation {
+    APIntOp op;
+    APInt const* lhs;
+    APInt const* rhs;
+};
+
+/// Binary operations on `APFloat`s that can be evaluated in batches
+enum class APFloatOp { Add, Sub, Mul, Div, Pow, Hypot };
+
+/// Descriptor of the operation `op(*lhs, *rhs)`
+struct APFloatOperation {
+    APFloatOp op;
+    APFloat const* lhs;
+    APFloat const* rhs;
+};
+
+/// \Returns the result of \p operation
+APMATH_API APInt evaluate(APIntOperation const& operation);
+
+/// \overload
+APMATH_API APFloat evaluate(APFloatOperation const& operation);
+
+/// Evaluates the independent \p operations and writes the result of
+/// `operations[i]` to `results[i]`. The operations are split into chunks of
+/// `ParallelOptions::batchSize` operations that are evaluated in parallel on
+/// the thread pool configured with `setParallelOptions()`. Operands must not
+/// alias the results.
+APMATH_API void evaluate(std::span<APIntOperation const> operations,
+                         std::span<APInt> results);
+
+/// \overload
+APMATH_API void evaluate(std::span<APFloatOperation const> operations,
+                         std::span<APFloat> results);
+
+} // namespace APMath
+
+#endif // APMATH_BATCH_H_
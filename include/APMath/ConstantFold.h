@@ -0,0 +1,275 @@
+#ifndef APMATH_CONSTANTFOLD_H_
+#define APMATH_CONSTANTFOLD_H_
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <APMath/API.h>
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+
+/// Constant folding of DAGs of integer and floating point operations with the
+/// semantics of the corresponding LLVM IR instructions, including poison
+/// values and poison generating flags.
+///
+///     FoldDAG dag;
+///     FoldNode a = dag.constant(APInt(200, 8));
+///     FoldNode b = dag.constant(APInt(100, 8));
+///     FoldNode sum = dag.binary(FoldOp::Add, a, b, { .nuw = true });
+///     FoldResults results;
+///     evaluate(dag, results);
+///     results[sum].poison; // true, the addition wraps
+
+namespace APMath {
+
+namespace internal {
+
+struct FoldEvaluator;
+
+} // namespace internal
+
+/// Opcodes of `FoldDAG` nodes
+enum class FoldOp : std::uint8_t {
+    /// Integer or floating point constant
+    Constant,
+
+    /// Integer arithmetic. Both operands and the result have the same
+    /// bitwidth. Division and remainder by zero, signed division and remainder
+    /// of the minimum value by `-1` and shift amounts not less than the
+    /// bitwidth yield poison.
+    Add,
+    Sub,
+    Mul,
+    UDiv,
+    SDiv,
+    URem,
+    SRem,
+    Shl,
+    LShr,
+    AShr,
+    And,
+    Or,
+    Xor,
+
+    /// Integer comparisons yielding a 1 bit integer
+    ICmpEQ,
+    ICmpNE,
+    ICmpULT,
+    ICmpULE,
+    ICmpUGT,
+    ICmpUGE,
+    ICmpSLT,
+    ICmpSLE,
+    ICmpSGT,
+    ICmpSGE,
+
+    /// Integer casts to the bitwidth of the node
+    Trunc,
+    ZExt,
+    SExt,
+
+    /// Floating point arithmetic. All operands and the result have the same
+    /// precision.
+    FNeg,
+    FAdd,
+    FSub,
+    FMul,
+    FDiv,
+
+    /// Ordered floating point comparisons yielding a 1 bit integer. The result
+    /// is `false` if either operand is NaN.
+    FCmpOEQ,
+    FCmpONE,
+    FCmpOLT,
+    FCmpOLE,
+    FCmpOGT,
+    FCmpOGE,
+
+    /// Conversions between integers and floating point values. `FPToUI` and
+    /// `FPToSI` yield poison if the truncated value does not fit into the
+    /// result type. Integer results must be 8, 16, 32 or 64 bits wide and
+    /// integer operands at most 64 bits.
+    FPToUI,
+    FPToSI,
+    UIToFP,
+    SIToFP,
+
+    /// Conversion to the precision of the node (`fptrunc` and `fpext`)
+    FPCast,
+
+    /// Reinterpretation of a 32 or 64 bit integer as a floating point value of
+    /// the same size or vice versa
+    BitCast,
+
+    /// `cond ? lhs : rhs`. The result is poison if `cond` or the selected
+    /// operand is poison.
+    Select,
+};
+
+/// Poison generating flags. Operations whose flag conditions are violated
+/// yield poison.
+struct FoldFlags {
+    /// No unsigned wrap. Applies to `Add`, `Sub`, `Mul`, `Shl` and `Trunc`
+    bool nuw = false;
+
+    /// No signed wrap. Applies to `Add`, `Sub`, `Mul`, `Shl` and `Trunc`
+    bool nsw = false;
+
+    /// No nonzero remainder or shifted out bits. Applies to `UDiv`, `SDiv`,
+    /// `LShr` and `AShr`
+    bool exact = false;
+
+    bool operator==(FoldFlags const&) const = default;
+};
+
+/// Type of the value of a node, either an integer of `bitwidth` bits or a
+/// floating point value of `precision`
+struct FoldType {
+    /// Static constructor
+    static FoldType Int(std::size_t bitwidth) {
+        return { bitwidth, { 0, 0 } };
+    }
+
+    /// Static constructor
+    static FoldType Float(APFloatPrec precision) {
+        return { precision.totalBitwidth(), precision };
+    }
+
+    /// \Returns `true` if this is a floating point type
+    bool isFloat() const { return precision.mantissaWidth != 0; }
+
+    /// The bitwidth of the integer or floating point type
+    std::size_t bitwidth;
+
+    /// The precision of floating point types. Zero for integer types.
+    APFloatPrec precision;
+
+    bool operator==(FoldType const&) const = default;
+};
+
+/// Handle of a node of a `FoldDAG`
+struct FoldNode {
+    std::uint32_t index;
+
+    bool operator==(FoldNode const&) const = default;
+};
+
+/// DAG of operations on constants. Nodes are created bottom up, so the
+/// operands of every node precede it. Creating a node that is identical to an
+/// existing node (same opcode, type, flags and operands, or same constant
+/// value) returns the existing node, so common subexpressions are evaluated
+/// only once. Operands of commutative operations are put in canonical order
+/// first.
+///
+/// Operand types are checked with assertions.
+class APMATH_API FoldDAG {
+public:
+    /// \Returns a node with the value \p value
+    FoldNode constant(APInt const& value);
+
+    /// \overload
+    FoldNode constant(APFloat const& value);
+
+    /// \Returns a node computing the integer or floating point arithmetic
+    /// operation or comparison \p op
+    FoldNode binary(FoldOp op, FoldNode lhs, FoldNode rhs,
+                    FoldFlags flags = {});
+
+    /// \Returns a node computing the floating point negation of \p operand
+    FoldNode fneg(FoldNode operand);
+
+    /// \Returns a node converting \p operand to \p type using the cast
+    /// operation \p op
+    FoldNode cast(FoldOp op, FoldNode operand, FoldType type,
+                  FoldFlags flags = {});
+
+    /// \Returns a node computing `cond ? lhs : rhs`
+    FoldNode select(FoldNode cond, FoldNode lhs, FoldNode rhs);
+
+    /// \Returns the opcode of \p node
+    FoldOp op(FoldNode node) const { return nodeAt(node).op; }
+
+    /// \Returns the type of the value of \p node
+    FoldType type(FoldNode node) const { return nodeAt(node).type; }
+
+    /// The number of nodes
+    std::size_t size() const { return nodes.size(); }
+
+private:
+    friend struct internal::FoldEvaluator;
+
+    struct Node {
+        FoldOp op;
+        FoldFlags flags;
+        FoldType type;
+        /// Operand node indices. For constants the first entry is the index
+        /// of the value in `intConstants` or `floatConstants`.
+        std::array<std::uint32_t, 3> operands;
+
+        bool operator==(Node const&) const = default;
+    };
+
+    Node const& nodeAt(FoldNode node) const {
+        assert(node.index < nodes.size());
+        return nodes[node.index];
+    }
+
+    /// \Returns `true` if the node at \p index has the same constant value as
+    /// \p node
+    bool sameConstant(std::uint32_t index, Node const& node) const;
+
+    /// \Returns the existing node equal to \p node or inserts it
+    FoldNode insert(Node node);
+
+    std::vector<Node> nodes;
+    std::vector<APInt> intConstants;
+    std::vector<APFloat> floatConstants;
+    /// Maps node hashes to node indices
+    std::unordered_multimap<std::uint64_t, std::uint32_t> uniqueNodes;
+};
+
+/// The value of a node. Depending on the node type either `intValue` or
+/// `floatValue` is set.
+struct FoldValue {
+    APInt intValue;
+    APFloat floatValue;
+    bool poison = false;
+};
+
+/// Values of all nodes of an evaluated `FoldDAG`. Evaluating several DAGs into
+/// the same results reuses the storage of the values.
+class APMATH_API FoldResults {
+public:
+    /// \Returns the value of \p node
+    FoldValue const& operator[](FoldNode node) const {
+        assert(node.index < values.size());
+        return values[node.index];
+    }
+
+    /// The number of values
+    std::size_t size() const { return values.size(); }
+
+private:
+    friend struct internal::FoldEvaluator;
+
+    std::vector<FoldValue> values;
+};
+
+/// Evaluates all nodes of \p dag and stores their values in \p results
+APMATH_API void evaluate(FoldDAG const& dag, FoldResults& results);
+
+/// Evaluates the independent DAGs \p dags and stores the values of `dags[i]`
+/// in `results[i]`. Consecutive DAGs are grouped into tasks of at least
+/// `ParallelOptions::batchSize` nodes that are evaluated in parallel on the
+/// thread pool configured with `setParallelOptions()`.
+APMATH_API void evaluate(std::span<FoldDAG const> dags,
+                         std::span<FoldResults> results);
+
+} // namespace APMath
+
+#endif // APMATH_CONSTANTFOLD_H_
@@ -0,0 +1,93 @@
+#ifndef APMATH_CONSTANTTABLE_H_
+#define APMATH_CONSTANTTABLE_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <APMath/API.h>
+#include <APMath/APInt.h>
+#include <APMath/APIntRef.h>
+
+/// Constant tables store many integers in one file laid out so that the file
+/// can be mapped into memory and the integers used in place.
+///
+/// All fields are little endian 64 bit words:
+/// - Header: magic, version, number of entries, byte offset of the index,
+///   byte offset of the limb data
+/// - Index: for every entry the offset of its first limb from the start of
+///   the limb data (in limbs) and its bitwidth
+/// - Limb data: the limbs of all entries in order, starting at a 64 byte
+///   boundary
+///
+/// Tables can be written on any host but only read on little endian hosts.
+
+namespace APMath {
+
+/// Encode \p values as a constant table
+APMATH_API std::vector<std::byte> writeConstantTable(
+    std::span<APInt const> values);
+
+/// Write \p values as a constant table to the file at \p path
+/// \Returns `false` if the file could not be written
+APMATH_API bool writeConstantTable(std::span<APInt const> values,
+                                   std::string const& path);
+
+/// Read-only access to a constant table. Entries are returned as views of the
+/// table memory, nothing is parsed or copied.
+class APMATH_API ConstantTable {
+public:
+    /// Interpret \p bytes as a constant table. \p bytes must be aligned to 8
+    /// bytes and outlive the table.
+    /// \Returns `std::nullopt` if \p bytes is not a valid table
+    static std::optional<ConstantTable> fromBytes(
+        std::span<std::byte const> bytes);
+
+    /// Map the file at \p path into memory and interpret it as a constant
+    /// table. The mapping is released when the table is destroyed.
+    /// \Returns `std::nullopt` if the file cannot be mapped or is not a valid
+    /// table
+    static std::optional<ConstantTable> open(std::string const& path);
+
+    ConstantTable(ConstantTable&& rhs) noexcept;
+    ConstantTable& operator=(ConstantTable&& rhs) noexcept;
+    ~ConstantTable();
+
+    /// The number of entries
+    std::size_t size() const { return _size; }
+
+    /// \Returns a view of the entry at \p index
+    APIntView operator[](std::size_t index) const {
+        assert(index < size());
+        IndexEntry const& entry = _index[index];
+        return APIntView(_limbs + entry.limbOffset, entry.bitwidth);
+    }
+
+private:
+    struct IndexEntry {
+        std::uint64_t limbOffset;
+        std::uint64_t bitwidth;
+    };
+
+    ConstantTable() = default;
+
+    static std::optional<ConstantTable> validate(
+        std::span<std::byte const> bytes);
+
+    void unmap();
+
+    IndexEntry const* _index = nullptr;
+    APInt::Limb const* _limbs = nullptr;
+    std::size_t _size = 0;
+    /// Memory mapping owned by the table, if any
+    void* _mapping = nullptr;
+    std::size_t _mappingSize = 0;
+};
+
+} // namespace APMath
+
+#endif // APMATH_CONSTANTTABLE_H_
@@ -0,0 +1,487 @@
+#ifndef APMATH_EXPR_H_
+#define APMATH_EXPR_H_
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include <APMath/APInt.h>
+#include <APMath/APIntRef.h>
+
+/// Expression templates for `APInt` arithmetic.
+///
+/// The functions in `APMath::expr` do not compute anything. They build an
+/// expression that captures its operands by reference, and `evaluate()` or
+/// `assign()` compute the whole expression in one pass:
+///
+///     using namespace APMath::expr;
+///     APInt r = evaluate(add(mul(a, b), btwand(c, d)));
+///
+/// Elementwise operations (`add`, `sub`, `btwand`, `btwor`, `btwxor`,
+/// `btwnot` and shifts by a constant) are fused into a single loop over the
+/// limbs of the result, so no temporaries are created for them. Only the
+/// results of multiplications and divisions, and operands of shifts that are
+/// themselves compound expressions, are computed into temporaries.
+///
+/// The operands of an expression must outlive it and must all have the same
+/// bitwidth.
+
+namespace APMath::expr {
+
+/// Base class of all expression nodes
+///
+/// Nodes provide
+/// - `bitwidth()`: The bitwidth of the result
+/// - `prepare()`: Computes the temporaries of the node and its operands
+/// - `limb(i)`: The limb `i` of the result. Must be called with `i = 0, 1,
+///   ...` in order after `prepare()`. Bits of the top limb above the bitwidth
+///   may be set.
+/// - `conflicts(dest)`: `true` if writing the result to \p dest while
+///   evaluating would overwrite limbs of \p dest that are read later
+///
+/// Nodes that set `RandomAccess` also provide `limbAt(i)`, which may be called
+/// with any index after `prepare()` and has no bits above the bitwidth set.
+struct Node {
+    static constexpr bool RandomAccess = false;
+};
+
+template <typename T>
+concept Expression = std::derived_from<std::remove_cvref_t<T>, Node>;
+
+template <typename T>
+concept Operand =
+    Expression<T> || std::same_as<std::remove_cvref_t<T>, APInt>;
+
+/// Leaf node referring to an `APInt`
+struct Ref: Node {
+    static constexpr bool RandomAccess = true;
+
+    explicit Ref(APInt const& value): value(&value) {}
+
+    std::size_t bitwidth() const { return value->bitwidth(); }
+    void prepare() {}
+    APInt::Limb limb(std::size_t i) const { return value->limb(i); }
+    APInt::Limb limbAt(std::size_t i) const { return value->limb(i); }
+    bool conflicts(APInt const*) const { return false; }
+
+    APInt const* value;
+};
+
+namespace internal {
+
+inline Ref wrap(APInt const& value) { return Ref(value); }
+
+template <Expression E>
+E wrap(E const& expr) {
+    return expr;
+}
+
+template <typename T>
+using Wrapped = decltype(wrap(std::declval<T const&>()));
+
+using Limb = APInt::Limb;
+
+struct AddOp {
+    Limb operator()(Limb a, Limb b) {
+        Limb const sum = a + b;
+        Limb const result = sum + carry;
+        carry = Limb(sum < a) | Limb(result < sum);
+        return result;
+    }
+    Limb carry = 0;
+};
+
+struct SubOp {
+    Limb operator()(Limb a, Limb b) {
+        Limb const diff = a - b;
+        Limb const result = diff - borrow;
+        borrow = Limb(a < b) | Limb(diff < borrow);
+        return result;
+    }
+    Limb borrow = 0;
+};
+
+struct AndOp {
+    Limb operator()(Limb a, Limb b) const { return a & b; }
+};
+
+struct OrOp {
+    Limb operator()(Limb a, Limb b) const { return a | b; }
+};
+
+struct XorOp {
+    Limb operator()(Limb a, Limb b) const { return a ^ b; }
+};
+
+/// Computes an expression into \p limbs
+template <Expression E>
+void evaluateInto(E& expr, std::span<Limb> limbs) {
+    for (std::size_t i = 0; i < limbs.size(); ++i) {
+        limbs[i] = expr.limb(i);
+    }
+    using APMath::internal::LimbBitSize;
+    std::size_t const topBits =
+        APMath::internal::ceilRem(expr.bitwidth(), LimbBitSize);
+    if (topBits != LimbBitSize) {
+        limbs.back() &= (Limb(1) << topBits) - 1;
+    }
+}
+
+} // namespace internal
+
+/// Computes the value of \p expr
+template <Expression E>
+APInt evaluate(E expr) {
+    expr.prepare();
+    APInt result(expr.bitwidth());
+    internal::evaluateInto(expr, APIntRef(result).limbs());
+    return result;
+}
+
+/// \overload
+inline APInt const& evaluate(APInt const& value) { return value; }
+
+/// Assigns the value of \p expr to \p dest. \p dest may be an operand of
+/// \p expr.
+template <Expression E>
+void assign(APInt& dest, E expr) {
+    if (expr.conflicts(&dest)) {
+        dest = evaluate(std::move(expr));
+        return;
+    }
+    expr.prepare();
+    if (dest.bitwidth() != expr.bitwidth()) {
+        dest = APInt(expr.bitwidth());
+    }
+    internal::evaluateInto(expr, APIntRef(dest).limbs());
+}
+
+/// Elementwise binary operation
+template <typename Op, Expression L, Expression R>
+struct Elementwise: Node {
+    Elementwise(L lhs, R rhs): lhs(std::move(lhs)), rhs(std::move(rhs)) {
+        assert(this->lhs.bitwidth() == this->rhs.bitwidth());
+    }
+
+    std::size_t bitwidth() const { return lhs.bitwidth(); }
+
+    void prepare() {
+        lhs.prepare();
+        rhs.prepare();
+    }
+
+    APInt::Limb limb(std::size_t i) { return op(lhs.limb(i), rhs.limb(i)); }
+
+    bool conflicts(APInt const* dest) const {
+        return lhs.conflicts(dest) || rhs.conflicts(dest);
+    }
+
+    L lhs;
+    R rhs;
+    Op op;
+};
+
+/// Bitwise complement
+template <Expression E>
+struct Not: Node {
+    explicit Not(E operand): operand(std::move(operand)) {}
+
+    std::size_t bitwidth() const { return operand.bitwidth(); }
+    void prepare() { operand.prepare(); }
+    APInt::Limb limb(std::size_t i) { return ~operand.limb(i); }
+
+    bool conflicts(APInt const* dest) const {
+        return operand.conflicts(dest);
+    }
+
+    E operand;
+};
+
+/// Operand of a shift. Shifts read limbs at other indices than the one they
+/// compute, so compound operands are computed into a temporary first.
+template <Expression E>
+struct ShiftOperand {
+    explicit ShiftOperand(E expr): expr(std::move(expr)) {}
+
+    std::size_t bitwidth() const { return expr.bitwidth(); }
+
+    void prepare() {
+        if constexpr (E::RandomAccess) {
+            expr.prepare();
+        }
+        else {
+            temporary = evaluate(expr);
+        }
+    }
+
+    APInt::Limb limbAt(std::size_t i) const {
+        if constexpr (E::RandomAccess) {
+            return expr.limbAt(i);
+        }
+        else {
+            return temporary.limb(i);
+        }
+    }
+
+    bool conflicts(APInt const* dest) const {
+        /// Temporaries are computed before anything is written
+        if constexpr (std::same_as<E, Ref>) {
+            return expr.value == dest;
+        }
+        else {
+            return false;
+        }
+    }
+
+    E expr;
+    APInt temporary;
+};
+
+enum class ShiftKind { LShl, LShr, AShr };
+
+/// Shift by a constant number of bits
+template <ShiftKind Kind, Expression E>
+struct Shift: Node {
+    Shift(E operand, int amount):
+        operand(std::move(operand)), numBits(static_cast<std::size_t>(amount)) {
+        assert(amount >= 0);
+        assert(this->numBits < this->operand.bitwidth());
+    }
+
+    std::size_t bitwidth() const { return operand.bitwidth(); }
+
+    void prepare() {
+        operand.prepare();
+        numLimbs = APMath::internal::ceilDiv(bitwidth(),
+                                             APMath::internal::LimbBitSize);
+        if constexpr (Kind == ShiftKind::AShr) {
+            negative = (operand.limbAt(numLimbs - 1) >>
+                        ((bitwidth() - 1) % APMath::internal::LimbBitSize)) &
+                       1;
+        }
+    }
+
+    APInt::Limb limb(std::size_t i) const {
+        using APMath::internal::LimbBitSize;
+        std::size_t const q = numBits / LimbBitSize;
+        unsigned const r = numBits % LimbBitSize;
+        if constexpr (Kind == ShiftKind::LShl) {
+            APInt::Limb const lo = i >= q ? operand.limbAt(i - q) << r : 0;
+            APInt::Limb const hi = r != 0 && i >= q + 1 ?
+                                       operand.limbAt(i - q - 1) >>
+                                           (LimbBitSize - r) :
+                                       0;
+            return lo | hi;
+        }
+        else {
+            APInt::Limb const lo = sourceLimb(i + q) >> r;
+            APInt::Limb const hi =
+                r != 0 ? sourceLimb(i + q + 1) << (LimbBitSize - r) : 0;
+            return lo | hi;
+        }
+    }
+
+    bool conflicts(APInt const* dest) const {
+        return operand.conflicts(dest);
+    }
+
+    /// Limb \p j of the operand, sign extended for arithmetic shifts
+    APInt::Limb sourceLimb(std::size_t j) const {
+        APInt::Limb const fill = negative ? ~APInt::Limb(0) : 0;
+        if (j >= numLimbs) {
+            return fill;
+        }
+        APInt::Limb result = operand.limbAt(j);
+        if (j == numLimbs - 1 && negative) {
+            std::size_t const topBits =
+                APMath::internal::ceilRem(bitwidth(),
+                                          APMath::internal::LimbBitSize);
+            if (topBits != APMath::internal::LimbBitSize) {
+                result |= fill << topBits;
+            }
+        }
+        return result;
+    }
+
+    ShiftOperand<E> operand;
+    std::size_t numBits;
+    std::size_t numLimbs = 0;
+    bool negative = false;
+};
+
+/// Operation whose result is computed into a temporary, such as
+/// multiplication and division
+template <auto Fn, Expression L, Expression R>
+struct Materialized: Node {
+    static constexpr bool RandomAccess = true;
+
+    Materialized(L lhs, R rhs): lhs(std::move(lhs)), rhs(std::move(rhs)) {
+        assert(this->lhs.bitwidth() == this->rhs.bitwidth());
+    }
+
+    std::size_t bitwidth() const { return lhs.bitwidth(); }
+
+    void prepare() { result = Fn(operandValue(lhs), operandValue(rhs)); }
+
+    APInt::Limb limb(std::size_t i) const { return result.limb(i); }
+    APInt::Limb limbAt(std::size_t i) const { return result.limb(i); }
+
+    /// The result is computed before anything is written to the destination
+    bool conflicts(APInt const*) const { return false; }
+
+    template <Expression E>
+    static decltype(auto) operandValue(E const& expr) {
+        if constexpr (std::same_as<E, Ref>) {
+            return *expr.value;
+        }
+        else {
+            return evaluate(expr);
+        }
+    }
+
+    L lhs;
+    R rhs;
+    APInt result;
+};
+
+namespace internal {
+
+inline APInt mul(APInt const& a, APInt const& b) { return APMath::mul(a, b); }
+inline APInt udiv(APInt const& a, APInt const& b) {
+    return APMath::udiv(a, b);
+}
+inline APInt urem(APInt const& a, APInt const& b) {
+    return APMath::urem(a, b);
+}
+inline APInt sdiv(APInt const& a, APInt const& b) {
+    return APMath::sdiv(a, b);
+}
+inline APInt srem(APInt const& a, APInt const& b) {
+    return APMath::srem(a, b);
+}
+
+} // namespace internal
+
+/// `lhs + rhs`
+template <Operand L, Operand R>
+auto add(L const& lhs, R const& rhs) {
+    using Result = Elementwise<internal::AddOp,
+                               internal::Wrapped<L>,
+                               internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs - rhs`
+template <Operand L, Operand R>
+auto sub(L const& lhs, R const& rhs) {
+    using Result = Elementwise<internal::SubOp,
+                               internal::Wrapped<L>,
+                               internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs & rhs`
+template <Operand L, Operand R>
+auto btwand(L const& lhs, R const& rhs) {
+    using Result = Elementwise<internal::AndOp,
+                               internal::Wrapped<L>,
+                               internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs | rhs`
+template <Operand L, Operand R>
+auto btwor(L const& lhs, R const& rhs) {
+    using Result = Elementwise<internal::OrOp,
+                               internal::Wrapped<L>,
+                               internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs ^ rhs`
+template <Operand L, Operand R>
+auto btwxor(L const& lhs, R const& rhs) {
+    using Result = Elementwise<internal::XorOp,
+                               internal::Wrapped<L>,
+                               internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `~operand`
+template <Operand E>
+auto btwnot(E const& operand) {
+    return Not<internal::Wrapped<E>>(internal::wrap(operand));
+}
+
+/// Logical left shift \p operand by \p numBits bits
+template <Operand E>
+auto lshl(E const& operand, int numBits) {
+    using Result = Shift<ShiftKind::LShl, internal::Wrapped<E>>;
+    return Result(internal::wrap(operand), numBits);
+}
+
+/// Logical right shift \p operand by \p numBits bits
+template <Operand E>
+auto lshr(E const& operand, int numBits) {
+    using Result = Shift<ShiftKind::LShr, internal::Wrapped<E>>;
+    return Result(internal::wrap(operand), numBits);
+}
+
+/// Arithmetic right shift \p operand by \p numBits bits
+template <Operand E>
+auto ashr(E const& operand, int numBits) {
+    using Result = Shift<ShiftKind::AShr, internal::Wrapped<E>>;
+    return Result(internal::wrap(operand), numBits);
+}
+
+/// `lhs * rhs`. The product is computed into a temporary.
+template <Operand L, Operand R>
+auto mul(L const& lhs, R const& rhs) {
+    using Result = Materialized<internal::mul,
+                                internal::Wrapped<L>,
+                                internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs / rhs` for unsigned operands. Computed into a temporary.
+template <Operand L, Operand R>
+auto udiv(L const& lhs, R const& rhs) {
+    using Result = Materialized<internal::udiv,
+                                internal::Wrapped<L>,
+                                internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs % rhs` for unsigned operands. Computed into a temporary.
+template <Operand L, Operand R>
+auto urem(L const& lhs, R const& rhs) {
+    using Result = Materialized<internal::urem,
+                                internal::Wrapped<L>,
+                                internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs / rhs` for signed operands. Computed into a temporary.
+template <Operand L, Operand R>
+auto sdiv(L const& lhs, R const& rhs) {
+    using Result = Materialized<internal::sdiv,
+                                internal::Wrapped<L>,
+                                internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+/// `lhs % rhs` for signed operands. Computed into a temporary.
+template <Operand L, Operand R>
+auto srem(L const& lhs, R const& rhs) {
+    using Result = Materialized<internal::srem,
+                                internal::Wrapped<L>,
+                                internal::Wrapped<R>>;
+    return Result(internal::wrap(lhs), internal::wrap(rhs));
+}
+
+} // namespace APMath::expr
+
+#endif // APMATH_EXPR_H_
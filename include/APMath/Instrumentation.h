@@ -0,0 +1,122 @@
+#ifndef APMATH_INSTRUMENTATION_H_
+#define APMATH_INSTRUMENTATION_H_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <APMath/API.h>
+#include <APMath/APInt.h>
+
+/// Instrumentation is compiled in if the library is configured with
+/// `-DAPMath_INSTRUMENTATION=ON`, which defines `APMATH_INSTRUMENTATION=1` for
+/// the library and its users. Otherwise the counters are never updated and
+/// operations carry no overhead.
+#ifndef APMATH_INSTRUMENTATION
+#define APMATH_INSTRUMENTATION 0
+#endif
+
+namespace APMath {
+
+/// `true` if the library counts operations and allocations
+inline constexpr bool InstrumentationEnabled = APMATH_INSTRUMENTATION;
+
+/// Operations that are counted by the instrumentation. Operations that are
+/// implemented in terms of other operations count the inner operations as
+/// well, e.g. signed division also counts an unsigned division.
+enum class InstrumentedOp {
+    Add,
+    Sub,
+    Mul,
+    /// Unsigned division and remainder (`udiv`, `urem`, `udivrem`)
+    UDivRem,
+    /// Signed division and remainder (`sdiv`, `srem`, `sdivrem`)
+    SDivRem,
+    DivExact,
+    BtwAnd,
+    BtwOr,
+    BtwXor,
+    /// Logical and arithmetic shifts and rotations
+    Shift,
+    /// Zero and sign extension and truncation
+    Extend,
+    /// Signed and unsigned comparison
+    Compare,
+    ToString,
+    Parse,
+    FAdd,
+    FSub,
+    FMul,
+    FDiv,
+    /// Elementary floating point functions (`exp`, `sin`, `pow`, ...)
+    FMath,
+    /// Conversions between `APInt` and `APFloat`
+    Conversion,
+};
+
+/// The number of `InstrumentedOp` values
+inline constexpr std::size_t NumInstrumentedOps =
+    static_cast<std::size_t>(InstrumentedOp::Conversion) + 1;
+
+/// The number of buckets of the bitwidth histograms
+inline constexpr std::size_t NumBitwidthBuckets =
+    std::bit_width(APInt::maxBitwidth() - 1) + 1;
+
+/// \Returns the name of \p op
+APMATH_API char const* toString(InstrumentedOp op);
+
+/// Counters of one thread
+struct APMATH_API InstrumentationSnapshot {
+    struct Operation {
+        /// Number of calls
+        std::uint64_t calls = 0;
+
+        /// Time spent in the operation, including nested operations
+        std::uint64_t nanoseconds = 0;
+
+        /// `bitwidthHistogram[i]` is the number of calls with an operand
+        /// bitwidth in `(2^(i-1), 2^i]`
+        std::array<std::uint64_t, NumBitwidthBuckets> bitwidthHistogram{};
+    };
+
+    /// Counters indexed by `InstrumentedOp`
+    std::array<Operation, NumInstrumentedOps> operations{};
+
+    /// Number of heap allocations of limbs
+    std::uint64_t allocations = 0;
+
+    /// Number of heap deallocations of limbs
+    std::uint64_t deallocations = 0;
+
+    /// Total number of bytes allocated
+    std::uint64_t allocatedBytes = 0;
+
+    /// Bytes allocated minus bytes freed by this thread. Can be negative if
+    /// the thread frees memory allocated by other threads.
+    std::int64_t currentBytes = 0;
+
+    /// Maximum of `currentBytes`
+    std::int64_t peakBytes = 0;
+
+    /// \Returns the counters of \p op
+    Operation const& operator[](InstrumentedOp op) const {
+        return operations[static_cast<std::size_t>(op)];
+    }
+
+    /// \Returns the counters as a JSON object. Operations that were never
+    /// called are omitted.
+    std::string toJSON() const;
+};
+
+/// \Returns the counters of the calling thread. All counters are zero if
+/// instrumentation is disabled.
+APMATH_API InstrumentationSnapshot instrumentationSnapshot();
+
+/// Resets the counters of the calling thread to zero
+APMATH_API void resetInstrumentation();
+
+} // namespace APMath
+
+#endif // APMATH_INSTRUMENTATION_H_
@@ -0,0 +1,37 @@
+#ifndef APMATH_PARALLEL_H_
+#define APMATH_PARALLEL_H_
+
+#include <cstddef>
+
+#include <APMath/API.h>
+
+namespace APMath {
+
+/// Options for the parallel execution of operations on very large integers.
+/// Multiplication (and thereby squaring) and radix conversion split their
+/// recursive subproblems across a work stealing thread pool. Batches of
+/// independent operations (see `Batch.h`) are evaluated in chunks on the same
+/// pool.
+struct ParallelOptions {
+    /// Number of threads operations may use, including the calling thread.
+    /// `1` disables parallel execution, `0` selects the number of hardware
+    /// threads.
+    unsigned numThreads = 1;
+
+    /// Operand size in limbs below which all work stays on the calling thread
+    std::size_t cutoff = 1024;
+
+    /// Number of operations of a batch that are evaluated by one task
+    std::size_t batchSize = 64;
+};
+
+/// Sets the options for parallel execution and (re)creates the thread pool.
+/// Must not be called while APMath operations are running on other threads.
+APMATH_API void setParallelOptions(ParallelOptions const& options);
+
+/// \Returns the current options. `numThreads` is the actual number of threads.
+APMATH_API ParallelOptions parallelOptions();
+
+} // namespace APMath
+
+#endif // APMATH_PARALLEL_H_
@@ -0,0 +1,78 @@
+#ifndef APMATH_SERIALIZE_H_
+#define APMATH_SERIALIZE_H_
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <APMath/API.h>
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+
+/// Compact binary encoding of `APInt` and `APFloat` values.
+///
+/// Unsigned integers are written as LEB128 varints. An integer is encoded as
+/// `varint(bitwidth << 1 | c)`, `varint(n)` and `n` little endian payload
+/// bytes. If the integer is negative `c` is 1 and the payload is the bitwise
+/// complement of the value, otherwise `c` is 0 and the payload is the value.
+/// Leading zero bytes of the payload are omitted, so small positive and small
+/// negative values of any width need few bytes. A float is encoded as
+/// `varint(mantissaWidth)`, `varint(exponentWidth)` and the
+/// `ceil(totalBitwidth / 8)` little endian bytes of its bit pattern.
+///
+/// The encoding does not depend on the host and is kept stable.
+
+namespace APMath {
+
+/// \Returns the number of bytes of the encoding of \p value
+APMATH_API std::size_t serializedSize(APInt const& value);
+
+/// \overload
+APMATH_API std::size_t serializedSize(APFloat const& value);
+
+/// Write the encoding of \p value to the front of \p buffer
+/// \pre \p buffer must have at least `serializedSize(value)` bytes
+/// \Returns the number of bytes written
+APMATH_API std::size_t serialize(APInt const& value,
+                                 std::span<std::byte> buffer);
+
+/// \overload
+APMATH_API std::size_t serialize(APFloat const& value,
+                                 std::span<std::byte> buffer);
+
+/// Encode all \p values into one buffer. The buffer starts with the number of
+/// values as a varint followed by the encodings of the values.
+APMATH_API std::vector<std::byte> serialize(std::span<APInt const> values);
+
+/// \overload
+APMATH_API std::vector<std::byte> serialize(std::span<APFloat const> values);
+
+/// Read an integer from the front of \p buffer. On success \p buffer is
+/// advanced past the encoding.
+/// \Returns the integer or `std::nullopt` if \p buffer does not start with a
+/// valid encoding
+APMATH_API std::optional<APInt> deserializeAPInt(
+    std::span<std::byte const>& buffer);
+
+/// Read a float from the front of \p buffer. On success \p buffer is advanced
+/// past the encoding.
+/// \Returns the float or `std::nullopt` if \p buffer does not start with a
+/// valid encoding or the precision is not supported
+APMATH_API std::optional<APFloat> deserializeAPFloat(
+    std::span<std::byte const>& buffer);
+
+/// Decode a buffer written by `serialize(std::span<APInt const>)`
+/// \Returns the integers or `std::nullopt` if \p buffer is not a valid
+/// encoding
+APMATH_API std::optional<std::vector<APInt>> deserializeAPInts(
+    std::span<std::byte const> buffer);
+
+/// Decode a buffer written by `serialize(std::span<APFloat const>)`
+/// \Returns the floats or `std::nullopt` if \p buffer is not a valid encoding
+APMATH_API std::optional<std::vector<APFloat>> deserializeAPFloats(
+    std::span<std::byte const> buffer);
+
+} // namespace APMath
+
+#endif // APMATH_SERIALIZE_H_
@@ -0,0 +1,126 @@
+#ifndef APMATH_TRACE_H_
+#define APMATH_TRACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <APMath/API.h>
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+#include <APMath/Batch.h>
+
+/// Recording and replay of operation traces.
+///
+/// While a trace is recorded every `APInt` and `APFloat` operation that can
+/// be expressed as an `APIntOperation` or `APFloatOperation` (see `Batch.h`)
+/// is appended to the trace file together with its operands. Operations
+/// called by other recorded operations are not recorded. `udivrem()` and
+/// `sdivrem()` are recorded as `UDiv` and `SDiv`, `ucmp()` and `scmp()` as
+/// `CmpULT` and `CmpSLT`.
+///
+/// Recording requires the library to be built with instrumentation (see
+/// `Instrumentation.h`).
+///
+/// Trace files start with the 8 bytes `"APMTRC1\0"`, followed by one record
+/// per operation: a tag byte that is `0x80 | op` for `APFloatOp`s and `op`
+/// for `APIntOp`s, followed by both operands in the format of `Serialize.h`.
+
+namespace APMath {
+
+/// Starts recording operations of all threads to the file at \p path
+/// \Returns `false` if the file cannot be opened, a trace is already being
+/// recorded or the library was built without instrumentation
+APMATH_API bool startTrace(std::string const& path);
+
+/// Stops recording and closes the trace file. A trace that is still being
+/// recorded when the program exits is written and closed on exit.
+/// \Returns `false` if writing the trace failed
+APMATH_API bool stopTrace();
+
+/// Operations of a trace in recording order
+struct APMATH_API Trace {
+    struct Entry {
+        bool isFloat;
+        std::uint8_t op;
+        /// Index of the left hand side operand in `intOperands` or
+        /// `floatOperands`. The right hand side operand follows it.
+        std::size_t index;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<APInt> intOperands;
+    std::vector<APFloat> floatOperands;
+
+    /// \Returns the trace encoded in \p bytes or `std::nullopt` if \p bytes
+    /// is not a valid trace
+    static std::optional<Trace> fromBytes(std::span<std::byte const> bytes);
+
+    /// \Returns the trace in the file at \p path or `std::nullopt` if the file
+    /// cannot be read or is not a valid trace
+    static std::optional<Trace> read(std::string const& path);
+
+    /// \Returns the integer operation of \p entry
+    APIntOperation intOperation(Entry const& entry) const {
+        return { static_cast<APIntOp>(entry.op),
+                 &intOperands[entry.index],
+                 &intOperands[entry.index + 1] };
+    }
+
+    /// \Returns the floating point operation of \p entry
+    APFloatOperation floatOperation(Entry const& entry) const {
+        return { static_cast<APFloatOp>(entry.op),
+                 &floatOperands[entry.index],
+                 &floatOperands[entry.index + 1] };
+    }
+};
+
+/// Timing of a trace replay
+struct APMATH_API ReplayStatistics {
+    struct Operation {
+        /// Name of the operation, e.g. `"APInt.Mul"`
+        std::string name;
+
+        /// Number of executions
+        std::size_t count = 0;
+
+        /// Sum of the latencies of all executions
+        std::uint64_t totalNanoseconds = 0;
+
+        /// Latency percentiles
+        std::uint64_t p50 = 0;
+        std::uint64_t p90 = 0;
+        std::uint64_t p99 = 0;
+        std::uint64_t max = 0;
+    };
+
+    /// Statistics of all operations that occur in the trace
+    std::vector<Operation> operations;
+
+    /// Number of operations executed without timing each operation
+    std::size_t numOperations = 0;
+
+    /// Wall time of executing `numOperations` operations
+    double seconds = 0;
+
+    /// `numOperations / seconds`
+    double operationsPerSecond() const {
+        return seconds > 0 ? static_cast<double>(numOperations) / seconds : 0;
+    }
+
+    /// \Returns a table of the statistics
+    std::string toString() const;
+};
+
+/// Executes the operations of \p trace \p repetitions times to measure the
+/// throughput and another \p repetitions times timing every operation to
+/// measure latencies. Latencies include the overhead of reading the clock.
+APMATH_API ReplayStatistics replay(Trace const& trace,
+                                   std::size_t repetitions = 1);
+
+} // namespace APMath
+
+#endif // APMATH_TRACE_H_
@@ -5,6 +5,8 @@
 #include <functional>
 #include <sstream>
 
+#include "Instrument.h"
+
 using namespace APMath;
 
 std::size_t APFloatPrec::totalBitwidth() const {
@@ -39,7 +41,12 @@ static bool isSinglePrec(auto const& arg, auto const&...) {
     return arg.precision() == APFloatPrec::Single();
 }
 
+static std::size_t totalBitwidth(auto const& arg, auto const&...) {
+    return arg.precision().totalBitwidth();
+}
+
 static APFloat elemMathImpl(auto impl, auto const&... args) {
+    APMATH_INSTRUMENT(FMath, totalBitwidth(args...));
     if (isSinglePrec(args...)) {
         return APFloat(impl(args.template to<float>()...),
                        APFloatPrec::Single());
@@ -82,6 +89,7 @@ APFloat APMath::log10(APFloat const& arg) {
 }
 
 APFloat APMath::pow(APFloat const& base, APFloat const& exp) {
+    APMATH_TRACE(APFloatOp::Pow, base, exp);
     return elemMathImpl(ELEM_MATH_STD_IMPL(pow), base, exp);
 }
 
@@ -94,6 +102,7 @@ APFloat APMath::cbrt(APFloat const& arg) {
 }
 
 APFloat APMath::hypot(APFloat const& a, APFloat const& b) {
+    APMATH_TRACE(APFloatOp::Hypot, a, b);
     return elemMathImpl(ELEM_MATH_STD_IMPL(hypot), a, b);
 }
 
@@ -161,6 +170,8 @@ void APFloat::swap(APFloat& rhs) noexcept {
 }
 
 APFloat& APFloat::add(APFloat const& rhs) {
+    APMATH_TRACE(APFloatOp::Add, *this, rhs);
+    APMATH_INSTRUMENT(FAdd, precision().totalBitwidth());
     assert(precision() == rhs.precision());
     if (precision() == APFloatPrec::Single()) {
         _f32 += rhs._f32;
@@ -172,6 +183,8 @@ APFloat& APFloat::add(APFloat const& rhs) {
 }
 
 APFloat& APFloat::sub(APFloat const& rhs) {
+    APMATH_TRACE(APFloatOp::Sub, *this, rhs);
+    APMATH_INSTRUMENT(FSub, precision().totalBitwidth());
     assert(precision() == rhs.precision());
     if (precision() == APFloatPrec::Single()) {
         _f32 -= rhs._f32;
@@ -183,6 +196,8 @@ APFloat& APFloat::sub(APFloat const& rhs) {
 }
 
 APFloat& APFloat::mul(APFloat const& rhs) {
+    APMATH_TRACE(APFloatOp::Mul, *this, rhs);
+    APMATH_INSTRUMENT(FMul, precision().totalBitwidth());
     assert(precision() == rhs.precision());
     if (precision() == APFloatPrec::Single()) {
         _f32 *= rhs._f32;
@@ -194,6 +209,8 @@ APFloat& APFloat::mul(APFloat const& rhs) {
 }
 
 APFloat& APFloat::div(APFloat const& rhs) {
+    APMATH_TRACE(APFloatOp::Div, *this, rhs);
+    APMATH_INSTRUMENT(FDiv, precision().totalBitwidth());
     assert(precision() == rhs.precision());
     if (precision() == APFloatPrec::Single()) {
         _f32 /= rhs._f32;
@@ -2,14 +2,24 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include <APMath/APIntRef.h>
+
+#include "Divide.h"
+#include "Instrument.h"
+#include "LimbOps.h"
+#include "Multiply.h"
+#include "RadixConversion.h"
+
 using namespace APMath;
 using namespace APMath::internal;
 
@@ -23,81 +33,61 @@ APInt APMath::add(APInt lhs, APInt const& rhs) { return lhs.add(rhs); }
 
 APInt APMath::sub(APInt lhs, APInt const& rhs) { return lhs.sub(rhs); }
 
-static APInt::Limb mulCarry(APInt::Limb a, APInt::Limb b) {
-    static_assert(sizeof(APInt::Limb) == 8, "Only works for 64 bit integers");
-    constexpr uint64_t mask = 0xFFFF'FFFF;
-    uint64_t const a0 = a & mask;
-    uint64_t const a1 = a >> 32;
-    uint64_t const b0 = b & mask;
-    uint64_t const b1 = b >> 32;
-    uint64_t const d0 = a1 * b0 + (a0 * b0 >> 32);
-    uint64_t const d1 = a0 * b1;
-    uint64_t const c1 = d0 + d1;
-    uint64_t const c2 = (c1 >> 32) + (c1 < d0 ? 0x100000000u : 0);
-    uint64_t const carry = a1 * b1 + c2;
-    return carry;
-}
-
 APInt APMath::mul(APInt const& lhs, APInt const& rhs) {
     assert(lhs.bitwidth() == rhs.bitwidth());
-    Limb const* l = lhs.limbPtr();
-    Limb const* r = rhs.limbPtr();
-    APInt term(lhs.bitwidth());
-    Limb* t = term.limbPtr();
+    APMATH_TRACE(APIntOp::Mul, lhs, rhs);
+    APMATH_INSTRUMENT(Mul, lhs.bitwidth());
     APInt res(lhs.bitwidth());
-    for (size_t j = lhs.numLimbs(); j > 0;) {
-        std::memset(t, 0, lhs.byteSize());
-        --j;
-        Limb const factor = r[j];
-        Limb carry = 0;
-        for (size_t i = 0, k = j; k < lhs.numLimbs(); ++i, ++k) {
-            Limb newCarry = mulCarry(l[i], factor);
-            assert(newCarry != LimbMax);
-            t[k] = l[i] * factor;
-            newCarry += t[k] > LimbMax - carry;
-            t[k] += carry;
-            carry = newCarry;
-        }
-        res.add(term);
-    }
+    size_t const n = lhs.numLimbs();
+    mulLimbsLow(res.limbPtr(), lhs.limbPtr(), n, rhs.limbPtr(), n, n);
+    res.limbPtr()[n - 1] &= res.topLimbMask();
     return res;
 }
 
 std::pair<APInt, APInt> APMath::udivrem(APInt const& numerator,
                                         APInt const& denominator) {
-    using Limb = APInt::Limb;
-    constexpr size_t LimbBitSize = sizeof(Limb) * CHAR_BIT;
     assert(numerator.bitwidth() == denominator.bitwidth());
-    assert(denominator.ucmp(0) != 0);
+    assert(denominator.any());
+    APMATH_TRACE(APIntOp::UDiv, numerator, denominator);
+    APMATH_INSTRUMENT(UDivRem, numerator.bitwidth());
+    size_t const m = normalizedSize(numerator.limbPtr(), numerator.numLimbs());
+    size_t const n =
+        normalizedSize(denominator.limbPtr(), denominator.numLimbs());
+    if (m < n) {
+        return { APInt(0, numerator.bitwidth()), numerator };
+    }
     APInt quotient(0, numerator.bitwidth());
     APInt remainder(0, numerator.bitwidth());
-    Limb* const q = quotient.limbPtr();
-    Limb* const r = remainder.limbPtr();
-    Limb const* const n = numerator.limbPtr();
-    for (size_t i = numerator.bitwidth(); i > 0;) {
-        --i;
-        remainder.lshl(1);
-        r[0] |= (n[i / LimbBitSize] >> (i % LimbBitSize)) & Limb(1);
-        if (remainder.ucmp(denominator) >= 0) {
-            remainder.sub(denominator);
-            q[i / LimbBitSize] |= Limb(1) << (i % LimbBitSize);
-        }
-    }
+    divremLimbs(quotient.limbPtr(),
+                remainder.limbPtr(),
+                numerator.limbPtr(),
+                m,
+                denominator.limbPtr(),
+                n);
     return { std::move(quotient), std::move(remainder) };
 }
 
 APInt APMath::udiv(APInt const& lhs, APInt const& rhs) {
+    APMATH_TRACE(APIntOp::UDiv, lhs, rhs);
     return udivrem(lhs, rhs).first;
 }
 
 APInt APMath::urem(APInt const& lhs, APInt const& rhs) {
+    APMATH_TRACE(APIntOp::URem, lhs, rhs);
     return udivrem(lhs, rhs).second;
 }
 
 std::pair<APInt, APInt> APMath::sdivrem(APInt const& numerator,
                                         APInt const& denominator) {
-    if (denominator.negative()) {
-        auto [q, r] = sdivrem(numerator, negate(denominator));
+    APMATH_TRACE(APIntOp::SDiv, numerator, denominator);
+    APMATH_INSTRUMENT(SDivRem, numerator.bitwidth());
+    bool const negativeDenominator = denominator.negative();
+    if (negativeDenominator && numerator.negative()) {
+        auto [q, r] = udivrem(negate(numerator), negate(denominator));
+        return { std::move(q), std::move(r.negate()) };
+    }
+    if (negativeDenominator) {
+        auto [q, r] = udivrem(numerator, negate(denominator));
         return { std::move(q.negate()), std::move(r) };
     }
     if (numerator.negative()) {
@@ -107,14 +97,24 @@ std::pair<APInt, APInt> APMath::sdivrem(APInt const& numerator,
     return udivrem(numerator, denominator);
 }
 
+APInt APMath::divExact(APInt const& lhs, APInt const& rhs) {
+    return APInt(lhs).divExact(rhs);
+}
+
 APInt APMath::sdiv(APInt const& lhs, APInt const& rhs) {
+    APMATH_TRACE(APIntOp::SDiv, lhs, rhs);
     return sdivrem(lhs, rhs).first;
 }
 
 APInt APMath::srem(APInt const& lhs, APInt const& rhs) {
+    APMATH_TRACE(APIntOp::SRem, lhs, rhs);
     return sdivrem(lhs, rhs).second;
 }
 
+APInt APMath::sdivExact(APInt const& lhs, APInt const& rhs) {
+    return APInt(lhs).sdivExact(rhs);
+}
+
 APInt APMath::btwand(APInt lhs, APInt const& rhs) {
     return std::move(lhs.btwand(rhs));
 }
@@ -151,6 +151,38 @@ APInt APMath::rotr(APInt operand, int numBits) {
     return std::move(operand.rotr(numBits));
 }
 
+APInt APMath::fshl(APInt const& hi, APInt const& lo, int numBits) {
+    assert(hi.bitwidth() == lo.bitwidth());
+    auto const bw = static_cast<long long>(hi.bitwidth());
+    auto const s = static_cast<size_t>((numBits % bw + bw) % bw);
+    if (s == 0) {
+        return hi;
+    }
+    APInt result(0, hi.bitwidth());
+    fshlLimbs(APIntRef(result).limbs().data(),
+              hi.limbs().data(),
+              lo.limbs().data(),
+              hi.bitwidth(),
+              s);
+    return result;
+}
+
+APInt APMath::fshr(APInt const& hi, APInt const& lo, int numBits) {
+    assert(hi.bitwidth() == lo.bitwidth());
+    auto const bw = static_cast<long long>(hi.bitwidth());
+    auto const s = static_cast<size_t>((numBits % bw + bw) % bw);
+    if (s == 0) {
+        return lo;
+    }
+    return fshl(hi, lo, static_cast<int>(bw - s));
+}
+
+APInt APMath::bswap(APInt operand) { return std::move(operand.bswap()); }
+
+APInt APMath::bitreverse(APInt operand) {
+    return std::move(operand.bitreverse());
+}
+
 APInt APMath::negate(APInt operand) { return std::move(operand.negate()); }
 
 APInt APMath::btwnot(APInt operand) { return std::move(operand.flip()); }
@@ -171,6 +203,29 @@ int APMath::ucmp(std::uint64_t lhs, APInt const& rhs) { return -rhs.ucmp(lhs); }
 
 int APMath::scmp(APInt const& lhs, APInt const& rhs) { return lhs.scmp(rhs); }
 
+APInt APMath::umin(APInt const& lhs, APInt const& rhs) {
+    return lhs.ucmp(rhs) <= 0 ? lhs : rhs;
+}
+
+APInt APMath::umax(APInt const& lhs, APInt const& rhs) {
+    return lhs.ucmp(rhs) >= 0 ? lhs : rhs;
+}
+
+APInt APMath::smin(APInt const& lhs, APInt const& rhs) {
+    return lhs.scmp(rhs) <= 0 ? lhs : rhs;
+}
+
+APInt APMath::smax(APInt const& lhs, APInt const& rhs) {
+    return lhs.scmp(rhs) >= 0 ? lhs : rhs;
+}
+
+APInt APMath::abs(APInt operand) {
+    if (operand.negative()) {
+        operand.negate();
+    }
+    return operand;
+}
+
 APInt APInt::UMax(size_t bitwidth) { return btwnot(UMin(bitwidth)); }
 
 APInt APInt::UMin(size_t bitwidth) { return APInt(0, bitwidth); }
@@ -186,6 +241,37 @@ APInt APInt::SMin(size_t bitwidth) {
     return value;
 }
 
+/// Shared limbs are preceded by their reference count in the same allocation
+using RefCount = std::atomic<std::uint64_t>;
+
+static_assert(sizeof(RefCount) == LimbSize);
+static_assert(alignof(RefCount) <= alignof(Limb));
+
+static RefCount& refCount(Limb const* limbs) {
+    return *std::launder(
+        reinterpret_cast<RefCount*>(const_cast<Limb*>(limbs) - 1));
+}
+
+/// Allocates shared storage for \p numLimbs limbs with a reference count of 1
+static Limb* allocateShared(size_t numLimbs) {
+    APMATH_RECORD_ALLOCATION((numLimbs + 1) * LimbSize);
+    auto* const block =
+        static_cast<Limb*>(std::malloc((numLimbs + 1) * LimbSize));
+    ::new (static_cast<void*>(block)) RefCount(1);
+    return block + 1;
+}
+
+/// Decrements the reference count of the shared storage of \p limbs and frees
+/// it when the last reference is released
+static void releaseShared(Limb* limbs, [[maybe_unused]] size_t numLimbs) {
+    RefCount& count = refCount(limbs);
+    if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        APMATH_RECORD_DEALLOCATION((numLimbs + 1) * LimbSize);
+        count.~RefCount();
+        std::free(limbs - 1);
+    }
+}
+
 APInt::APInt(): APInt(0, 64) {}
 
 APInt::APInt(size_t bitwidth): APInt(0, bitwidth) {}
@@ -193,7 +279,7 @@ APInt::APInt(size_t bitwidth): APInt(0, bitwidth) {}
 APInt::APInt(uint64_t value, size_t bw):
     _bitwidth(static_cast<uint32_t>(bw)),
     topLimbActiveBits(
-        static_cast<uint32_t>(ceilRem(bitwidth(), LimbSize * CHAR_BIT))) {
+        static_cast<uint16_t>(ceilRem(bitwidth(), LimbSize * CHAR_BIT))) {
     assert(bw > 0);
     assert(bw <= maxBitwidth());
     if (isLocal()) {
@@ -214,18 +300,26 @@ APInt::APInt(std::span<Limb const> limbs, size_t bitwidth): APInt(bitwidth) {
 }
 
 APInt::APInt(APInt const& rhs):
-    _bitwidth(rhs._bitwidth), topLimbActiveBits(rhs.topLimbActiveBits) {
+    _bitwidth(rhs._bitwidth),
+    topLimbActiveBits(rhs.topLimbActiveBits),
+    sharedLimbs(rhs.sharedLimbs) {
     if (isLocal()) {
         singleLimb = rhs.singleLimb;
     }
+    else if (sharedLimbs) {
+        heapLimbs = rhs.heapLimbs;
+        refCount(heapLimbs).fetch_add(1, std::memory_order_relaxed);
+    }
     else {
-        heapLimbs = static_cast<Limb*>(std::malloc(byteSize()));
+        heapLimbs = allocate(numLimbs());
         std::memcpy(heapLimbs, rhs.heapLimbs, byteSize());
     }
 }
 
 APInt::APInt(APInt&& rhs) noexcept:
-    _bitwidth(rhs._bitwidth), topLimbActiveBits(rhs.topLimbActiveBits) {
+    _bitwidth(rhs._bitwidth),
+    topLimbActiveBits(rhs.topLimbActiveBits),
+    sharedLimbs(rhs.sharedLimbs) {
     if (isLocal()) {
         singleLimb = rhs.singleLimb;
     }
@@ -233,11 +327,17 @@ APInt::APInt(APInt&& rhs) noexcept:
         heapLimbs = rhs.heapLimbs;
         rhs._bitwidth = 0;
         rhs.topLimbActiveBits = 0;
+        rhs.sharedLimbs = false;
         rhs.heapLimbs = nullptr;
     }
 }
 
 APInt& APInt::operator=(APInt const& rhs) {
+    if (isShared() || rhs.isShared()) {
+        APInt copy(rhs);
+        swap(copy);
+        return *this;
+    }
     bool thisIsLocal = isLocal();
     size_t thisNumLimbs = numLimbs();
     _bitwidth = rhs._bitwidth;
@@ -280,20 +380,24 @@ APInt& APInt::operator=(APInt&& rhs) noexcept {
         else {
             /// We steal `rhs`'s buffer
             heapLimbs = rhs.heapLimbs;
+            sharedLimbs = rhs.sharedLimbs;
             rhs._bitwidth = 0;
             rhs.topLimbActiveBits = 0;
+            rhs.sharedLimbs = false;
             rhs.heapLimbs = nullptr;
         }
     }
     else {
         if (rhs.isLocal()) {
-            deallocate(heapLimbs, thisNumLimbs);
+            releaseHeapLimbs(thisNumLimbs);
+            sharedLimbs = false;
             singleLimb = rhs.singleLimb;
         }
         else {
             /// Both not local, we swap
             std::swap(_bitwidth, rhs._bitwidth);
             std::swap(topLimbActiveBits, rhs.topLimbActiveBits);
+            std::swap(sharedLimbs, rhs.sharedLimbs);
             std::swap(heapLimbs, rhs.heapLimbs);
         }
     }
@@ -304,12 +408,13 @@ APInt::~APInt() {
     if (isLocal()) {
         return;
     }
-    deallocate(heapLimbs, numLimbs());
+    releaseHeapLimbs(numLimbs());
 }
 
 void APInt::swap(APInt& rhs) noexcept {
     std::swap(_bitwidth, rhs._bitwidth);
     std::swap(topLimbActiveBits, rhs.topLimbActiveBits);
+    std::swap(sharedLimbs, rhs.sharedLimbs);
     /// Use memcpy to swap to avoid reading inactive union member.
     Limb tmp;
     std::memcpy(&tmp, &singleLimb, LimbSize);
@@ -318,30 +423,16 @@ void APInt::swap(APInt& rhs) noexcept {
 }
 
 APInt& APInt::add(APInt const& rhs) {
-    assert(bitwidth() == rhs.bitwidth());
-    Limb carry = 0;
-    Limb* l = limbPtr();
-    Limb const* r = rhs.limbPtr();
-    for (size_t i = 0; i < numLimbs(); ++i) {
-        Limb const newCarry =
-            l[i] > LimbMax - r[i] || l[i] > LimbMax - (r[i] + carry);
-        l[i] += r[i] + carry;
-        carry = newCarry;
-    }
-    l[numLimbs() - 1] &= topLimbMask();
+    APMATH_TRACE(APIntOp::Add, *this, rhs);
+    APMATH_INSTRUMENT(Add, bitwidth());
+    APIntRef(*this).add(rhs);
     return *this;
 }
 
 APInt& APInt::sub(APInt const& rhs) {
-    Limb carry = 0;
-    Limb* l = limbPtr();
-    Limb const* r = rhs.limbPtr();
-    for (size_t i = 0; i < numLimbs(); ++i) {
-        Limb const newCarry = l[i] < r[i] || l[i] < r[i] + carry;
-        l[i] -= r[i] + carry;
-        carry = newCarry;
-    }
-    l[numLimbs() - 1] &= topLimbMask();
+    APMATH_TRACE(APIntOp::Sub, *this, rhs);
+    APMATH_INSTRUMENT(Sub, bitwidth());
+    APIntRef(*this).sub(rhs);
     return *this;
 }
 
@@ -363,167 +454,138 @@ APInt& APInt::srem(APInt const& rhs) {
     return *this = APMath::srem(*this, rhs);
 }
 
-APInt& APInt::btwand(APInt const& rhs) {
+/// Jebelean's exact division: Since the quotient `q` satisfies `q * d == a`,
+/// it can be computed limb by limb from the least significant end with the
+/// 2-adic inverse of `d`, i.e. `q_i = a_i * d^-1 mod 2^64`, followed by
+/// `a -= q_i * d`. Only the limbs below the quotient length are ever updated,
+/// so the cost is a single truncated multiplication.
+APInt& APInt::divExact(APInt const& rhs) {
+    APMATH_INSTRUMENT(DivExact, bitwidth());
     assert(bitwidth() == rhs.bitwidth());
-    Limb* const l = limbPtr();
-    Limb const* const r = rhs.limbPtr();
-    for (size_t i = 0; i < numLimbs(); ++i) {
-        l[i] &= r[i];
+    assert(rhs.any());
+    size_t const n = numLimbs();
+#ifndef NDEBUG
+    /// Copied before `limbPtr()` makes shared limbs unique, otherwise the
+    /// copies would share the limbs that are overwritten with the quotient
+    APInt const numerator = *this;
+    APInt const divisor = rhs;
+#endif
+    Limb* const a = limbPtr();
+    /// Strip trailing zeros so the divisor is odd and invertible
+    size_t const shift = rhs.ctz();
+    assert(none() || ctz() >= shift);
+    ScratchLimbs<8> d(n);
+    std::memcpy(d.data(), rhs.limbPtr(), byteSize());
+    shrBitsInPlace(d.data(), n, shift);
+    shrBitsInPlace(a, n, shift);
+    size_t const nd = normalizedSize(d.data(), n);
+    size_t const na = normalizedSize(a, n);
+    if (na < nd) {
+        assert(na == 0);
+        return *this;
     }
+    size_t const nq = na - nd + 1;
+    Limb const inv = inverse2Adic(d[0]);
+    for (size_t i = 0; i < nq; ++i) {
+        Limb const q = a[i] * inv;
+        size_t const len = std::min(nd, nq - i);
+        Limb const borrow = mulSubLimb(a + i, d.data(), len, q);
+        decrementLimbs(a + i + len, nq - i - len, borrow);
+        assert(a[i] == 0);
+        a[i] = q;
+    }
+    std::memset(a + nq, 0, (n - nq) * LimbSize);
+#ifndef NDEBUG
+    /// Verify that the division was indeed exact
+    ScratchLimbs<16> product(nq + n);
+    mulLimbs(product.data(), a, nq, divisor.limbPtr(), n);
+    assert(cmpLimbs(product.data(), nq + n, numerator.limbPtr(), n) == 0 &&
+           "Remainder of exact division is not zero");
+#endif
     return *this;
 }
 
-APInt& APInt::btwor(APInt const& rhs) {
-    assert(bitwidth() == rhs.bitwidth());
-    Limb* const l = limbPtr();
-    Limb const* const r = rhs.limbPtr();
-    for (size_t i = 0; i < numLimbs(); ++i) {
-        l[i] |= r[i];
+/// Counted as a single `DivExact` call by `divExact()`
+APInt& APInt::sdivExact(APInt const& rhs) {
+    bool const negative = this->negative() != rhs.negative();
+    if (this->negative()) {
+        this->negate();
+    }
+    divExact(rhs.negative() ? APMath::negate(rhs) : rhs);
+    if (negative) {
+        this->negate();
     }
     return *this;
 }
 
-APInt& APInt::btwxor(APInt const& rhs) {
-    assert(bitwidth() == rhs.bitwidth());
-    Limb* const l = limbPtr();
-    Limb const* const r = rhs.limbPtr();
-    for (size_t i = 0; i < numLimbs(); ++i) {
-        l[i] ^= r[i];
-    }
-    l[numLimbs() - 1] &= topLimbMask();
+APInt& APInt::btwand(APInt const& rhs) {
+    APMATH_TRACE(APIntOp::BtwAnd, *this, rhs);
+    APMATH_INSTRUMENT(BtwAnd, bitwidth());
+    APIntRef(*this).btwand(rhs);
     return *this;
 }
 
-static void lshlShort(APInt::Limb* l, size_t numLimbs, size_t bitOffset) {
-    assert(bitOffset < LimbBitSize);
-    Limb carry = 0;
-    size_t const rightShiftAmount = LimbBitSize - bitOffset;
-    for (size_t i = 0; i < numLimbs; ++i) {
-        Limb const newCarry =
-            rightShiftAmount == LimbBitSize ? 0 : l[i] >> rightShiftAmount;
-        l[i] <<= bitOffset;
-        l[i] |= carry;
-        carry = newCarry;
-    }
+APInt& APInt::btwor(APInt const& rhs) {
+    APMATH_TRACE(APIntOp::BtwOr, *this, rhs);
+    APMATH_INSTRUMENT(BtwOr, bitwidth());
+    APIntRef(*this).btwor(rhs);
+    return *this;
 }
 
-APInt& APInt::lshl(int nb) {
-    assert(nb >= 0);
-    assert(nb < (int)_bitwidth);
-    size_t const numBits = static_cast<size_t>(nb);
-    size_t const bitOffset = numBits % LimbBitSize;
-    size_t const limbOffset = numBits / LimbBitSize;
-    Limb* l = limbPtr();
-    if (numBits < LimbBitSize) {
-        lshlShort(l, numLimbs(), bitOffset);
-    }
-    else {
-        size_t i = numLimbs() - limbOffset;
-        size_t j = numLimbs();
-        while (i > 0) {
-            --i;
-            --j;
-            l[j] = l[i];
-        }
-        while (j > 0) {
-            --j;
-            l[j] = 0;
-        }
-        lshlShort(l + limbOffset, numLimbs() - limbOffset, bitOffset);
-    }
+APInt& APInt::btwxor(APInt const& rhs) {
+    APMATH_TRACE(APIntOp::BtwXor, *this, rhs);
+    APMATH_INSTRUMENT(BtwXor, bitwidth());
+    APIntRef(*this).btwxor(rhs);
     return *this;
 }
 
-static void lshrShort(APInt::Limb* l, size_t numLimbs, size_t bitOffset) {
-    using Limb = APInt::Limb;
-    constexpr size_t LimbBitSize = sizeof(Limb) * CHAR_BIT;
-    assert(bitOffset < LimbBitSize);
-    Limb carry = 0;
-    size_t const leftShiftAmount = LimbBitSize - bitOffset;
-    for (size_t i = numLimbs; i > 0;) {
-        --i;
-        Limb const newCarry =
-            leftShiftAmount == LimbBitSize ? 0 : l[i] << leftShiftAmount;
-        l[i] >>= bitOffset;
-        l[i] |= carry;
-        carry = newCarry;
-    }
-}
-
-APInt& APInt::lshr(int nb) {
-    assert(nb >= 0);
-    assert(nb < (int)_bitwidth);
-    size_t const numBits = static_cast<size_t>(nb);
-    size_t const bitOffset = numBits % LimbBitSize;
-    size_t const limbOffset = numBits / LimbBitSize;
-    Limb* l = limbPtr();
-    if (numBits < LimbBitSize) {
-        lshrShort(l, numLimbs(), bitOffset);
-    }
-    else {
-        size_t i = limbOffset;
-        size_t j = 0;
-        for (; i < numLimbs(); ++i, ++j) {
-            l[j] = l[i];
-        }
-        for (; j < numLimbs(); ++j) {
-            l[j] = 0;
-        }
-        lshrShort(l, numLimbs() - limbOffset, bitOffset);
-    }
+APInt& APInt::lshl(int numBits) {
+    APMATH_TRACE(APIntOp::LShl, *this, numBits);
+    APMATH_INSTRUMENT(Shift, bitwidth());
+    APIntRef(*this).lshl(numBits);
+    return *this;
+}
+
+APInt& APInt::lshr(int numBits) {
+    APMATH_TRACE(APIntOp::LShr, *this, numBits);
+    APMATH_INSTRUMENT(Shift, bitwidth());
+    APIntRef(*this).lshr(numBits);
     return *this;
 }
 
 APInt& APInt::ashl(int numBits) { return lshl(numBits); }
 
-APInt& APInt::ashr(int nb) {
-    assert(nb >= 0);
-    size_t const numBits = static_cast<size_t>(nb);
-    assert(numBits < _bitwidth);
-    int const h = highbit();
-    lshr(nb);
-    if (h == 0) {
-        return *this;
-    }
-    Limb* const l = limbPtr();
-    size_t const loopEnd = ceilDiv(bitwidth() - numBits, LimbBitSize);
-    for (size_t i = numLimbs(); i > loopEnd;) {
-        --i;
-        l[i] = Limb(-1);
-    }
-    if (topLimbActiveBits < numBits) {
-        l[loopEnd - 1] |= Limb(-1)
-                          << (LimbBitSize - (numBits - topLimbActiveBits));
-    }
-    else if (topLimbActiveBits == numBits) {
-        l[loopEnd - 1] |= Limb(-1);
-    }
-    else {
-        l[loopEnd - 1] |= Limb(-1) << (topLimbActiveBits - numBits);
-    }
-    l[numLimbs() - 1] &= topLimbMask();
+APInt& APInt::ashr(int numBits) {
+    APMATH_TRACE(APIntOp::AShr, *this, numBits);
+    APMATH_INSTRUMENT(Shift, bitwidth());
+    APIntRef(*this).ashr(numBits);
     return *this;
 }
 
-APInt& APInt::rotl(int) {
-    assert(false);
-    std::abort();
+APInt& APInt::rotl(int numBits) {
+    APMATH_INSTRUMENT(Shift, bitwidth());
+    APIntRef(*this).rotl(numBits);
+    return *this;
 }
 
-APInt& APInt::rotr(int) {
-    assert(false);
-    std::abort();
+APInt& APInt::rotr(int numBits) {
+    APMATH_INSTRUMENT(Shift, bitwidth());
+    APIntRef(*this).rotr(numBits);
+    return *this;
+}
+
+APInt& APInt::bswap() {
+    APIntRef(*this).bswap();
+    return *this;
+}
+
+APInt& APInt::bitreverse() {
+    APIntRef(*this).bitreverse();
+    return *this;
 }
 
 APInt& APInt::negate() {
-    Limb carry = 0;
-    Limb* l = limbPtr();
-    for (size_t i = 0; i < numLimbs(); ++i) {
-        Limb const newCarry = l[i] > 0 || l[i] + carry > 0;
-        l[i] = -l[i] - carry;
-        carry = newCarry;
-    }
-    l[numLimbs() - 1] &= topLimbMask();
+    APIntRef(*this).negate();
     return *this;
 }
 
@@ -538,113 +600,78 @@ APInt& APInt::set(size_t n, bool value) {
 }
 
 APInt& APInt::set(size_t n) {
-    limbPtr()[n / LimbBitSize] |= Limb(1) << (n % LimbBitSize);
+    APIntRef(*this).set(n);
     return *this;
 }
 
 APInt& APInt::clear(size_t n) {
-    limbPtr()[n / LimbBitSize] &= ~(Limb(1) << (n % LimbBitSize));
+    APIntRef(*this).clear(n);
     return *this;
 }
 
 APInt& APInt::flip(size_t n) {
-    limbPtr()[n / LimbBitSize] ^= Limb(1) << (n % LimbBitSize);
+    APIntRef(*this).flip(n);
     return *this;
 }
 
 APInt& APInt::flip() {
-    Limb* const l = limbPtr();
-    for (size_t i = 0; i < numLimbs(); ++i) {
-        l[i] = ~l[i];
-    }
-    l[numLimbs() - 1] &= topLimbMask();
+    APIntRef(*this).flip();
     return *this;
 }
 
-bool APInt::test(size_t n) const {
-    return limbPtr()[n / LimbBitSize] & (Limb(1) << (n % LimbBitSize));
+APInt& APInt::insertBits(APInt const& value, size_t lo) {
+    APIntRef(*this).insertBits(value, lo);
+    return *this;
 }
 
-bool APInt::all() const {
-    size_t const end = numLimbs() - 1;
-    for (size_t i = 0; i < end; ++i) {
-        if (limbPtr()[i] != ~Limb(0)) {
-            return false;
-        }
-    }
-    if (limbPtr()[end] != topLimbMask()) {
-        return false;
-    }
-    return true;
+APInt& APInt::setBits(size_t lo, size_t hi) {
+    APIntRef(*this).setBits(lo, hi);
+    return *this;
 }
 
-bool APInt::any() const { return !none(); }
-
-bool APInt::none() const {
-    for (size_t i = 0, end = numLimbs(); i < end; ++i) {
-        if (limbPtr()[i] != 0) {
-            return false;
-        }
-    }
-    return true;
+APInt& APInt::clearBits(size_t lo, size_t hi) {
+    APIntRef(*this).clearBits(lo, hi);
+    return *this;
 }
 
-size_t APInt::popcount() const {
-    size_t result = 0;
-    for (size_t i = 0, end = numLimbs(); i < end; ++i) {
-        result += static_cast<size_t>(std::popcount(limbPtr()[i]));
-    }
-    return result;
+APInt APInt::extractBits(size_t lo, size_t width) const {
+    return APIntView(*this).extractBits(lo, width);
 }
 
-size_t APInt::clz() const {
-    auto* const l = limbPtr();
-    size_t i = numLimbs() - 1;
-    size_t result = 0;
-    if (auto const limb = l[i]; limb != 0) {
-        return static_cast<size_t>(std::countl_zero(limb)) -
-               (LimbBitSize - topLimbActiveBits);
-    }
-    result += topLimbActiveBits;
-    for (; i != 0;) {
-        --i;
-        auto const limb = l[i];
-        if (limb != 0) {
-            return result + static_cast<size_t>(std::countl_zero(limb));
-        }
-        result += LimbBitSize;
-    }
-    return result;
+size_t APInt::findNextSet(size_t pos) const {
+    return APIntView(*this).findNextSet(pos);
 }
 
-size_t APInt::ctz() const {
-    size_t const end = numLimbs() - 1;
-    auto* const l = limbPtr();
-    size_t result = 0;
-    for (size_t i = 0; i < end; ++i) {
-        auto const limb = l[i];
-        if (limb != 0) {
-            return result + static_cast<size_t>(std::countr_zero(limb));
-        }
-        result += LimbBitSize;
-    }
-    auto const limb = l[end];
-    if (limb != 0) {
-        return result + static_cast<size_t>(std::countr_zero(limb));
-    }
-    return result + topLimbActiveBits;
+size_t APInt::findPrevSet(size_t pos) const {
+    return APIntView(*this).findPrevSet(pos);
 }
 
+bool APInt::test(size_t n) const { return APIntView(*this).test(n); }
+
+bool APInt::all() const { return APIntView(*this).all(); }
+
+bool APInt::any() const { return !none(); }
+
+bool APInt::none() const { return APIntView(*this).none(); }
+
+size_t APInt::popcount() const { return APIntView(*this).popcount(); }
+
+size_t APInt::clz() const { return APIntView(*this).clz(); }
+
+size_t APInt::ctz() const { return APIntView(*this).ctz(); }
+
 APInt& APInt::zext(size_t bitwidth) {
-    return *this = APInt({ limbPtr(), numLimbs() }, bitwidth);
+    APMATH_INSTRUMENT(Extend, this->bitwidth());
+    return *this = APInt(limbs(), bitwidth);
 }
 
 APInt& APInt::sext(size_t bitwidth) {
+    APMATH_INSTRUMENT(Extend, this->bitwidth());
     int const h = highbit();
     size_t const oldWidth = this->bitwidth();
     Limb const oldTopMask = topLimbMask();
     size_t const oldnumLimbs = numLimbs();
-    zext(bitwidth);
+    *this = APInt(limbs(), bitwidth);
     if (oldWidth >= bitwidth || h == 0) {
         return *this;
     }
@@ -658,87 +685,33 @@ APInt& APInt::sext(size_t bitwidth) {
 }
 
 int APInt::scmp(APInt const& rhs) const {
-    assert(bitwidth() == rhs.bitwidth());
-    int const l = highbit();
-    int const r = rhs.highbit();
-    if (l == r) {
-        return ucmp(rhs);
-    }
-    else {
-        return r - l;
-    }
+    APMATH_TRACE(APIntOp::CmpSLT, *this, rhs);
+    APMATH_INSTRUMENT(Compare, bitwidth());
+    return APIntView(*this).scmp(rhs);
 }
 
 bool APInt::negative() const { return highbit() != 0; }
 
-static int ucmpImpl(APInt::Limb const* lhs,
-                    size_t lhsNumLimbs,
-                    APInt::Limb const* rhs,
-                    size_t rhsNumLimbs) {
-    if (lhsNumLimbs != rhsNumLimbs) {
-        /// If one is bigger than the other, we need to test the top limbs
-        /// separately.
-        auto const [bigPtr, bigSize, smallPtr, smallSize] =
-            lhsNumLimbs > rhsNumLimbs ?
-                std::tuple{ lhs, lhsNumLimbs, rhs, rhsNumLimbs } :
-                std::tuple{ rhs, rhsNumLimbs, lhs, lhsNumLimbs };
-        for (size_t i = smallSize; i != bigSize; ++i) {
-            if (bigPtr[i] != 0) {
-                return bigPtr == lhs ? 1 : -1;
-            }
-        }
-    }
-    for (size_t i = std::min(lhsNumLimbs, rhsNumLimbs); i > 0;) {
-        --i;
-        if (lhs[i] == rhs[i]) {
-            continue;
-        }
-        if (lhs[i] < rhs[i]) {
-            return -1;
-        }
-        return 1;
-    }
-    return 0;
-}
-
 int APInt::ucmp(APInt const& rhs) const {
-    assert(bitwidth() == rhs.bitwidth());
-    return ucmpImpl(limbPtr(), numLimbs(), rhs.limbPtr(), rhs.numLimbs());
+    APMATH_TRACE(APIntOp::CmpULT, *this, rhs);
+    APMATH_INSTRUMENT(Compare, bitwidth());
+    return APIntView(*this).ucmp(rhs);
 }
 
 int APInt::ucmp(uint64_t rhs) const {
-    if (numLimbs() == 1) {
-        rhs &= topLimbMask();
-    }
-    return ucmpImpl(limbPtr(), numLimbs(), &rhs, 1);
+    APMATH_INSTRUMENT(Compare, bitwidth());
+    return APIntView(*this).ucmp(rhs);
 }
 
-static char intToSymbol(Limb l) {
-    if (l < 10) {
-        return static_cast<char>('0' + static_cast<int>(l));
-    }
-    return static_cast<char>('A' + static_cast<int>(l) - 10);
+std::string APInt::toString(int b) const& {
+    APMATH_INSTRUMENT(ToString, bitwidth());
+    assert(b >= 2);
+    assert(b <= 36);
+    return limbsToString(limbPtr(), numLimbs(), b);
 }
 
-std::string APInt::toString(int b) const& { return APInt(*this).toString(b); }
-
 std::string APInt::toString(int b) && {
-    assert(b >= 2);
-    assert(b <= 36);
-    zext(std::max<size_t>(8, bitwidth()));
-    std::string res;
-    APInt const base(uint64_t(b), bitwidth());
-    while (ucmp(0) != 0) {
-        auto [q, r] = udivrem(*this, base);
-        assert(r.ucmp(base) < 0);
-        res.push_back(intToSymbol(*r.limbPtr()));
-        *this = std::move(q);
-    }
-    std::reverse(res.begin(), res.end());
-    if (res.empty()) {
-        return "0";
-    }
-    return res;
+    return static_cast<APInt const&>(*this).toString(b);
 }
 
 std::string APInt::signedToString(int base) const {
@@ -761,17 +734,19 @@ static char charDigitToInt(char d) {
     return D - 'A' + 10;
 }
 
-static void div2(std::vector<char>& str, int base) {
-    int const halfBase = base / 2;
-    int nextAdditive = 0;
+/// Divides the digits \p str in place by two
+/// \Returns the remainder
+static int div2(std::vector<char>& str, int base) {
+    int remainder = 0;
     for (char& d: str) {
-        int const additive = nextAdditive;
-        nextAdditive = d % 2 ? halfBase : 0;
-        d = static_cast<char>(d / 2 + additive);
+        int const value = remainder * base + d;
+        d = static_cast<char>(value / 2);
+        remainder = value % 2;
     }
     if (str.size() > 1 && str[0] == 0) {
         str.erase(str.begin());
     }
+    return remainder;
 }
 
 static int isDigit(char c, int base) {
@@ -807,6 +782,7 @@ static int extractSign(std::string_view s, int base) {
 std::optional<APInt> APInt::parse(std::string_view s,
                                   int base,
                                   size_t targetBW) {
+    APMATH_INSTRUMENT(Parse, targetBW);
     assert(base >= 2);
     assert(base <= 36);
     int sign = extractSign(s, base);
@@ -835,9 +811,8 @@ std::optional<APInt> APInt::parse(std::string_view s,
                 return std::nullopt;
             }
         }
-        l[(requiredBW - 1) / LimbBitSize] |=
-            Limb(str.back() % 2) << ((requiredBW - 1) % LimbBitSize);
-        div2(str, base);
+        l[(requiredBW - 1) / LimbBitSize] |= Limb(div2(str, base))
+                                              << ((requiredBW - 1) % LimbBitSize);
     }
     if (res.ucmp(0) == 0) {
         sign = 1;
@@ -857,24 +832,183 @@ std::optional<APInt> APInt::parse(std::string_view s,
     return res;
 }
 
-constexpr size_t initSeed = 0x9e3779b97f4a7c15;
+/// \Returns the limb stored in the 8 bytes at \p src in byte order \p endian
+static Limb loadLimb(std::byte const* src, std::endian endian) {
+    Limb limb;
+    std::memcpy(&limb, src, LimbSize);
+    return endian == std::endian::native ? limb : byteSwap(limb);
+}
 
-void hashCombine(std::size_t& seed, Limb v) {
-    seed ^= v + initSeed + (seed << 6) + (seed >> 2);
+/// Stores \p limb to the 8 bytes at \p dest in byte order \p endian
+static void storeLimb(std::byte* dest, Limb limb, std::endian endian) {
+    if (endian != std::endian::native) {
+        limb = byteSwap(limb);
+    }
+    std::memcpy(dest, &limb, LimbSize);
 }
 
-size_t APInt::hash() const {
-    size_t seed = initSeed;
-    for (Limb const l: limbs()) {
-        hashCombine(seed, l);
+/// Reads the \p numBytes byte integer at \p src into \p limbs. Full limbs are
+/// loaded as words, only the remaining top bytes are assembled one by one.
+static void bytesToLimbs(Limb* limbs,
+                         std::byte const* src,
+                         size_t numBytes,
+                         std::endian endian) {
+    size_t const numFull = numBytes / LimbSize;
+    size_t const numRem = numBytes % LimbSize;
+    if (endian == std::endian::little) {
+        for (size_t i = 0; i < numFull; ++i) {
+            limbs[i] = loadLimb(src + i * LimbSize, endian);
+        }
+        Limb top = 0;
+        for (size_t k = numRem; k-- > 0;) {
+            top = top << CHAR_BIT | Limb(src[numFull * LimbSize + k]);
+        }
+        if (numRem > 0) {
+            limbs[numFull] = top;
+        }
+        return;
+    }
+    /// Big endian: The least significant limb is stored last
+    for (size_t i = 0; i < numFull; ++i) {
+        limbs[i] = loadLimb(src + numBytes - (i + 1) * LimbSize, endian);
+    }
+    Limb top = 0;
+    for (size_t k = 0; k < numRem; ++k) {
+        top = top << CHAR_BIT | Limb(src[k]);
+    }
+    if (numRem > 0) {
+        limbs[numFull] = top;
+    }
+}
+
+/// Writes the low \p numBytes bytes of \p limbs to \p dest
+static void limbsToBytes(std::byte* dest,
+                         Limb const* limbs,
+                         size_t numBytes,
+                         std::endian endian) {
+    size_t const numFull = numBytes / LimbSize;
+    size_t const numRem = numBytes % LimbSize;
+    Limb const top = numRem > 0 ? limbs[numFull] : 0;
+    if (endian == std::endian::little) {
+        for (size_t i = 0; i < numFull; ++i) {
+            storeLimb(dest + i * LimbSize, limbs[i], endian);
+        }
+        for (size_t k = 0; k < numRem; ++k) {
+            dest[numFull * LimbSize + k] = std::byte(top >> (k * CHAR_BIT));
+        }
+        return;
+    }
+    for (size_t i = 0; i < numFull; ++i) {
+        storeLimb(dest + numBytes - (i + 1) * LimbSize, limbs[i], endian);
+    }
+    for (size_t k = 0; k < numRem; ++k) {
+        dest[k] = std::byte(top >> ((numRem - 1 - k) * CHAR_BIT));
+    }
+}
+
+APInt APInt::fromBytes(std::span<std::byte const> bytes,
+                       std::endian endian,
+                       size_t bitwidth) {
+    size_t const numBytes = ceilDiv(bitwidth, CHAR_BIT);
+    assert(bytes.size() >= numBytes);
+    APInt result(bitwidth);
+    bytesToLimbs(result.limbPtr(), bytes.data(), numBytes, endian);
+    result.limbPtr()[result.numLimbs() - 1] &= result.topLimbMask();
+    return result;
+}
+
+std::vector<APInt> APInt::fromBytes(std::span<std::byte const> bytes,
+                                    std::endian endian,
+                                    size_t bitwidth,
+                                    size_t stride) {
+    size_t const numBytes = ceilDiv(bitwidth, CHAR_BIT);
+    if (stride == 0) {
+        stride = numBytes;
+    }
+    assert(stride >= numBytes);
+    std::vector<APInt> result;
+    result.reserve(bytes.size() / stride);
+    for (size_t offset = 0; offset + stride <= bytes.size(); offset += stride)
+    {
+        result.push_back(fromBytes(bytes.subspan(offset), endian, bitwidth));
+    }
+    return result;
+}
+
+void APInt::toBytes(std::span<std::byte> bytes, std::endian endian) const {
+    size_t const numBytes = ceilDiv(bitwidth(), CHAR_BIT);
+    assert(bytes.size() >= numBytes);
+    limbsToBytes(bytes.data(), limbPtr(), numBytes, endian);
+}
+
+void APInt::toBytes(std::span<APInt const> values,
+                    std::span<std::byte> bytes,
+                    std::endian endian,
+                    size_t stride) {
+    if (values.empty()) {
+        return;
+    }
+    size_t const numBytes = ceilDiv(values.front().bitwidth(), CHAR_BIT);
+    if (stride == 0) {
+        stride = numBytes;
+    }
+    assert(stride >= numBytes);
+    assert(bytes.size() >= values.size() * stride);
+    for (size_t i = 0; i < values.size(); ++i) {
+        assert(values[i].bitwidth() == values.front().bitwidth());
+        std::byte* const slot = bytes.data() + i * stride;
+        values[i].toBytes({ slot, numBytes }, endian);
+        std::memset(slot + numBytes, 0, stride - numBytes);
     }
-    return seed;
 }
 
 APInt::Limb* APInt::allocate(size_t numLimbs) {
+    APMATH_RECORD_ALLOCATION(numLimbs * LimbSize);
     return static_cast<Limb*>(std::malloc(numLimbs * LimbSize));
 }
 
 void APInt::deallocate(Limb* ptr, [[maybe_unused]] size_t numLimbs) {
+    APMATH_RECORD_DEALLOCATION(numLimbs * LimbSize);
     std::free(ptr);
 }
+
+APInt& APInt::share() {
+    if (isLocal() || sharedLimbs) {
+        return *this;
+    }
+    Limb* const limbs = allocateShared(numLimbs());
+    std::memcpy(limbs, heapLimbs, byteSize());
+    deallocate(heapLimbs, numLimbs());
+    heapLimbs = limbs;
+    sharedLimbs = true;
+    return *this;
+}
+
+size_t APInt::useCount() const {
+    if (!isShared()) {
+        return 1;
+    }
+    return refCount(heapLimbs).load(std::memory_order_relaxed);
+}
+
+void APInt::makeUnique() {
+    assert(isShared());
+    /// If we hold the only reference no other thread can acquire one, so the
+    /// limbs can be modified in place
+    if (refCount(heapLimbs).load(std::memory_order_acquire) == 1) {
+        return;
+    }
+    Limb* const limbs = allocateShared(numLimbs());
+    std::memcpy(limbs, heapLimbs, byteSize());
+    releaseShared(heapLimbs, numLimbs());
+    heapLimbs = limbs;
+}
+
+void APInt::releaseHeapLimbs(size_t numLimbs) {
+    if (sharedLimbs) {
+        releaseShared(heapLimbs, numLimbs);
+    }
+    else {
+        deallocate(heapLimbs, numLimbs);
+    }
+}
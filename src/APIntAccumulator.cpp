@@ -0,0 +1,149 @@
+#include <APMath/APIntAccumulator.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "LimbOps.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+/// Carry counters are signed 64 bit integers. We fold them into the sums before
+/// their magnitude can exceed this bound, so normalization never overflows.
+static constexpr std::uint64_t MaxHeadroom = std::uint64_t(1) << 62;
+
+APIntAccumulator::APIntAccumulator(std::size_t bitwidth):
+    _bitwidth(bitwidth),
+    _headroom(MaxHeadroom),
+    _sums(ceilDiv(bitwidth, LimbBitSize)),
+    _carries(_sums.size()) {}
+
+APIntAccumulator::APIntAccumulator(APInt const& value):
+    APIntAccumulator(value.bitwidth()) {
+    std::copy(value.limbs().begin(), value.limbs().end(), _sums.begin());
+}
+
+APIntAccumulator& APIntAccumulator::add(APInt const& value) {
+    assert(value.bitwidth() == bitwidth() && "Bitwidths must match");
+    reserveCarries(1);
+    Limb const* v = APIntAccess::limbPtr(value);
+    for (std::size_t i = 0; i < _sums.size(); ++i) {
+        accumulate(i, v[i]);
+    }
+    return *this;
+}
+
+APIntAccumulator& APIntAccumulator::add(std::uint64_t value) {
+    if (_sums.empty()) {
+        return *this;
+    }
+    reserveCarries(1);
+    accumulate(0, value);
+    return *this;
+}
+
+APIntAccumulator& APIntAccumulator::sub(APInt const& value) {
+    assert(value.bitwidth() == bitwidth() && "Bitwidths must match");
+    reserveCarries(1);
+    Limb const* v = APIntAccess::limbPtr(value);
+    for (std::size_t i = 0; i < _sums.size(); ++i) {
+        deduct(i, v[i]);
+    }
+    return *this;
+}
+
+APIntAccumulator& APIntAccumulator::sub(std::uint64_t value) {
+    if (_sums.empty()) {
+        return *this;
+    }
+    reserveCarries(1);
+    deduct(0, value);
+    return *this;
+}
+
+APIntAccumulator& APIntAccumulator::mulAdd(APInt const& lhs, APInt const& rhs) {
+    assert(lhs.bitwidth() == bitwidth() && "Bitwidths must match");
+    assert(rhs.bitwidth() == bitwidth() && "Bitwidths must match");
+    std::size_t const n = _sums.size();
+    /// Limb `k` receives a low and a high product word from each of the `k + 1`
+    /// pairs `(i, j)` with `i + j == k` (resp. `i + j + 1 == k`)
+    reserveCarries(2 * n);
+    Limb const* a = APIntAccess::limbPtr(lhs);
+    Limb const* b = APIntAccess::limbPtr(rhs);
+    for (std::size_t j = 0; j < n; ++j) {
+        if (b[j] == 0) {
+            continue;
+        }
+        for (std::size_t i = 0; i + j < n; ++i) {
+            accumulate(i + j, a[i] * b[j]);
+            if (i + j + 1 < n) {
+                accumulate(i + j + 1, mulHi(a[i], b[j]));
+            }
+        }
+    }
+    return *this;
+}
+
+APIntAccumulator& APIntAccumulator::mulAdd(APInt const& lhs,
+                                           std::uint64_t rhs) {
+    assert(lhs.bitwidth() == bitwidth() && "Bitwidths must match");
+    std::size_t const n = _sums.size();
+    if (rhs == 0) {
+        return *this;
+    }
+    reserveCarries(2);
+    Limb const* a = APIntAccess::limbPtr(lhs);
+    for (std::size_t i = 0; i < n; ++i) {
+        accumulate(i, a[i] * rhs);
+        if (i + 1 < n) {
+            accumulate(i + 1, mulHi(a[i], rhs));
+        }
+    }
+    return *this;
+}
+
+void APIntAccumulator::clear() {
+    std::fill(_sums.begin(), _sums.end(), 0);
+    std::fill(_carries.begin(), _carries.end(), 0);
+    _headroom = MaxHeadroom;
+}
+
+APInt APIntAccumulator::value() const {
+    APInt result(bitwidth());
+    normalize(APIntAccess::limbPtr(result));
+    APIntAccess::clearUnusedBits(result);
+    return result;
+}
+
+void APIntAccumulator::reserveCarries(std::uint64_t count) {
+    if (count <= _headroom) {
+        _headroom -= count;
+        return;
+    }
+    normalize(_sums.data());
+    std::fill(_carries.begin(), _carries.end(), 0);
+    assert(count <= MaxHeadroom && "Too many limbs");
+    _headroom = MaxHeadroom - count;
+}
+
+void APIntAccumulator::normalize(Limb* result) const {
+    /// `carry` is the signed number of units of `2^64` flowing into limb `i`.
+    /// Its magnitude is bounded by the headroom plus one, so it never
+    /// overflows.
+    std::int64_t carry = 0;
+    for (std::size_t i = 0; i < _sums.size(); ++i) {
+        Limb const sum = _sums[i];
+        Limb limb;
+        std::int64_t overflow;
+        if (carry >= 0) {
+            limb = sum + static_cast<Limb>(carry);
+            overflow = limb < sum;
+        }
+        else {
+            limb = sum - static_cast<Limb>(-carry);
+            overflow = -std::int64_t(limb > sum);
+        }
+        result[i] = limb;
+        carry = _carries[i] + overflow;
+    }
+}
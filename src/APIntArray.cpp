@@ -0,0 +1,168 @@
+#include <APMath/APIntArray.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+#include "LimbOps.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+APIntArray::APIntArray(size_t size, size_t bitwidth):
+    _size(size),
+    _bitwidth(bitwidth),
+    _limbs(ceilDiv(size * bitwidth, LimbBitSize)) {
+    assert(bitwidth > 0);
+}
+
+APIntArray::APIntArray(std::span<APInt const> elements):
+    APIntArray(elements.size(),
+               elements.empty() ? 1 : elements.front().bitwidth()) {
+    for (size_t i = 0; i < _size; ++i) {
+        store(i, elements[i]);
+    }
+}
+
+std::vector<APInt> APIntArray::toAPInts() const {
+    std::vector<APInt> result;
+    result.reserve(_size);
+    for (size_t i = 0; i < _size; ++i) {
+        result.push_back(load(i));
+    }
+    return result;
+}
+
+void APIntArray::fill(APInt const& value) { fill(0, _size, value); }
+
+void APIntArray::fill(size_t index, size_t count, APInt const& value) {
+    assert(index + count <= _size);
+    assert(value.bitwidth() == _bitwidth);
+    /// The bit pattern of consecutive equal elements repeats every
+    /// `lcm(bitwidth, 64)` bits, i.e. every `periodLimbs` limbs. We store
+    /// elements one by one up to the first element that starts at a limb
+    /// boundary, store one period and then replicate it limb by limb.
+    size_t const period = std::lcm(_bitwidth, LimbBitSize);
+    size_t const periodElems = period / _bitwidth;
+    size_t const periodLimbs = period / LimbBitSize;
+    size_t const end = index + count;
+    while (index < end && index * _bitwidth % LimbBitSize != 0) {
+        store(index++, value);
+    }
+    size_t const numPeriods = (end - index) / periodElems;
+    if (numPeriods > 1) {
+        size_t const first = index * _bitwidth / LimbBitSize;
+        for (size_t i = 0; i < periodElems; ++i) {
+            store(index + i, value);
+        }
+        Limb* limbs = _limbs.data() + first;
+        for (size_t i = periodLimbs; i < numPeriods * periodLimbs; ++i) {
+            limbs[i] = limbs[i - periodLimbs];
+        }
+        index += numPeriods * periodElems;
+    }
+    while (index < end) {
+        store(index++, value);
+    }
+}
+
+void APIntArray::copy(APIntArray& dest,
+                      size_t destIndex,
+                      APIntArray const& src,
+                      size_t srcIndex,
+                      size_t count) {
+    assert(dest._bitwidth == src._bitwidth);
+    assert(destIndex + count <= dest._size);
+    assert(srcIndex + count <= src._size);
+    size_t const numBits = count * src._bitwidth;
+    size_t const destPos = destIndex * dest._bitwidth;
+    size_t const srcPos = srcIndex * src._bitwidth;
+    Limb* d = dest._limbs.data();
+    Limb const* s = src._limbs.data();
+    auto copyChunk = [&](size_t offset) {
+        size_t const n = std::min(LimbBitSize, numBits - offset);
+        storeBits(d, destPos + offset, n, loadBits(s, srcPos + offset, n));
+    };
+    /// Copying backwards when the destination lies above the source within
+    /// the same array reads every chunk before it is overwritten
+    if (&dest == &src && destPos > srcPos) {
+        for (size_t i = ceilDiv(numBits, LimbBitSize); i-- > 0;) {
+            copyChunk(i * LimbBitSize);
+        }
+    }
+    else {
+        for (size_t offset = 0; offset < numBits; offset += LimbBitSize) {
+            copyChunk(offset);
+        }
+    }
+}
+
+bool APIntArray::equal(APIntArray const& lhs,
+                       size_t lhsIndex,
+                       APIntArray const& rhs,
+                       size_t rhsIndex,
+                       size_t count) {
+    assert(lhsIndex + count <= lhs._size);
+    assert(rhsIndex + count <= rhs._size);
+    if (lhs._bitwidth != rhs._bitwidth) {
+        return false;
+    }
+    size_t const numBits = count * lhs._bitwidth;
+    size_t const lhsPos = lhsIndex * lhs._bitwidth;
+    size_t const rhsPos = rhsIndex * rhs._bitwidth;
+    for (size_t offset = 0; offset < numBits; offset += LimbBitSize) {
+        size_t const n = std::min(LimbBitSize, numBits - offset);
+        if (loadBits(lhs._limbs.data(), lhsPos + offset, n) !=
+            loadBits(rhs._limbs.data(), rhsPos + offset, n))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void APIntArray::resize(size_t size) {
+    size_t const numBits = size * _bitwidth;
+    _limbs.resize(ceilDiv(numBits, LimbBitSize));
+    if (size < _size && numBits % LimbBitSize != 0) {
+        _limbs.back() &= lowBitMask(numBits % LimbBitSize);
+    }
+    _size = size;
+}
+
+void APIntArray::push_back(APInt const& value) {
+    resize(_size + 1);
+    store(_size - 1, value);
+}
+
+APInt APIntArray::load(size_t index) const {
+    assert(index < _size);
+    APInt result(_bitwidth);
+    Limb* r = APIntAccess::limbPtr(result);
+    size_t const pos = index * _bitwidth;
+    for (size_t i = 0; i < ceilDiv(_bitwidth, LimbBitSize); ++i) {
+        size_t const n = std::min(LimbBitSize, _bitwidth - i * LimbBitSize);
+        r[i] = loadBits(_limbs.data(), pos + i * LimbBitSize, n);
+    }
+    return result;
+}
+
+void APIntArray::store(size_t index, APInt const& value) {
+    assert(index < _size);
+    assert(value.bitwidth() == _bitwidth);
+    auto limbs = value.limbs();
+    size_t const pos = index * _bitwidth;
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        size_t const n = std::min(LimbBitSize, _bitwidth - i * LimbBitSize);
+        storeBits(_limbs.data(), pos + i * LimbBitSize, n, limbs[i]);
+    }
+}
+
+Limb APIntArray::loadLowBits(size_t index, size_t numBits) const {
+    assert(index < _size);
+    return loadBits(_limbs.data(),
+                    index * _bitwidth,
+                    std::min(numBits, _bitwidth));
+}
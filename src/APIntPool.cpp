@@ -0,0 +1,144 @@
+#include <APMath/APIntPool.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "LimbOps.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+namespace {
+
+struct Entry {
+    APIntView value;
+    size_t hash;
+};
+
+struct EntryHash {
+    size_t operator()(Entry const& entry) const { return entry.hash; }
+};
+
+struct EntryEqual {
+    bool operator()(Entry const& lhs, Entry const& rhs) const {
+        return lhs.value.bitwidth() == rhs.value.bitwidth() &&
+               std::ranges::equal(lhs.value.limbs(), rhs.value.limbs());
+    }
+};
+
+} // namespace
+
+/// Limbs are allocated from arenas of this many limbs
+static constexpr size_t ArenaLimbs = 512;
+
+/// Values with more limbs get a block of their own, so starting a new arena
+/// never wastes more than this many limbs of the current one
+static constexpr size_t MaxArenaValueLimbs = ArenaLimbs / 2;
+
+/// Padded to a cache line so that locking one shard does not contend with
+/// neighbouring shards
+struct alignas(64) APIntPool::Shard {
+    Limb* allocate(size_t numLimbs) {
+        limbBytes += numLimbs * LimbSize;
+        if (numLimbs > MaxArenaValueLimbs) {
+            arenas.push_back(std::make_unique<Limb[]>(numLimbs));
+            arenaBytes += numLimbs * LimbSize;
+            return arenas.back().get();
+        }
+        if (numLimbs > arenaRemaining) {
+            arenas.push_back(std::make_unique<Limb[]>(ArenaLimbs));
+            arenaBytes += ArenaLimbs * LimbSize;
+            arenaPos = arenas.back().get();
+            arenaRemaining = ArenaLimbs;
+        }
+        Limb* const result = arenaPos;
+        arenaPos += numLimbs;
+        arenaRemaining -= numLimbs;
+        return result;
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_set<Entry, EntryHash, EntryEqual> entries;
+    std::vector<std::unique_ptr<Limb[]>> arenas;
+    Limb* arenaPos = nullptr;
+    size_t arenaRemaining = 0;
+    size_t numLookups = 0;
+    size_t numHits = 0;
+    size_t limbBytes = 0;
+    size_t arenaBytes = 0;
+};
+
+static size_t shardCount(size_t numShards) {
+    return std::bit_ceil(std::max<size_t>(numShards, 1));
+}
+
+APIntPool::APIntPool(size_t numShards):
+    shards(std::make_unique<Shard[]>(shardCount(numShards))),
+    shardMask(shardCount(numShards) - 1) {}
+
+APIntPool::~APIntPool() = default;
+
+APIntPool::Shard& APIntPool::shardFor(size_t hash) const {
+    /// The table uses the low bits of the hash, so select the shard with the
+    /// high bits
+    return shards[(hash >> 40) & shardMask];
+}
+
+APIntView APIntPool::intern(APIntView value) {
+    size_t const hash = value.hash();
+    Shard& shard = shardFor(hash);
+    std::lock_guard lock(shard.mutex);
+    ++shard.numLookups;
+    auto itr = shard.entries.find(Entry{ value, hash });
+    if (itr != shard.entries.end()) {
+        ++shard.numHits;
+        return itr->value;
+    }
+    size_t const numLimbs = value.numLimbs();
+    Limb* const limbs = shard.allocate(numLimbs);
+    std::memcpy(limbs, value.limbs().data(), numLimbs * LimbSize);
+    APIntView const pooled(limbs, value.bitwidth());
+    shard.entries.insert(Entry{ pooled, hash });
+    return pooled;
+}
+
+bool APIntPool::contains(APIntView value) const {
+    size_t const hash = value.hash();
+    Shard const& shard = shardFor(hash);
+    std::lock_guard lock(shard.mutex);
+    return shard.entries.contains(Entry{ value, hash });
+}
+
+size_t APIntPool::size() const {
+    size_t result = 0;
+    for (size_t i = 0; i <= shardMask; ++i) {
+        std::lock_guard lock(shards[i].mutex);
+        result += shards[i].entries.size();
+    }
+    return result;
+}
+
+APIntPool::Statistics APIntPool::statistics() const {
+    Statistics stats;
+    for (size_t i = 0; i <= shardMask; ++i) {
+        Shard const& shard = shards[i];
+        std::lock_guard lock(shard.mutex);
+        stats.numValues += shard.entries.size();
+        stats.numLookups += shard.numLookups;
+        stats.numHits += shard.numHits;
+        stats.limbBytes += shard.limbBytes;
+        stats.arenaBytes += shard.arenaBytes;
+        /// One node per entry holding the entry and the next pointer plus one
+        /// pointer per bucket
+        stats.tableBytes +=
+            shard.entries.size() * (sizeof(Entry) + sizeof(void*)) +
+            shard.entries.bucket_count() * sizeof(void*);
+    }
+    return stats;
+}
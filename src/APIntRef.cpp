@@ -0,0 +1,452 @@
+#include <APMath/APIntRef.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <tuple>
+
+#include "LimbOps.h"
+#include "Multiply.h"
+#include "RadixConversion.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+using std::uint64_t;
+
+static Limb topLimbMask(size_t bitwidth) {
+    size_t const activeBits = ceilRem(bitwidth, LimbBitSize);
+    return activeBits == LimbBitSize ? ~Limb(0) : (Limb(1) << activeBits) - 1;
+}
+
+bool APIntView::all() const {
+    size_t const end = numLimbs() - 1;
+    for (size_t i = 0; i < end; ++i) {
+        if (_limbs[i] != ~Limb(0)) {
+            return false;
+        }
+    }
+    return _limbs[end] == topLimbMask(_bitwidth);
+}
+
+bool APIntView::none() const {
+    for (size_t i = 0, end = numLimbs(); i < end; ++i) {
+        if (_limbs[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t APIntView::popcount() const {
+    size_t result = 0;
+    for (size_t i = 0, end = numLimbs(); i < end; ++i) {
+        result += static_cast<size_t>(std::popcount(_limbs[i]));
+    }
+    return result;
+}
+
+size_t APIntView::clz() const {
+    size_t const topLimbActiveBits = ceilRem(_bitwidth, LimbBitSize);
+    size_t i = numLimbs() - 1;
+    size_t result = 0;
+    if (auto const limb = _limbs[i]; limb != 0) {
+        return static_cast<size_t>(std::countl_zero(limb)) -
+               (LimbBitSize - topLimbActiveBits);
+    }
+    result += topLimbActiveBits;
+    for (; i != 0;) {
+        --i;
+        auto const limb = _limbs[i];
+        if (limb != 0) {
+            return result + static_cast<size_t>(std::countl_zero(limb));
+        }
+        result += LimbBitSize;
+    }
+    return result;
+}
+
+size_t APIntView::ctz() const {
+    size_t const n = numLimbs();
+    for (size_t i = 0; i < n; ++i) {
+        if (_limbs[i] != 0) {
+            return i * LimbBitSize +
+                   static_cast<size_t>(std::countr_zero(_limbs[i]));
+        }
+    }
+    return _bitwidth;
+}
+
+APInt APIntView::extractBits(size_t lo, size_t width) const {
+    assert(width > 0);
+    assert(lo + width <= bitwidth());
+    APInt result(width);
+    Limb* r = APIntAccess::limbPtr(result);
+    for (size_t i = 0, n = ceilDiv(width, LimbBitSize); i < n; ++i) {
+        size_t const pos = i * LimbBitSize;
+        r[i] = loadBits(_limbs, lo + pos, std::min(LimbBitSize, width - pos));
+    }
+    return result;
+}
+
+size_t APIntView::findNextSet(size_t pos) const {
+    if (pos >= bitwidth()) {
+        return bitwidth();
+    }
+    size_t i = pos / LimbBitSize;
+    Limb limb = _limbs[i] & (~Limb(0) << (pos % LimbBitSize));
+    while (limb == 0) {
+        if (++i == numLimbs()) {
+            return bitwidth();
+        }
+        limb = _limbs[i];
+    }
+    return i * LimbBitSize + static_cast<size_t>(std::countr_zero(limb));
+}
+
+size_t APIntView::findPrevSet(size_t pos) const {
+    pos = std::min(pos, bitwidth() - 1);
+    size_t i = pos / LimbBitSize;
+    Limb limb = _limbs[i] & lowBitMask(pos % LimbBitSize + 1);
+    while (limb == 0) {
+        if (i-- == 0) {
+            return bitwidth();
+        }
+        limb = _limbs[i];
+    }
+    return i * LimbBitSize + LimbBitSize - 1 -
+           static_cast<size_t>(std::countl_zero(limb));
+}
+
+static int ucmpImpl(Limb const* lhs,
+                    size_t lhsNumLimbs,
+                    Limb const* rhs,
+                    size_t rhsNumLimbs) {
+    if (lhsNumLimbs != rhsNumLimbs) {
+        /// If one is bigger than the other, we need to test the top limbs
+        /// separately.
+        auto const [bigPtr, bigSize, smallPtr, smallSize] =
+            lhsNumLimbs > rhsNumLimbs ?
+                std::tuple{ lhs, lhsNumLimbs, rhs, rhsNumLimbs } :
+                std::tuple{ rhs, rhsNumLimbs, lhs, lhsNumLimbs };
+        for (size_t i = smallSize; i != bigSize; ++i) {
+            if (bigPtr[i] != 0) {
+                return bigPtr == lhs ? 1 : -1;
+            }
+        }
+    }
+    for (size_t i = std::min(lhsNumLimbs, rhsNumLimbs); i > 0;) {
+        --i;
+        if (lhs[i] == rhs[i]) {
+            continue;
+        }
+        if (lhs[i] < rhs[i]) {
+            return -1;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+int APIntView::ucmp(APIntView rhs) const {
+    assert(bitwidth() == rhs.bitwidth());
+    return ucmpImpl(_limbs, numLimbs(), rhs._limbs, rhs.numLimbs());
+}
+
+int APIntView::ucmp(uint64_t rhs) const {
+    if (numLimbs() == 1) {
+        rhs &= topLimbMask(_bitwidth);
+    }
+    return ucmpImpl(_limbs, numLimbs(), &rhs, 1);
+}
+
+int APIntView::scmp(APIntView rhs) const {
+    assert(bitwidth() == rhs.bitwidth());
+    int const l = highbit();
+    int const r = rhs.highbit();
+    if (l == r) {
+        return ucmp(rhs);
+    }
+    return r - l;
+}
+
+std::string APIntView::toString(int base) const {
+    assert(base >= 2);
+    assert(base <= 36);
+    return limbsToString(_limbs, numLimbs(), base);
+}
+
+std::string APIntView::signedToString(int base) const {
+    return toAPInt().signedToString(base);
+}
+
+/// wyhash style multiply-fold hash. Wide values are consumed four limbs per
+/// step in two independent lanes so the multiplications of one step can
+/// execute in parallel.
+uint64_t APMath::internal::hashLimbs(Limb const* limbs,
+                                     size_t numLimbs,
+                                     size_t bitwidth,
+                                     uint64_t seed) {
+    if (numLimbs == 1) {
+        return hashLimb(limbs[0], bitwidth, seed);
+    }
+    seed = hashSeed(bitwidth, seed);
+    size_t i = 0;
+    if (numLimbs >= 4) {
+        uint64_t lane = seed ^ HashSecret[2];
+        for (; i + 4 <= numLimbs; i += 4) {
+            seed = hashMix(limbs[i] ^ HashSecret[1], limbs[i + 1] ^ seed);
+            lane = hashMix(limbs[i + 2] ^ HashSecret[2], limbs[i + 3] ^ lane);
+        }
+        seed ^= lane;
+    }
+    for (; i + 2 <= numLimbs; i += 2) {
+        seed = hashMix(limbs[i] ^ HashSecret[1], limbs[i + 1] ^ seed);
+    }
+    if (i < numLimbs) {
+        seed = hashMix(limbs[i] ^ HashSecret[1], seed ^ HashSecret[3]);
+    }
+    return hashMix(numLimbs * LimbSize ^ HashSecret[1], seed);
+}
+
+APIntRef& APIntRef::assign(APIntView rhs) {
+    assert(bitwidth() == rhs.bitwidth());
+    std::memmove(limbPtr(), rhs.limbs().data(), numLimbs() * LimbSize);
+    return *this;
+}
+
+APIntRef& APIntRef::add(APIntView rhs) {
+    assert(bitwidth() == rhs.bitwidth());
+    addLimbs(limbPtr(), limbPtr(), rhs.limbs().data(), numLimbs());
+    clearUnusedBits();
+    return *this;
+}
+
+APIntRef& APIntRef::sub(APIntView rhs) {
+    assert(bitwidth() == rhs.bitwidth());
+    subLimbs(limbPtr(), limbPtr(), rhs.limbs().data(), numLimbs());
+    clearUnusedBits();
+    return *this;
+}
+
+APIntRef& APIntRef::mul(APIntView rhs) {
+    assert(bitwidth() == rhs.bitwidth());
+    size_t const n = numLimbs();
+    ScratchLimbs<4> product(n);
+    mulLimbsLow(product.data(), limbPtr(), n, rhs.limbs().data(), n, n);
+    std::memcpy(limbPtr(), product.data(), n * LimbSize);
+    clearUnusedBits();
+    return *this;
+}
+
+APIntRef& APIntRef::btwand(APIntView rhs) {
+    assert(bitwidth() == rhs.bitwidth());
+    Limb* const l = limbPtr();
+    Limb const* const r = rhs.limbs().data();
+    for (size_t i = 0; i < numLimbs(); ++i) {
+        l[i] &= r[i];
+    }
+    return *this;
+}
+
+APIntRef& APIntRef::btwor(APIntView rhs) {
+    assert(bitwidth() == rhs.bitwidth());
+    Limb* const l = limbPtr();
+    Limb const* const r = rhs.limbs().data();
+    for (size_t i = 0; i < numLimbs(); ++i) {
+        l[i] |= r[i];
+    }
+    return *this;
+}
+
+APIntRef& APIntRef::btwxor(APIntView rhs) {
+    assert(bitwidth() == rhs.bitwidth());
+    Limb* const l = limbPtr();
+    Limb const* const r = rhs.limbs().data();
+    for (size_t i = 0; i < numLimbs(); ++i) {
+        l[i] ^= r[i];
+    }
+    return *this;
+}
+
+APIntRef& APIntRef::lshl(int numBits) {
+    assert(numBits >= 0);
+    assert(numBits < (int)_bitwidth);
+    shlBitsInPlace(limbPtr(), numLimbs(), static_cast<size_t>(numBits));
+    clearUnusedBits();
+    return *this;
+}
+
+APIntRef& APIntRef::lshr(int numBits) {
+    assert(numBits >= 0);
+    assert(numBits < (int)_bitwidth);
+    shrBitsInPlace(limbPtr(), numLimbs(), static_cast<size_t>(numBits));
+    return *this;
+}
+
+APIntRef& APIntRef::ashr(int nb) {
+    assert(nb >= 0);
+    size_t const numBits = static_cast<size_t>(nb);
+    assert(numBits < _bitwidth);
+    int const h = highbit();
+    lshr(nb);
+    if (h == 0) {
+        return *this;
+    }
+    /// Fill the vacated bits `[bitwidth - numBits, bitwidth)` with ones
+    Limb* const l = limbPtr();
+    size_t const begin = bitwidth() - numBits;
+    for (size_t i = begin / LimbBitSize; i < numLimbs(); ++i) {
+        size_t const lo = std::max(begin, i * LimbBitSize) - i * LimbBitSize;
+        l[i] |= Limb(-1) << lo;
+    }
+    clearUnusedBits();
+    return *this;
+}
+
+/// \Returns \p numBits modulo \p bitwidth in the range `[0, bitwidth)`
+static size_t rotateAmount(int numBits, size_t bitwidth) {
+    auto const bw = static_cast<long long>(bitwidth);
+    return static_cast<size_t>((numBits % bw + bw) % bw);
+}
+
+APIntRef& APIntRef::rotl(int numBits) {
+    size_t const s = rotateAmount(numBits, bitwidth());
+    if (s != 0) {
+        fshlLimbs(limbPtr(), _limbs, _limbs, bitwidth(), s);
+    }
+    return *this;
+}
+
+APIntRef& APIntRef::rotr(int numBits) {
+    size_t const s = rotateAmount(numBits, bitwidth());
+    if (s != 0) {
+        fshlLimbs(limbPtr(), _limbs, _limbs, bitwidth(), bitwidth() - s);
+    }
+    return *this;
+}
+
+/// Reverses the order of the limbs of \p a and applies \p reverseLimb to each
+/// limb. The reversed value is then aligned to the low end of the limbs.
+template <typename F>
+static void reverseLimbs(Limb* a, size_t bitwidth, F reverseLimb) {
+    size_t const n = ceilDiv(bitwidth, LimbBitSize);
+    std::reverse(a, a + n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = reverseLimb(a[i]);
+    }
+    shrBitsInPlace(a, n, n * LimbBitSize - bitwidth);
+}
+
+APIntRef& APIntRef::bswap() {
+    assert(bitwidth() % 8 == 0);
+    reverseLimbs(limbPtr(), bitwidth(), byteSwap);
+    return *this;
+}
+
+APIntRef& APIntRef::bitreverse() {
+    reverseLimbs(limbPtr(), bitwidth(), bitReverse);
+    return *this;
+}
+
+APIntRef& APIntRef::negate() {
+    Limb borrow = 0;
+    Limb* const l = limbPtr();
+    for (size_t i = 0; i < numLimbs(); ++i) {
+        Limb const newBorrow = l[i] != 0 || borrow != 0;
+        l[i] = Limb(0) - l[i] - borrow;
+        borrow = newBorrow;
+    }
+    clearUnusedBits();
+    return *this;
+}
+
+APIntRef& APIntRef::set(size_t n, bool value) {
+    if (value) {
+        set(n);
+    }
+    else {
+        clear(n);
+    }
+    return *this;
+}
+
+APIntRef& APIntRef::set(size_t n) {
+    assert(n < bitwidth());
+    limbPtr()[n / LimbBitSize] |= Limb(1) << (n % LimbBitSize);
+    return *this;
+}
+
+APIntRef& APIntRef::clear(size_t n) {
+    assert(n < bitwidth());
+    limbPtr()[n / LimbBitSize] &= ~(Limb(1) << (n % LimbBitSize));
+    return *this;
+}
+
+APIntRef& APIntRef::flip(size_t n) {
+    assert(n < bitwidth());
+    limbPtr()[n / LimbBitSize] ^= Limb(1) << (n % LimbBitSize);
+    return *this;
+}
+
+APIntRef& APIntRef::flip() {
+    Limb* const l = limbPtr();
+    for (size_t i = 0; i < numLimbs(); ++i) {
+        l[i] = ~l[i];
+    }
+    clearUnusedBits();
+    return *this;
+}
+
+APIntRef& APIntRef::insertBits(APIntView value, size_t lo) {
+    size_t const width = value.bitwidth();
+    assert(lo + width <= bitwidth());
+    for (size_t i = 0, n = value.numLimbs(); i < n; ++i) {
+        size_t const pos = i * LimbBitSize;
+        storeBits(limbPtr(),
+                  lo + pos,
+                  std::min(LimbBitSize, width - pos),
+                  value.limb(i));
+    }
+    return *this;
+}
+
+/// Applies `limb = op(limb, mask)` to the limbs of \p l overlapping the bit
+/// range `[lo, hi)` where `mask` selects the bits of the range
+template <typename Op>
+static void applyBitRange(Limb* l, size_t lo, size_t hi, Op op) {
+    if (lo >= hi) {
+        return;
+    }
+    size_t const first = lo / LimbBitSize;
+    size_t const last = (hi - 1) / LimbBitSize;
+    Limb const firstMask = ~Limb(0) << (lo % LimbBitSize);
+    Limb const lastMask = lowBitMask(ceilRem(hi, LimbBitSize));
+    if (first == last) {
+        l[first] = op(l[first], firstMask & lastMask);
+        return;
+    }
+    l[first] = op(l[first], firstMask);
+    for (size_t i = first + 1; i < last; ++i) {
+        l[i] = op(l[i], ~Limb(0));
+    }
+    l[last] = op(l[last], lastMask);
+}
+
+APIntRef& APIntRef::setBits(size_t lo, size_t hi) {
+    assert(lo <= hi && hi <= bitwidth());
+    applyBitRange(limbPtr(), lo, hi, [](Limb l, Limb m) { return l | m; });
+    return *this;
+}
+
+APIntRef& APIntRef::clearBits(size_t lo, size_t hi) {
+    assert(lo <= hi && hi <= bitwidth());
+    applyBitRange(limbPtr(), lo, hi, [](Limb l, Limb m) { return l & ~m; });
+    return *this;
+}
+
+void APIntRef::clearUnusedBits() {
+    limbPtr()[numLimbs() - 1] &= topLimbMask(_bitwidth);
+}
@@ -0,0 +1,407 @@
+#include <APMath/APIntVector.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "LimbOps.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+/// The kernels below operate on rows, i.e. the limbs of equal significance of
+/// all elements. All loops over lanes are free of branches and cross-lane
+/// dependencies so they can be vectorized.
+
+APIntVector APMath::add(APIntVector lhs, APIntVector const& rhs) {
+    return lhs.add(rhs);
+}
+
+APIntVector APMath::sub(APIntVector lhs, APIntVector const& rhs) {
+    return lhs.sub(rhs);
+}
+
+APIntVector APMath::mul(APIntVector lhs, APIntVector const& rhs) {
+    return lhs.mul(rhs);
+}
+
+APIntVector APMath::btwand(APIntVector lhs, APIntVector const& rhs) {
+    return lhs.btwand(rhs);
+}
+
+APIntVector APMath::btwor(APIntVector lhs, APIntVector const& rhs) {
+    return lhs.btwor(rhs);
+}
+
+APIntVector APMath::btwxor(APIntVector lhs, APIntVector const& rhs) {
+    return lhs.btwxor(rhs);
+}
+
+APIntVector APMath::lshl(APIntVector operand, int numBits) {
+    return operand.lshl(numBits);
+}
+
+APIntVector APMath::lshr(APIntVector operand, int numBits) {
+    return operand.lshr(numBits);
+}
+
+APIntVector APMath::ashr(APIntVector operand, int numBits) {
+    return operand.ashr(numBits);
+}
+
+APIntVector APMath::negate(APIntVector operand) { return operand.negate(); }
+
+APIntVector APMath::btwnot(APIntVector operand) { return operand.btwnot(); }
+
+APIntVector APMath::cmp(CmpPredicate predicate,
+                        APIntVector const& lhs,
+                        APIntVector const& rhs) {
+    assert(lhs.size() == rhs.size());
+    assert(lhs.bitwidth() == rhs.bitwidth());
+    size_t const size = lhs.size();
+    size_t const n = lhs.numLimbs();
+    bool const isSigned = predicate >= CmpPredicate::SLT;
+    /// Flipping the sign bits maps signed order to unsigned order
+    Limb const signBit =
+        isSigned ? Limb(1) << ((lhs.bitwidth() - 1) % LimbBitSize) : 0;
+    std::vector<Limb> less(size), greater(size);
+    for (size_t j = n; j-- > 0;) {
+        Limb const flip = j == n - 1 ? signBit : 0;
+        Limb const* a = lhs.row(j);
+        Limb const* b = rhs.row(j);
+        for (size_t i = 0; i < size; ++i) {
+            Limb const x = a[i] ^ flip;
+            Limb const y = b[i] ^ flip;
+            Limb const undecided = ~(less[i] | greater[i]) & 1;
+            less[i] |= undecided & Limb(x < y);
+            greater[i] |= undecided & Limb(x > y);
+        }
+    }
+    APIntVector result(size, 1);
+    Limb* r = result.row(0);
+    for (size_t i = 0; i < size; ++i) {
+        switch (predicate) {
+        case CmpPredicate::EQ:
+            r[i] = ~(less[i] | greater[i]) & 1;
+            break;
+        case CmpPredicate::NE:
+            r[i] = less[i] | greater[i];
+            break;
+        case CmpPredicate::ULT:
+        case CmpPredicate::SLT:
+            r[i] = less[i];
+            break;
+        case CmpPredicate::ULE:
+        case CmpPredicate::SLE:
+            r[i] = greater[i] ^ 1;
+            break;
+        case CmpPredicate::UGT:
+        case CmpPredicate::SGT:
+            r[i] = greater[i];
+            break;
+        case CmpPredicate::UGE:
+        case CmpPredicate::SGE:
+            r[i] = less[i] ^ 1;
+            break;
+        }
+    }
+    return result;
+}
+
+APIntVector APMath::select(APIntVector const& mask,
+                           APIntVector const& ifTrue,
+                           APIntVector ifFalse) {
+    assert(mask.bitwidth() == 1);
+    assert(mask.size() == ifTrue.size() && mask.size() == ifFalse.size());
+    assert(ifTrue.bitwidth() == ifFalse.bitwidth());
+    size_t const size = mask.size();
+    Limb const* m = mask.row(0);
+    for (size_t j = 0; j < ifFalse.numLimbs(); ++j) {
+        Limb const* t = ifTrue.row(j);
+        Limb* f = ifFalse.row(j);
+        for (size_t i = 0; i < size; ++i) {
+            Limb const take = Limb(0) - m[i];
+            f[i] = (t[i] & take) | (f[i] & ~take);
+        }
+    }
+    return ifFalse;
+}
+
+APIntVector::APIntVector(size_t size, size_t bitwidth):
+    _size(size),
+    _bitwidth(bitwidth),
+    _numLimbs(ceilDiv(bitwidth, LimbBitSize)),
+    _limbs(_numLimbs * size) {
+    assert(bitwidth > 0);
+}
+
+APIntVector::APIntVector(std::span<APInt const> elements):
+    APIntVector(elements.size(),
+                elements.empty() ? 1 : elements.front().bitwidth()) {
+    for (size_t i = 0; i < _size; ++i) {
+        setElement(i, elements[i]);
+    }
+}
+
+std::vector<APInt> APIntVector::toAPInts() const {
+    std::vector<APInt> result;
+    result.reserve(_size);
+    for (size_t i = 0; i < _size; ++i) {
+        result.push_back(element(i));
+    }
+    return result;
+}
+
+APInt APIntVector::element(size_t index) const {
+    assert(index < _size);
+    APInt result(_bitwidth);
+    Limb* r = APIntAccess::limbPtr(result);
+    for (size_t j = 0; j < _numLimbs; ++j) {
+        r[j] = row(j)[index];
+    }
+    return result;
+}
+
+void APIntVector::setElement(size_t index, APInt const& value) {
+    assert(index < _size);
+    assert(value.bitwidth() == _bitwidth);
+    auto limbs = value.limbs();
+    for (size_t j = 0; j < _numLimbs; ++j) {
+        row(j)[index] = limbs[j];
+    }
+}
+
+APIntVector& APIntVector::add(APIntVector const& rhs) {
+    assert(_size == rhs._size && _bitwidth == rhs._bitwidth);
+    if (_numLimbs == 1) {
+        Limb* a = row(0);
+        Limb const* b = rhs.row(0);
+        Limb const mask = topLimbMask();
+        for (size_t i = 0; i < _size; ++i) {
+            a[i] = (a[i] + b[i]) & mask;
+        }
+        return *this;
+    }
+    std::vector<Limb> carry(_size);
+    for (size_t j = 0; j < _numLimbs; ++j) {
+        Limb* a = row(j);
+        Limb const* b = rhs.row(j);
+        for (size_t i = 0; i < _size; ++i) {
+            Limb const sum = a[i] + b[i];
+            Limb const res = sum + carry[i];
+            carry[i] = Limb(sum < a[i]) | Limb(res < sum);
+            a[i] = res;
+        }
+    }
+    clearUnusedBits();
+    return *this;
+}
+
+APIntVector& APIntVector::sub(APIntVector const& rhs) {
+    assert(_size == rhs._size && _bitwidth == rhs._bitwidth);
+    if (_numLimbs == 1) {
+        Limb* a = row(0);
+        Limb const* b = rhs.row(0);
+        Limb const mask = topLimbMask();
+        for (size_t i = 0; i < _size; ++i) {
+            a[i] = (a[i] - b[i]) & mask;
+        }
+        return *this;
+    }
+    std::vector<Limb> borrow(_size);
+    for (size_t j = 0; j < _numLimbs; ++j) {
+        Limb* a = row(j);
+        Limb const* b = rhs.row(j);
+        for (size_t i = 0; i < _size; ++i) {
+            Limb const diff = a[i] - b[i];
+            Limb const res = diff - borrow[i];
+            borrow[i] = Limb(a[i] < b[i]) | Limb(diff < borrow[i]);
+            a[i] = res;
+        }
+    }
+    clearUnusedBits();
+    return *this;
+}
+
+APIntVector& APIntVector::mul(APIntVector const& rhs) {
+    assert(_size == rhs._size && _bitwidth == rhs._bitwidth);
+    if (_numLimbs == 1) {
+        Limb* a = row(0);
+        Limb const* b = rhs.row(0);
+        Limb const mask = topLimbMask();
+        for (size_t i = 0; i < _size; ++i) {
+            a[i] = (a[i] * b[i]) & mask;
+        }
+        return *this;
+    }
+    /// Truncated schoolbook product computed for all lanes at once. Row `j`
+    /// of `rhs` is multiplied with the low `n - j` rows of `*this` and added at
+    /// row offset `j`.
+    std::vector<Limb> result(_limbs.size());
+    std::vector<Limb> carry(_size);
+    for (size_t j = 0; j < _numLimbs; ++j) {
+        Limb const* b = rhs.row(j);
+        std::fill(carry.begin(), carry.end(), 0);
+        for (size_t k = j; k < _numLimbs; ++k) {
+            Limb const* a = row(k - j);
+            Limb* r = result.data() + k * _size;
+            for (size_t i = 0; i < _size; ++i) {
+                Limb lo = a[i] * b[i];
+                Limb hi = mulHi(a[i], b[i]);
+                lo += carry[i];
+                hi += lo < carry[i];
+                r[i] += lo;
+                hi += r[i] < lo;
+                carry[i] = hi;
+            }
+        }
+    }
+    _limbs = std::move(result);
+    clearUnusedBits();
+    return *this;
+}
+
+APIntVector& APIntVector::btwand(APIntVector const& rhs) {
+    assert(_size == rhs._size && _bitwidth == rhs._bitwidth);
+    for (size_t i = 0; i < _limbs.size(); ++i) {
+        _limbs[i] &= rhs._limbs[i];
+    }
+    return *this;
+}
+
+APIntVector& APIntVector::btwor(APIntVector const& rhs) {
+    assert(_size == rhs._size && _bitwidth == rhs._bitwidth);
+    for (size_t i = 0; i < _limbs.size(); ++i) {
+        _limbs[i] |= rhs._limbs[i];
+    }
+    return *this;
+}
+
+APIntVector& APIntVector::btwxor(APIntVector const& rhs) {
+    assert(_size == rhs._size && _bitwidth == rhs._bitwidth);
+    for (size_t i = 0; i < _limbs.size(); ++i) {
+        _limbs[i] ^= rhs._limbs[i];
+    }
+    return *this;
+}
+
+APIntVector& APIntVector::lshl(int numBits) {
+    assert(numBits >= 0);
+    assert(numBits < (int)_bitwidth);
+    size_t const offset = (size_t)numBits / LimbBitSize;
+    unsigned const s = (unsigned)numBits % LimbBitSize;
+    /// Rows are written from the top so every source row is still unmodified
+    for (size_t j = _numLimbs; j-- > offset;) {
+        Limb* r = row(j);
+        Limb const* a = row(j - offset);
+        if (s == 0) {
+            std::memcpy(r, a, _size * LimbSize);
+            continue;
+        }
+        if (j == offset) {
+            for (size_t i = 0; i < _size; ++i) {
+                r[i] = a[i] << s;
+            }
+            continue;
+        }
+        Limb const* b = row(j - offset - 1);
+        for (size_t i = 0; i < _size; ++i) {
+            r[i] = (a[i] << s) | (b[i] >> (LimbBitSize - s));
+        }
+    }
+    std::memset(_limbs.data(), 0, offset * _size * LimbSize);
+    clearUnusedBits();
+    return *this;
+}
+
+APIntVector& APIntVector::lshr(int numBits) {
+    assert(numBits >= 0);
+    assert(numBits < (int)_bitwidth);
+    size_t const offset = (size_t)numBits / LimbBitSize;
+    unsigned const s = (unsigned)numBits % LimbBitSize;
+    /// Rows are written from the bottom so every source row is still unmodified
+    for (size_t j = 0; j + offset < _numLimbs; ++j) {
+        Limb* r = row(j);
+        Limb const* a = row(j + offset);
+        if (s == 0) {
+            std::memcpy(r, a, _size * LimbSize);
+            continue;
+        }
+        if (j + offset + 1 == _numLimbs) {
+            for (size_t i = 0; i < _size; ++i) {
+                r[i] = a[i] >> s;
+            }
+            continue;
+        }
+        Limb const* b = row(j + offset + 1);
+        for (size_t i = 0; i < _size; ++i) {
+            r[i] = (a[i] >> s) | (b[i] << (LimbBitSize - s));
+        }
+    }
+    std::memset(row(_numLimbs - offset), 0, offset * _size * LimbSize);
+    return *this;
+}
+
+APIntVector& APIntVector::ashr(int numBits) {
+    assert(numBits >= 0);
+    assert(numBits < (int)_bitwidth);
+    unsigned const signPos = (_bitwidth - 1) % LimbBitSize;
+    std::vector<Limb> sign(_size);
+    Limb const* top = row(_numLimbs - 1);
+    for (size_t i = 0; i < _size; ++i) {
+        sign[i] = Limb(0) - ((top[i] >> signPos) & 1);
+    }
+    lshr(numBits);
+    /// Fill the vacated bits `[bitwidth - numBits, bitwidth)` of negative
+    /// elements with ones
+    size_t const begin = _bitwidth - (size_t)numBits;
+    for (size_t j = begin / LimbBitSize; j < _numLimbs; ++j) {
+        size_t const lo = std::max(begin, j * LimbBitSize) - j * LimbBitSize;
+        Limb fill = ~Limb(0) << lo;
+        if (j == _numLimbs - 1) {
+            fill &= topLimbMask();
+        }
+        Limb* r = row(j);
+        for (size_t i = 0; i < _size; ++i) {
+            r[i] |= sign[i] & fill;
+        }
+    }
+    return *this;
+}
+
+APIntVector& APIntVector::negate() {
+    std::vector<Limb> borrow(_size);
+    for (size_t j = 0; j < _numLimbs; ++j) {
+        Limb* a = row(j);
+        for (size_t i = 0; i < _size; ++i) {
+            Limb const res = Limb(0) - a[i] - borrow[i];
+            borrow[i] |= Limb(a[i] != 0);
+            a[i] = res;
+        }
+    }
+    clearUnusedBits();
+    return *this;
+}
+
+APIntVector& APIntVector::btwnot() {
+    for (auto& limb: _limbs) {
+        limb = ~limb;
+    }
+    clearUnusedBits();
+    return *this;
+}
+
+APIntVector::Limb APIntVector::topLimbMask() const {
+    size_t const topBits = _bitwidth % LimbBitSize;
+    return topBits == 0 ? ~Limb(0) : (Limb(1) << topBits) - 1;
+}
+
+void APIntVector::clearUnusedBits() {
+    Limb const mask = topLimbMask();
+    Limb* top = row(_numLimbs - 1);
+    for (size_t i = 0; i < _size; ++i) {
+        top[i] &= mask;
+    }
+}
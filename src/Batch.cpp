@@ -0,0 +1,125 @@
+#include <APMath/Batch.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#include <APMath/APIntRef.h>
+#include <APMath/Parallel.h>
+
+#include "ThreadPool.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+static int shiftAmount(APInt const& lhs, APInt const& rhs) {
+    assert(APIntView(rhs).ucmp(lhs.bitwidth()) < 0);
+    return static_cast<int>(rhs.to<std::uint64_t>());
+}
+
+APInt APMath::evaluate(APIntOperation const& operation) {
+    APInt const& lhs = *operation.lhs;
+    APInt const& rhs = *operation.rhs;
+    switch (operation.op) {
+    case APIntOp::Add:
+        return add(lhs, rhs);
+    case APIntOp::Sub:
+        return sub(lhs, rhs);
+    case APIntOp::Mul:
+        return mul(lhs, rhs);
+    case APIntOp::UDiv:
+        return udiv(lhs, rhs);
+    case APIntOp::URem:
+        return urem(lhs, rhs);
+    case APIntOp::SDiv:
+        return sdiv(lhs, rhs);
+    case APIntOp::SRem:
+        return srem(lhs, rhs);
+    case APIntOp::BtwAnd:
+        return btwand(lhs, rhs);
+    case APIntOp::BtwOr:
+        return btwor(lhs, rhs);
+    case APIntOp::BtwXor:
+        return btwxor(lhs, rhs);
+    case APIntOp::LShl:
+        return lshl(lhs, shiftAmount(lhs, rhs));
+    case APIntOp::LShr:
+        return lshr(lhs, shiftAmount(lhs, rhs));
+    case APIntOp::AShr:
+        return ashr(lhs, shiftAmount(lhs, rhs));
+    case APIntOp::CmpEQ:
+        return APInt(ucmp(lhs, rhs) == 0, 1);
+    case APIntOp::CmpNE:
+        return APInt(ucmp(lhs, rhs) != 0, 1);
+    case APIntOp::CmpULT:
+        return APInt(ucmp(lhs, rhs) < 0, 1);
+    case APIntOp::CmpULE:
+        return APInt(ucmp(lhs, rhs) <= 0, 1);
+    case APIntOp::CmpUGT:
+        return APInt(ucmp(lhs, rhs) > 0, 1);
+    case APIntOp::CmpUGE:
+        return APInt(ucmp(lhs, rhs) >= 0, 1);
+    case APIntOp::CmpSLT:
+        return APInt(scmp(lhs, rhs) < 0, 1);
+    case APIntOp::CmpSLE:
+        return APInt(scmp(lhs, rhs) <= 0, 1);
+    case APIntOp::CmpSGT:
+        return APInt(scmp(lhs, rhs) > 0, 1);
+    case APIntOp::CmpSGE:
+        return APInt(scmp(lhs, rhs) >= 0, 1);
+    }
+    assert(false);
+    std::abort();
+}
+
+APFloat APMath::evaluate(APFloatOperation const& operation) {
+    APFloat const& lhs = *operation.lhs;
+    APFloat const& rhs = *operation.rhs;
+    switch (operation.op) {
+    case APFloatOp::Add:
+        return add(lhs, rhs);
+    case APFloatOp::Sub:
+        return sub(lhs, rhs);
+    case APFloatOp::Mul:
+        return mul(lhs, rhs);
+    case APFloatOp::Div:
+        return div(lhs, rhs);
+    case APFloatOp::Pow:
+        return pow(lhs, rhs);
+    case APFloatOp::Hypot:
+        return hypot(lhs, rhs);
+    }
+    assert(false);
+    std::abort();
+}
+
+/// Evaluates \p operations in chunks on the thread pool. Without a pool the
+/// chunks run one after another on the calling thread.
+template <typename Operation, typename Result>
+static void evaluateChunked(std::span<Operation const> operations,
+                            std::span<Result> results) {
+    assert(operations.size() == results.size());
+    size_t const chunkSize = std::max<size_t>(1, parallelOptions().batchSize);
+    TaskGroup group;
+    for (size_t begin = 0; begin < operations.size(); begin += chunkSize) {
+        size_t const end = std::min(begin + chunkSize, operations.size());
+        group.run([=] {
+            for (size_t i = begin; i < end; ++i) {
+                results[i] = evaluate(operations[i]);
+            }
+        });
+    }
+    group.wait();
+}
+
+void APMath::evaluate(std::span<APIntOperation const> operations,
+                      std::span<APInt> results) {
+    evaluateChunked(operations, results);
+}
+
+void APMath::evaluate(std::span<APFloatOperation const> operations,
+                      std::span<APFloat> results) {
+    evaluateChunked(operations, results);
+}
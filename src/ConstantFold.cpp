@@ -0,0 +1,622 @@
+#include <APMath/ConstantFold.h>
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+#include <APMath/Conversion.h>
+#include <APMath/Parallel.h>
+
+#include "ThreadPool.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+static bool isIntBinary(FoldOp op) {
+    return op >= FoldOp::Add && op <= FoldOp::Xor;
+}
+
+static bool isICmp(FoldOp op) {
+    return op >= FoldOp::ICmpEQ && op <= FoldOp::ICmpSGE;
+}
+
+static bool isFloatBinary(FoldOp op) {
+    return op >= FoldOp::FAdd && op <= FoldOp::FDiv;
+}
+
+static bool isFCmp(FoldOp op) {
+    return op >= FoldOp::FCmpOEQ && op <= FoldOp::FCmpOGE;
+}
+
+static bool isCommutative(FoldOp op) {
+    switch (op) {
+    case FoldOp::Add:
+    case FoldOp::Mul:
+    case FoldOp::And:
+    case FoldOp::Or:
+    case FoldOp::Xor:
+    case FoldOp::ICmpEQ:
+    case FoldOp::ICmpNE:
+    case FoldOp::FAdd:
+    case FoldOp::FMul:
+    case FoldOp::FCmpOEQ:
+    case FoldOp::FCmpONE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+[[maybe_unused]] static bool isConversionWidth(size_t bitwidth) {
+    return bitwidth == 8 || bitwidth == 16 || bitwidth == 32 || bitwidth == 64;
+}
+
+[[maybe_unused]] static bool isFloatPrecision(size_t bitwidth) {
+    return bitwidth == 32 || bitwidth == 64;
+}
+
+bool FoldDAG::sameConstant(uint32_t index, Node const& node) const {
+    Node const& other = nodes[index];
+    if (other.op != FoldOp::Constant || other.type != node.type) {
+        return false;
+    }
+    if (node.type.isFloat()) {
+        /// Compare representations so that `-0.0` and `0.0` are distinct and
+        /// NaNs are found
+        return floatConstants[other.operands[0]].limbs()[0] ==
+               floatConstants[node.operands[0]].limbs()[0];
+    }
+    return intConstants[other.operands[0]] == intConstants[node.operands[0]];
+}
+
+static uint64_t hashNode(FoldOp op, FoldFlags flags, FoldType type,
+                         std::array<uint32_t, 3> const& operands) {
+    uint64_t const flagBits = uint64_t(flags.nuw) | uint64_t(flags.nsw) << 1 |
+                              uint64_t(flags.exact) << 2;
+    uint64_t hash = hashMix(uint64_t(op) | flagBits << 8, type.bitwidth);
+    hash = hashMix(hash ^ type.precision.mantissaWidth,
+                   uint64_t(operands[0]) << 32 | operands[1]);
+    return hashMix(hash, operands[2] ^ DefaultHashSeed);
+}
+
+FoldNode FoldDAG::insert(Node node) {
+    uint64_t hash;
+    if (node.op == FoldOp::Constant) {
+        uint64_t const valueHash =
+            node.type.isFloat() ?
+                floatConstants[node.operands[0]].limbs()[0] :
+                intConstants[node.operands[0]].hash();
+        hash = hashMix(valueHash, node.type.bitwidth);
+    }
+    else {
+        hash = hashNode(node.op, node.flags, node.type, node.operands);
+    }
+    auto [begin, end] = uniqueNodes.equal_range(hash);
+    for (auto itr = begin; itr != end; ++itr) {
+        uint32_t const index = itr->second;
+        bool const equal = node.op == FoldOp::Constant ?
+                               sameConstant(index, node) :
+                               nodes[index] == node;
+        if (equal) {
+            /// Drop the constant we added speculatively
+            if (node.op == FoldOp::Constant) {
+                if (node.type.isFloat()) {
+                    floatConstants.pop_back();
+                }
+                else {
+                    intConstants.pop_back();
+                }
+            }
+            return { index };
+        }
+    }
+    auto const index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(node);
+    uniqueNodes.insert({ hash, index });
+    return { index };
+}
+
+FoldNode FoldDAG::constant(APInt const& value) {
+    auto const index = static_cast<uint32_t>(intConstants.size());
+    intConstants.push_back(value);
+    return insert({ FoldOp::Constant,
+                    {},
+                    FoldType::Int(value.bitwidth()),
+                    { index, 0, 0 } });
+}
+
+FoldNode FoldDAG::constant(APFloat const& value) {
+    auto const index = static_cast<uint32_t>(floatConstants.size());
+    floatConstants.push_back(value);
+    return insert({ FoldOp::Constant,
+                    {},
+                    FoldType::Float(value.precision()),
+                    { index, 0, 0 } });
+}
+
+FoldNode FoldDAG::binary(FoldOp op, FoldNode lhs, FoldNode rhs,
+                         FoldFlags flags) {
+    FoldType const type = nodeAt(lhs).type;
+    assert(type == nodeAt(rhs).type && "Operand types must match");
+    assert((!flags.nuw && !flags.nsw) ||
+           op == FoldOp::Add || op == FoldOp::Sub || op == FoldOp::Mul ||
+           op == FoldOp::Shl);
+    assert(!flags.exact || op == FoldOp::UDiv || op == FoldOp::SDiv ||
+           op == FoldOp::LShr || op == FoldOp::AShr);
+    if (isCommutative(op) && rhs.index < lhs.index) {
+        std::swap(lhs, rhs);
+    }
+    if (isIntBinary(op)) {
+        assert(!type.isFloat());
+        return insert({ op, flags, type, { lhs.index, rhs.index, 0 } });
+    }
+    if (isICmp(op)) {
+        assert(!type.isFloat());
+        return insert(
+            { op, flags, FoldType::Int(1), { lhs.index, rhs.index, 0 } });
+    }
+    if (isFloatBinary(op)) {
+        assert(type.isFloat());
+        return insert({ op, flags, type, { lhs.index, rhs.index, 0 } });
+    }
+    assert(isFCmp(op) && "Not a binary operation");
+    assert(type.isFloat());
+    return insert(
+        { op, flags, FoldType::Int(1), { lhs.index, rhs.index, 0 } });
+}
+
+FoldNode FoldDAG::fneg(FoldNode operand) {
+    FoldType const type = nodeAt(operand).type;
+    assert(type.isFloat());
+    return insert({ FoldOp::FNeg, {}, type, { operand.index, 0, 0 } });
+}
+
+FoldNode FoldDAG::cast(FoldOp op, FoldNode operand, FoldType type,
+                       FoldFlags flags) {
+    FoldType const from = nodeAt(operand).type;
+    assert(!flags.exact &&
+           ((!flags.nuw && !flags.nsw) || op == FoldOp::Trunc));
+    switch (op) {
+    case FoldOp::Trunc:
+        assert(!from.isFloat() && !type.isFloat());
+        assert(type.bitwidth <= from.bitwidth);
+        break;
+    case FoldOp::ZExt:
+    case FoldOp::SExt:
+        assert(!from.isFloat() && !type.isFloat());
+        assert(type.bitwidth >= from.bitwidth);
+        break;
+    case FoldOp::FPToUI:
+    case FoldOp::FPToSI:
+        assert(from.isFloat() && !type.isFloat());
+        assert(isConversionWidth(type.bitwidth));
+        break;
+    case FoldOp::UIToFP:
+    case FoldOp::SIToFP:
+        assert(!from.isFloat() && type.isFloat());
+        assert(from.bitwidth <= 64);
+        break;
+    case FoldOp::FPCast:
+        assert(from.isFloat() && type.isFloat());
+        break;
+    case FoldOp::BitCast:
+        assert(from.isFloat() != type.isFloat());
+        assert(from.bitwidth == type.bitwidth);
+        assert(isFloatPrecision(type.bitwidth));
+        break;
+    default:
+        assert(false && "Not a cast operation");
+        break;
+    }
+    return insert({ op, flags, type, { operand.index, 0, 0 } });
+}
+
+FoldNode FoldDAG::select(FoldNode cond, FoldNode lhs, FoldNode rhs) {
+    assert(nodeAt(cond).type == FoldType::Int(1));
+    FoldType const type = nodeAt(lhs).type;
+    assert(type == nodeAt(rhs).type && "Operand types must match");
+    return insert(
+        { FoldOp::Select, {}, type, { cond.index, lhs.index, rhs.index } });
+}
+
+/// Evaluates DAGs node by node into the values of a `FoldResults` object. The
+/// values are computed in place, so evaluating into results that already
+/// hold values of the same widths does not allocate. The wide scratch
+/// integers for overflow checks are reused across all nodes and DAGs
+/// evaluated by one evaluator.
+struct APMath::internal::FoldEvaluator {
+    using Node = FoldDAG::Node;
+
+    void run(FoldDAG const& dag, FoldResults& results) {
+        this->dag = &dag;
+        values = &results.values;
+        values->resize(dag.nodes.size());
+        for (size_t i = 0; i < dag.nodes.size(); ++i) {
+            FoldValue& result = (*values)[i];
+            result.poison = false;
+            evaluate(dag.nodes[i], result);
+        }
+    }
+
+    FoldValue const& operand(Node const& node, size_t i) const {
+        return (*values)[node.operands[i]];
+    }
+
+    void evaluate(Node const& node, FoldValue& result);
+    void evaluateInt(Node const& node, APInt const& lhs, APInt const& rhs,
+                     FoldValue& result);
+    void evaluateCast(Node const& node, FoldValue const& operand,
+                      FoldValue& result);
+
+    /// \Returns `true` if the product of \p lhs and \p rhs does not fit into
+    /// their bitwidth as unsigned or signed (\p isSigned) integers
+    bool mulOverflows(APInt const& lhs, APInt const& rhs, bool isSigned);
+
+    FoldDAG const* dag = nullptr;
+    std::vector<FoldValue>* values = nullptr;
+    APInt wideLhs, wideRhs;
+};
+
+void FoldEvaluator::evaluate(Node const& node, FoldValue& result) {
+    switch (node.op) {
+    case FoldOp::Constant:
+        if (node.type.isFloat()) {
+            result.floatValue = dag->floatConstants[node.operands[0]];
+        }
+        else {
+            result.intValue = dag->intConstants[node.operands[0]];
+        }
+        return;
+    case FoldOp::Select: {
+        FoldValue const& cond = operand(node, 0);
+        if (cond.poison) {
+            result.poison = true;
+            return;
+        }
+        FoldValue const& chosen = operand(node, cond.intValue.test(0) ? 1 : 2);
+        result.poison = chosen.poison;
+        if (node.type.isFloat()) {
+            result.floatValue = chosen.floatValue;
+        }
+        else {
+            result.intValue = chosen.intValue;
+        }
+        return;
+    }
+    case FoldOp::FNeg:
+        if (operand(node, 0).poison) {
+            result.poison = true;
+            return;
+        }
+        result.floatValue = operand(node, 0).floatValue;
+        result.floatValue.negate();
+        return;
+    default:
+        break;
+    }
+    if ((node.op >= FoldOp::Trunc && node.op <= FoldOp::SExt) ||
+        (node.op >= FoldOp::FPToUI && node.op <= FoldOp::BitCast))
+    {
+        if (operand(node, 0).poison) {
+            result.poison = true;
+            return;
+        }
+        evaluateCast(node, operand(node, 0), result);
+        return;
+    }
+    FoldValue const& lhs = operand(node, 0);
+    FoldValue const& rhs = operand(node, 1);
+    if (lhs.poison || rhs.poison) {
+        result.poison = true;
+        return;
+    }
+    if (isIntBinary(node.op) || isICmp(node.op)) {
+        evaluateInt(node, lhs.intValue, rhs.intValue, result);
+        return;
+    }
+    APFloat const& a = lhs.floatValue;
+    APFloat const& b = rhs.floatValue;
+    bool const ordered = !a.isNaN() && !b.isNaN();
+    auto setBool = [&](bool value) { result.intValue = APInt(value, 1); };
+    switch (node.op) {
+    case FoldOp::FAdd:
+        result.floatValue = a;
+        result.floatValue.add(b);
+        return;
+    case FoldOp::FSub:
+        result.floatValue = a;
+        result.floatValue.sub(b);
+        return;
+    case FoldOp::FMul:
+        result.floatValue = a;
+        result.floatValue.mul(b);
+        return;
+    case FoldOp::FDiv:
+        result.floatValue = a;
+        result.floatValue.div(b);
+        return;
+    case FoldOp::FCmpOEQ:
+        return setBool(ordered && a.cmp(b) == 0);
+    case FoldOp::FCmpONE:
+        return setBool(ordered && a.cmp(b) != 0);
+    case FoldOp::FCmpOLT:
+        return setBool(ordered && a.cmp(b) < 0);
+    case FoldOp::FCmpOLE:
+        return setBool(ordered && a.cmp(b) <= 0);
+    case FoldOp::FCmpOGT:
+        return setBool(ordered && a.cmp(b) > 0);
+    case FoldOp::FCmpOGE:
+        return setBool(ordered && a.cmp(b) >= 0);
+    default:
+        assert(false);
+        return;
+    }
+}
+
+bool FoldEvaluator::mulOverflows(APInt const& lhs, APInt const& rhs,
+                                 bool isSigned) {
+    size_t const bitwidth = lhs.bitwidth();
+    wideLhs = lhs;
+    wideRhs = rhs;
+    if (isSigned) {
+        wideLhs.sext(2 * bitwidth);
+        wideRhs.sext(2 * bitwidth);
+    }
+    else {
+        wideLhs.zext(2 * bitwidth);
+        wideRhs.zext(2 * bitwidth);
+    }
+    wideLhs.mul(wideRhs);
+    if (!isSigned) {
+        return wideLhs.clz() < bitwidth;
+    }
+    /// The product fits if the high half and the sign bit of the low half
+    /// are all equal
+    wideLhs.ashr(static_cast<int>(bitwidth - 1));
+    return !wideLhs.none() && !wideLhs.all();
+}
+
+/// \Returns the shift amount \p amount or `std::nullopt` if it is not less
+/// than \p bitwidth
+static std::optional<int> shiftAmount(APInt const& amount, size_t bitwidth) {
+    if (ucmp(amount, bitwidth) >= 0) {
+        return std::nullopt;
+    }
+    return static_cast<int>(amount.to<uint64_t>());
+}
+
+void FoldEvaluator::evaluateInt(Node const& node, APInt const& lhs,
+                                APInt const& rhs, FoldValue& result) {
+    FoldFlags const flags = node.flags;
+    size_t const bitwidth = lhs.bitwidth();
+    APInt& value = result.intValue;
+    auto setBool = [&](bool b) { value = APInt(b, 1); };
+    /// Division by zero and signed division of the minimum value by `-1`
+    bool const divUndefined =
+        rhs.none() ||
+        ((node.op == FoldOp::SDiv || node.op == FoldOp::SRem) && rhs.all() &&
+         lhs == APInt::SMin(bitwidth));
+    switch (node.op) {
+    case FoldOp::Add:
+        value = lhs;
+        value.add(rhs);
+        result.poison = (flags.nuw && value.ucmp(lhs) < 0) ||
+                        (flags.nsw && lhs.negative() == rhs.negative() &&
+                         value.negative() != lhs.negative());
+        return;
+    case FoldOp::Sub:
+        value = lhs;
+        value.sub(rhs);
+        result.poison = (flags.nuw && lhs.ucmp(rhs) < 0) ||
+                        (flags.nsw && lhs.negative() != rhs.negative() &&
+                         value.negative() != lhs.negative());
+        return;
+    case FoldOp::Mul:
+        value = lhs;
+        value.mul(rhs);
+        result.poison = (flags.nuw && mulOverflows(lhs, rhs, false)) ||
+                        (flags.nsw && mulOverflows(lhs, rhs, true));
+        return;
+    case FoldOp::UDiv:
+    case FoldOp::SDiv:
+    case FoldOp::URem:
+    case FoldOp::SRem:
+        if (divUndefined) {
+            result.poison = true;
+            return;
+        }
+        value = lhs;
+        switch (node.op) {
+        case FoldOp::UDiv:
+            if (flags.exact && !urem(lhs, rhs).none()) {
+                result.poison = true;
+                return;
+            }
+            value.udiv(rhs);
+            return;
+        case FoldOp::SDiv:
+            if (flags.exact && !srem(lhs, rhs).none()) {
+                result.poison = true;
+                return;
+            }
+            value.sdiv(rhs);
+            return;
+        case FoldOp::URem:
+            value.urem(rhs);
+            return;
+        default:
+            value.srem(rhs);
+            return;
+        }
+    case FoldOp::Shl:
+    case FoldOp::LShr:
+    case FoldOp::AShr: {
+        auto const amount = shiftAmount(rhs, bitwidth);
+        if (!amount) {
+            result.poison = true;
+            return;
+        }
+        value = lhs;
+        if (node.op == FoldOp::Shl) {
+            value.lshl(*amount);
+            result.poison = (flags.nuw && lshr(value, *amount) != lhs) ||
+                            (flags.nsw && ashr(value, *amount) != lhs);
+            return;
+        }
+        /// Shifted out bits are nonzero if the lowest set bit is below the
+        /// shift amount
+        result.poison =
+            flags.exact && !lhs.none() && lhs.ctz() < size_t(*amount);
+        if (node.op == FoldOp::LShr) {
+            value.lshr(*amount);
+        }
+        else {
+            value.ashr(*amount);
+        }
+        return;
+    }
+    case FoldOp::And:
+        value = lhs;
+        value.btwand(rhs);
+        return;
+    case FoldOp::Or:
+        value = lhs;
+        value.btwor(rhs);
+        return;
+    case FoldOp::Xor:
+        value = lhs;
+        value.btwxor(rhs);
+        return;
+    case FoldOp::ICmpEQ:
+        return setBool(lhs.ucmp(rhs) == 0);
+    case FoldOp::ICmpNE:
+        return setBool(lhs.ucmp(rhs) != 0);
+    case FoldOp::ICmpULT:
+        return setBool(lhs.ucmp(rhs) < 0);
+    case FoldOp::ICmpULE:
+        return setBool(lhs.ucmp(rhs) <= 0);
+    case FoldOp::ICmpUGT:
+        return setBool(lhs.ucmp(rhs) > 0);
+    case FoldOp::ICmpUGE:
+        return setBool(lhs.ucmp(rhs) >= 0);
+    case FoldOp::ICmpSLT:
+        return setBool(lhs.scmp(rhs) < 0);
+    case FoldOp::ICmpSLE:
+        return setBool(lhs.scmp(rhs) <= 0);
+    case FoldOp::ICmpSGT:
+        return setBool(lhs.scmp(rhs) > 0);
+    case FoldOp::ICmpSGE:
+        return setBool(lhs.scmp(rhs) >= 0);
+    default:
+        assert(false);
+        return;
+    }
+}
+
+/// \Returns `true` if \p value truncated towards zero is representable as an
+/// unsigned or signed (\p isSigned) integer of \p bitwidth bits
+static bool fitsInteger(APFloat const& value, size_t bitwidth, bool isSigned) {
+    if (value.isNaN() || value.isInf()) {
+        return false;
+    }
+    double const truncated = std::trunc(value.to<double>());
+    int const exponent = static_cast<int>(bitwidth) - int(isSigned);
+    double const limit = std::ldexp(1.0, exponent);
+    double const lowerLimit = isSigned ? -limit : 0.0;
+    return truncated >= lowerLimit && truncated < limit;
+}
+
+void FoldEvaluator::evaluateCast(Node const& node, FoldValue const& operand,
+                                 FoldValue& result) {
+    size_t const bitwidth = node.type.bitwidth;
+    switch (node.op) {
+    case FoldOp::Trunc: {
+        APInt const& from = operand.intValue;
+        result.intValue = from;
+        result.intValue.zext(bitwidth);
+        size_t const fromWidth = from.bitwidth();
+        result.poison =
+            (node.flags.nuw && zext(result.intValue, fromWidth) != from) ||
+            (node.flags.nsw && sext(result.intValue, fromWidth) != from);
+        return;
+    }
+    case FoldOp::ZExt:
+        result.intValue = operand.intValue;
+        result.intValue.zext(bitwidth);
+        return;
+    case FoldOp::SExt:
+        result.intValue = operand.intValue;
+        result.intValue.sext(bitwidth);
+        return;
+    case FoldOp::FPToUI:
+        if (!fitsInteger(operand.floatValue, bitwidth, false)) {
+            result.poison = true;
+            return;
+        }
+        result.intValue = valuecast<APInt>(operand.floatValue, bitwidth);
+        return;
+    case FoldOp::FPToSI:
+        if (!fitsInteger(operand.floatValue, bitwidth, true)) {
+            result.poison = true;
+            return;
+        }
+        result.intValue = signedValuecast<APInt>(operand.floatValue, bitwidth);
+        return;
+    case FoldOp::UIToFP:
+        result.floatValue = valuecast<APFloat>(operand.intValue, bitwidth);
+        return;
+    case FoldOp::SIToFP:
+        result.floatValue =
+            signedValuecast<APFloat>(operand.intValue, bitwidth);
+        return;
+    case FoldOp::FPCast:
+        /// `setPrecision()` only relabels the value, so convert through
+        /// `double`
+        result.floatValue = APFloat(operand.floatValue.to<double>(),
+                                    node.type.precision);
+        return;
+    case FoldOp::BitCast:
+        if (node.type.isFloat()) {
+            result.floatValue = bitcast<APFloat>(operand.intValue);
+        }
+        else {
+            result.intValue = bitcast<APInt>(operand.floatValue);
+        }
+        return;
+    default:
+        assert(false);
+        return;
+    }
+}
+
+void APMath::evaluate(FoldDAG const& dag, FoldResults& results) {
+    FoldEvaluator().run(dag, results);
+}
+
+void APMath::evaluate(std::span<FoldDAG const> dags,
+                      std::span<FoldResults> results) {
+    assert(dags.size() == results.size());
+    size_t const minTaskSize = std::max<size_t>(1, parallelOptions().batchSize);
+    TaskGroup group;
+    size_t begin = 0;
+    while (begin < dags.size()) {
+        size_t end = begin;
+        size_t taskSize = 0;
+        while (end < dags.size() && taskSize < minTaskSize) {
+            taskSize += dags[end++].size();
+        }
+        group.run([=] {
+            FoldEvaluator evaluator;
+            for (size_t i = begin; i < end; ++i) {
+                evaluator.run(dags[i], results[i]);
+            }
+        });
+        begin = end;
+    }
+    group.wait();
+}
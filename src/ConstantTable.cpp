@@ -0,0 +1,215 @@
+#include <APMath/ConstantTable.h>
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define APMATH_HAS_MMAP 1
+#else
+#define APMATH_HAS_MMAP 0
+#endif
+
+#include "LimbOps.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+using std::uint64_t;
+
+static constexpr uint64_t Magic = 0x0031'4C42'544D'5041; // "APMTBL1\0"
+static constexpr uint64_t Version = 1;
+static constexpr size_t HeaderWords = 5;
+static constexpr size_t DataAlignment = 64;
+
+/// Writes \p word in little endian byte order to \p dest
+static std::byte* storeWord(std::byte* dest, uint64_t word) {
+    if constexpr (std::endian::native == std::endian::big) {
+        word = byteSwap(word);
+    }
+    std::memcpy(dest, &word, sizeof(word));
+    return dest + sizeof(word);
+}
+
+std::vector<std::byte> APMath::writeConstantTable(
+    std::span<APInt const> values) {
+    size_t const indexOffset = HeaderWords * sizeof(uint64_t);
+    size_t const indexSize = 2 * values.size() * sizeof(uint64_t);
+    size_t const dataOffset =
+        ceilDiv(indexOffset + indexSize, DataAlignment) * DataAlignment;
+    size_t numLimbs = 0;
+    for (auto& value: values) {
+        numLimbs += value.limbs().size();
+    }
+    std::vector<std::byte> result(dataOffset + numLimbs * LimbSize);
+    std::byte* header = result.data();
+    for (uint64_t word:
+         { Magic, Version, uint64_t(values.size()), indexOffset, dataOffset })
+    {
+        header = storeWord(header, word);
+    }
+    std::byte* index = result.data() + indexOffset;
+    std::byte* data = result.data() + dataOffset;
+    uint64_t limbOffset = 0;
+    for (auto& value: values) {
+        index = storeWord(index, limbOffset);
+        index = storeWord(index, value.bitwidth());
+        for (Limb const limb: value.limbs()) {
+            data = storeWord(data, limb);
+        }
+        limbOffset += value.limbs().size();
+    }
+    return result;
+}
+
+bool APMath::writeConstantTable(std::span<APInt const> values,
+                                std::string const& path) {
+    auto const bytes = writeConstantTable(values);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<char const*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+std::optional<ConstantTable> ConstantTable::validate(
+    std::span<std::byte const> bytes) {
+    if (std::endian::native != std::endian::little ||
+        reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(uint64_t) !=
+            0 ||
+        bytes.size() < HeaderWords * sizeof(uint64_t))
+    {
+        return std::nullopt;
+    }
+    uint64_t header[HeaderWords];
+    std::memcpy(header, bytes.data(), sizeof(header));
+    auto const [magic, version, size, indexOffset, dataOffset] = header;
+    if (magic != Magic || version != Version ||
+        indexOffset % alignof(uint64_t) != 0 ||
+        dataOffset % alignof(uint64_t) != 0 || indexOffset > bytes.size() ||
+        size > (bytes.size() - indexOffset) / sizeof(IndexEntry) ||
+        indexOffset + size * sizeof(IndexEntry) > dataOffset ||
+        dataOffset > bytes.size())
+    {
+        return std::nullopt;
+    }
+    ConstantTable table;
+    table._index =
+        reinterpret_cast<IndexEntry const*>(bytes.data() + indexOffset);
+    table._limbs = reinterpret_cast<Limb const*>(bytes.data() + dataOffset);
+    table._size = size;
+    /// Check that all entries lie within the data and have no bits set above
+    /// their bitwidth, as required by `APIntView`
+    size_t const numDataLimbs = (bytes.size() - dataOffset) / LimbSize;
+    for (size_t i = 0; i < size; ++i) {
+        auto const [limbOffset, bitwidth] = table._index[i];
+        if (bitwidth == 0 || bitwidth > APInt::maxBitwidth()) {
+            return std::nullopt;
+        }
+        size_t const numLimbs = ceilDiv(bitwidth, LimbBitSize);
+        if (limbOffset > numDataLimbs ||
+            numLimbs > numDataLimbs - limbOffset)
+        {
+            return std::nullopt;
+        }
+        Limb const top = table._limbs[limbOffset + numLimbs - 1];
+        size_t const topBits = bitwidth - (numLimbs - 1) * LimbBitSize;
+        if ((top & ~lowBitMask(topBits)) != 0) {
+            return std::nullopt;
+        }
+    }
+    return table;
+}
+
+std::optional<ConstantTable> ConstantTable::fromBytes(
+    std::span<std::byte const> bytes) {
+    return validate(bytes);
+}
+
+std::optional<ConstantTable> ConstantTable::open(std::string const& path) {
+#if APMATH_HAS_MMAP
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    auto const size = static_cast<size_t>(info.st_size);
+    void* const mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return std::nullopt;
+    }
+    auto table = validate({ static_cast<std::byte const*>(mapping), size });
+    if (!table) {
+        ::munmap(mapping, size);
+        return std::nullopt;
+    }
+    table->_mapping = mapping;
+    table->_mappingSize = size;
+    return table;
+#else
+    /// Without `mmap` the file is read into memory owned by the table
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return std::nullopt;
+    }
+    auto const size = static_cast<size_t>(file.tellg());
+    auto* const buffer = new Limb[ceilDiv(size, LimbSize)];
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer),
+              static_cast<std::streamsize>(size));
+    auto table =
+        file ? validate({ reinterpret_cast<std::byte const*>(buffer), size }) :
+               std::nullopt;
+    if (!table) {
+        delete[] buffer;
+        return std::nullopt;
+    }
+    table->_mapping = buffer;
+    table->_mappingSize = size;
+    return table;
+#endif
+}
+
+ConstantTable::ConstantTable(ConstantTable&& rhs) noexcept:
+    _index(rhs._index),
+    _limbs(rhs._limbs),
+    _size(rhs._size),
+    _mapping(std::exchange(rhs._mapping, nullptr)),
+    _mappingSize(std::exchange(rhs._mappingSize, 0)) {}
+
+ConstantTable& ConstantTable::operator=(ConstantTable&& rhs) noexcept {
+    if (this != &rhs) {
+        unmap();
+        _index = rhs._index;
+        _limbs = rhs._limbs;
+        _size = rhs._size;
+        _mapping = std::exchange(rhs._mapping, nullptr);
+        _mappingSize = std::exchange(rhs._mappingSize, 0);
+    }
+    return *this;
+}
+
+ConstantTable::~ConstantTable() { unmap(); }
+
+void ConstantTable::unmap() {
+    if (!_mapping) {
+        return;
+    }
+#if APMATH_HAS_MMAP
+    ::munmap(_mapping, _mappingSize);
+#else
+    delete[] static_cast<Limb*>(_mapping);
+#endif
+    _mapping = nullptr;
+    _mappingSize = 0;
+}
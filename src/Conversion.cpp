@@ -6,10 +6,13 @@
 #include <APMath/APFloat.h>
 #include <APMath/APInt.h>
 
+#include "Instrument.h"
+
 using namespace APMath;
 
 template <>
 APInt APMath::bitcast(APFloat const& from) {
+    APMATH_INSTRUMENT(Conversion, from.precision().totalBitwidth());
     if (from.precision() == APFloatPrec::Single()) {
         return APInt(std::bit_cast<uint32_t>(from.to<float>()), 32);
     }
@@ -20,6 +23,7 @@ APInt APMath::bitcast(APFloat const& from) {
 
 template <>
 APFloat APMath::bitcast(APInt const& from) {
+    APMATH_INSTRUMENT(Conversion, from.bitwidth());
     assert((from.bitwidth() == 32 || from.bitwidth() == 64) &&
            "Other sizes are not supported by APFloat");
     if (from.bitwidth() == 32) {
@@ -34,6 +38,7 @@ APFloat APMath::bitcast(APInt const& from) {
 
 template <>
 APInt APMath::valuecast(APFloat const& from, size_t toBitwidth) {
+    APMATH_INSTRUMENT(Conversion, from.precision().totalBitwidth());
     if (from.precision() == APFloatPrec::Single()) {
         switch (toBitwidth) {
         case 8:
@@ -68,6 +73,7 @@ APInt APMath::valuecast(APFloat const& from, size_t toBitwidth) {
 
 template <>
 APFloat APMath::valuecast(APInt const& from, size_t toBitwidth) {
+    APMATH_INSTRUMENT(Conversion, from.bitwidth());
     assert((toBitwidth == 32 || toBitwidth == 64) &&
            "Other sizes are not supported by APFloat");
     APInt ext = zext(from, 64);
@@ -83,6 +89,7 @@ APFloat APMath::valuecast(APInt const& from, size_t toBitwidth) {
 
 template <>
 APInt APMath::signedValuecast(APFloat const& from, size_t toBitwidth) {
+    APMATH_INSTRUMENT(Conversion, from.precision().totalBitwidth());
     if (from.precision() == APFloatPrec::Single()) {
         switch (toBitwidth) {
         case 8:
@@ -117,6 +124,7 @@ APInt APMath::signedValuecast(APFloat const& from, size_t toBitwidth) {
 
 template <>
 APFloat APMath::signedValuecast(APInt const& from, size_t toBitwidth) {
+    APMATH_INSTRUMENT(Conversion, from.bitwidth());
     assert((toBitwidth == 32 || toBitwidth == 64) &&
            "Other sizes are not supported by APFloat");
     APInt ext = sext(from, 64);
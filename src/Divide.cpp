@@ -0,0 +1,246 @@
+#include "Divide.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "Multiply.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+/// Operand size in limbs below which reciprocals are computed by Knuth's
+/// algorithm
+static constexpr size_t ReciprocalBasecase = 32;
+
+/// `a += 1` for \p n limbs
+static void incrementLimbs(Limb* a, size_t n) {
+    for (size_t i = 0; i < n && ++a[i] == 0; ++i) {
+    }
+}
+
+/// `r = a * b` where the top limb of \p b is small, e.g. of a reciprocal.
+/// Multiplies by the top limb separately to keep the size of the full product
+/// at `na + nb - 1` limbs, which avoids doubling the transform length of the
+/// NTT when `na + nb - 1` is a power of two.
+static void mulSplitTop(Limb* r,
+                        Limb const* a,
+                        size_t na,
+                        Limb const* b,
+                        size_t nb) {
+    assert(nb > 1);
+    mulLimbs(r, a, na, b, nb - 1);
+    r[na + nb - 1] = mulAddLimb(r + nb - 1, a, na, b[nb - 1]);
+}
+
+void internal::reciprocalLimbs(Limb* inv, Limb const* v, size_t n) {
+    assert(n > 0 && v[n - 1] >> (LimbBitSize - 1) == 1);
+    if (n < ReciprocalBasecase) {
+        ScratchLimbs<2 * ReciprocalBasecase + 1> pow(2 * n + 1);
+        std::memset(pow.data(), 0, 2 * n * LimbSize);
+        pow[2 * n] = 1;
+        ScratchLimbs<ReciprocalBasecase + 2> q(n + 2);
+        divremKnuth(q.data(), nullptr, pow.data(), 2 * n + 1, v, n);
+        assert(q[n + 1] == 0);
+        std::memcpy(inv, q.data(), (n + 1) * LimbSize);
+        return;
+    }
+    /// Newton step `X1 = X0 + X0 * (B^2n - v * X0) / B^2n` from the reciprocal
+    /// `X0 = Ih * B^(n - h)` of the top `h` limbs of `v`
+    size_t const h = (n + 1) / 2;
+    std::vector<Limb> ih(h + 1);
+    reciprocalLimbs(ih.data(), v + (n - h), h);
+    /// `e = B^(n + h) - v * Ih`, which satisfies `|e| <= 2 * B^n`
+    std::vector<Limb> t(n + h + 1);
+    mulSplitTop(t.data(), v, n, ih.data(), h + 1);
+    bool const negative = t[n + h] != 0;
+    std::vector<Limb> e(n + 1);
+    if (negative) {
+        t[n + h] -= 1;
+        assert(normalizedSize(t.data(), n + h + 1) <= n + 1);
+        std::memcpy(e.data(), t.data(), (n + 1) * LimbSize);
+    }
+    else {
+        /// `B^(n + h) - t` is the two's complement of `t` in `n + h` limbs
+        Limb carry = 1;
+        for (size_t i = 0; i < n + h; ++i) {
+            t[i] = ~t[i] + carry;
+            carry &= t[i] == 0;
+        }
+        assert(normalizedSize(t.data(), n + h) <= n + 1);
+        std::memcpy(e.data(), t.data(), (n + 1) * LimbSize);
+    }
+    /// `d = Ih * |e| / B^2h`
+    std::vector<Limb> de(n + h + 2);
+    mulSplitTop(de.data(), e.data(), n + 1, ih.data(), h + 1);
+    Limb const* d = de.data() + 2 * h;
+    size_t const nd = n - h + 2;
+    /// `x = Ih * B^(n - h) +- d` in `n + 2` limbs
+    std::vector<Limb> x(n + 2);
+    std::memset(x.data(), 0, (n - h) * LimbSize);
+    std::memcpy(x.data() + (n - h), ih.data(), (h + 1) * LimbSize);
+    x[n + 1] = 0;
+    if (negative) {
+        Limb const borrow = subLimbs(x.data(), x.data(), d, nd);
+        decrementLimbs(x.data() + nd, n + 2 - nd, borrow);
+    }
+    else {
+        Limb const carry = addLimbs(x.data(), x.data(), d, nd);
+        addLimb(x.data() + nd, x.data() + nd, n + 2 - nd, carry);
+    }
+    /// Exact correction, `x` is off by a small constant at most
+    std::vector<Limb> p(2 * n + 2);
+    std::vector<Limb> pow(2 * n + 2);
+    std::memset(pow.data(), 0, (2 * n + 2) * LimbSize);
+    pow[2 * n] = 1;
+    assert(x[n + 1] == 0);
+    p[2 * n + 1] = 0;
+    mulSplitTop(p.data(), v, n, x.data(), n + 1);
+    while (cmpLimbs(p.data(), pow.data(), 2 * n + 2) > 0) {
+        decrementLimbs(x.data(), n + 2, 1);
+        Limb const borrow = subLimbs(p.data(), p.data(), v, n);
+        decrementLimbs(p.data() + n, n + 2, borrow);
+    }
+    subLimbs(p.data(), pow.data(), p.data(), 2 * n + 2);
+    while (cmpLimbs(p.data(), 2 * n + 2, v, n) >= 0) {
+        incrementLimbs(x.data(), n + 2);
+        Limb const borrow = subLimbs(p.data(), p.data(), v, n);
+        decrementLimbs(p.data() + n, n + 2, borrow);
+    }
+    assert(x[n + 1] == 0);
+    std::memcpy(inv, x.data(), (n + 1) * LimbSize);
+}
+
+namespace {
+
+/// Division by a fixed normalized divisor using its reciprocal
+class NewtonDivider {
+public:
+    NewtonDivider(Limb const* v, size_t n):
+        v(v), n(n), inv(n + 1), prod(2 * n + 2), qv(2 * n) {
+        reciprocalLimbs(inv.data(), v, n);
+    }
+
+    /// Divides the `n + b` limbs of \p a, which must be less than `v * B^b`,
+    /// by `v` for `b <= n`. Writes `b` quotient limbs to \p q and leaves the
+    /// remainder in the low `n` limbs of \p a.
+    void step(Limb* q, Limb* a, size_t b) {
+        assert(b <= n);
+        /// The estimate `(a / B^(n - 1)) * inv / B^(n + 1)` is at most 3 below
+        /// the quotient
+        mulSplitTop(prod.data(), a + n - 1, b + 1, inv.data(), n + 1);
+        assert(prod[n + b + 1] == 0);
+        std::memcpy(q, prod.data() + n + 1, b * LimbSize);
+        size_t const nq = normalizedSize(q, b);
+        if (nq > 0) {
+            mulLimbs(qv.data(), q, nq, v, n);
+            Limb const borrow = subLimbs(a, a, qv.data(), nq + n);
+            decrementLimbs(a + nq + n, b - nq, borrow);
+        }
+        while (cmpLimbs(a, n + b, v, n) >= 0) {
+            Limb const borrow = subLimbs(a, a, v, n);
+            decrementLimbs(a + n, b, borrow);
+            incrementLimbs(q, b);
+        }
+    }
+
+private:
+    Limb const* v;
+    size_t n;
+    std::vector<Limb> inv;
+    std::vector<Limb> prod;
+    std::vector<Limb> qv;
+};
+
+} // namespace
+
+/// Newton division of \p u by the normalized \p v. The top `n - 1` limbs of
+/// `u` are less than `v` and form the first remainder, the remaining limbs are
+/// processed in blocks of `n` limbs from the top. \p q must have `m - n + 1`
+/// limbs.
+static void divremNewton(Limb* q,
+                         Limb* r,
+                         Limb const* u,
+                         size_t m,
+                         Limb const* v,
+                         size_t n) {
+    NewtonDivider divider(v, n);
+    size_t pos = m - (n - 1);
+    std::vector<Limb> a(2 * n);
+    std::memcpy(a.data(), u + pos, (n - 1) * LimbSize);
+    a[n - 1] = 0;
+    while (pos > 0) {
+        size_t const b = std::min(n, pos);
+        pos -= b;
+        std::memmove(a.data() + b, a.data(), n * LimbSize);
+        std::memcpy(a.data(), u + pos, b * LimbSize);
+        divider.step(q + pos, a.data(), b);
+    }
+    if (r) {
+        std::memcpy(r, a.data(), n * LimbSize);
+    }
+}
+
+void internal::divremLimbs(Limb* q,
+                           Limb* r,
+                           Limb const* u,
+                           size_t m,
+                           Limb const* v,
+                           size_t n) {
+    assert(n > 0 && m >= n && v[n - 1] != 0);
+    size_t const k = m - n + 1;
+    if (n < NewtonDivThreshold || k < NewtonDivThreshold) {
+        divremKnuth(q, r, u, m, v, n);
+        return;
+    }
+    if (k + 1 < n) {
+        /// Short quotient: Dividing the top limbs overestimates the quotient
+        /// by a small constant, which is corrected by multiplying back
+        size_t const t = n - k - 1;
+        std::vector<Limb> qs(k);
+        divremLimbs(qs.data(), nullptr, u + t, m - t, v + t, k + 1);
+        std::vector<Limb> p(k + n);
+        mulLimbs(p.data(), qs.data(), k, v, n);
+        while (cmpLimbs(p.data(), k + n, u, m) > 0) {
+            decrementLimbs(qs.data(), k, 1);
+            Limb const borrow = subLimbs(p.data(), p.data(), v, n);
+            decrementLimbs(p.data() + n, k, borrow);
+        }
+        if (r) {
+            std::vector<Limb> rs(m);
+            Limb const borrow = subLimbs(rs.data(), u, p.data(), m);
+            assert(borrow == 0 && normalizedSize(rs.data(), m) <= n);
+            (void)borrow;
+            std::memcpy(r, rs.data(), n * LimbSize);
+        }
+        if (q) {
+            std::memcpy(q, qs.data(), k * LimbSize);
+        }
+        return;
+    }
+    /// Normalize such that the most significant bit of `v` is set
+    unsigned const s = static_cast<unsigned>(std::countl_zero(v[n - 1]));
+    std::vector<Limb> vn(n);
+    std::vector<Limb> un(m + 1);
+    shlLimbs(vn.data(), v, n, s);
+    un[m] = shlLimbs(un.data(), u, m, s);
+    std::vector<Limb> rn(r ? n : 0);
+    std::vector<Limb> qn(m + 2 - n);
+    divremNewton(qn.data(),
+                 r ? rn.data() : nullptr,
+                 un.data(),
+                 m + 1,
+                 vn.data(),
+                 n);
+    if (q) {
+        assert(qn[k] == 0);
+        std::memcpy(q, qn.data(), k * LimbSize);
+    }
+    if (r) {
+        shrLimbs(r, rn.data(), n, s);
+    }
+}
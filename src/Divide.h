@@ -0,0 +1,34 @@
+#ifndef APMATH_DIVIDE_H_
+#define APMATH_DIVIDE_H_
+
+#include <cstddef>
+
+#include "LimbOps.h"
+
+/// Division of limb buffers. Like the functions in `Multiply.h` these select
+/// an algorithm based on the operand sizes and may allocate scratch memory.
+
+namespace APMath::internal {
+
+/// Divisor and quotient size in limbs from which on division multiplies by a
+/// reciprocal computed by Newton iteration instead of using Knuth's algorithm
+inline constexpr std::size_t NewtonDivThreshold = 3000;
+
+/// Computes `q = u / v` and `r = u % v` where \p u has \p m limbs and \p v
+/// has \p n limbs with `m >= n` and `v[n - 1] != 0`. \p q must have
+/// `m - n + 1` limbs and \p r must have \p n limbs. \p q and \p r may be null
+/// if the respective result is not needed. No buffer may alias another.
+void divremLimbs(Limb* q,
+                 Limb* r,
+                 Limb const* u,
+                 std::size_t m,
+                 Limb const* v,
+                 std::size_t n);
+
+/// Computes `floor(B^2n / v)` of \p n limbs \p v with the most significant bit
+/// set, where `B = 2^LimbBitSize`. \p inv must have `n + 1` limbs.
+void reciprocalLimbs(Limb* inv, Limb const* v, std::size_t n);
+
+} // namespace APMath::internal
+
+#endif // APMATH_DIVIDE_H_
@@ -0,0 +1,121 @@
+#ifndef APMATH_INSTRUMENT_H_
+#define APMATH_INSTRUMENT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <APMath/Batch.h>
+#include <APMath/Instrumentation.h>
+
+#if APMATH_INSTRUMENTATION
+#include <chrono>
+#endif
+
+/// Hooks that update the counters of `Instrumentation.h`. With
+/// instrumentation disabled the macros expand to nothing.
+///
+/// - `APMATH_INSTRUMENT(Op, bitwidth)` counts a call of `InstrumentedOp::Op`
+///   and the time until the end of the enclosing scope
+/// - `APMATH_RECORD_ALLOCATION(numBytes)` and
+///   `APMATH_RECORD_DEALLOCATION(numBytes)` count heap allocations
+/// - `APMATH_TRACE(op, lhs, rhs)` appends the operation \p op with its
+///   operands to the trace if a trace is being recorded and the enclosing
+///   scope is not nested in another traced operation. \p rhs may be an
+///   integer shift amount.
+
+#if APMATH_INSTRUMENTATION
+
+namespace APMath::internal {
+
+void recordOperation(InstrumentedOp op,
+                     std::size_t bitwidth,
+                     std::uint64_t nanoseconds);
+
+void recordAllocation(std::size_t numBytes);
+
+void recordDeallocation(std::size_t numBytes);
+
+/// Records one call of an operation when it goes out of scope
+class ScopedOperation {
+public:
+    ScopedOperation(InstrumentedOp op, std::size_t bitwidth):
+        op(op), bitwidth(bitwidth), start(Clock::now()) {}
+
+    ScopedOperation(ScopedOperation const&) = delete;
+    ScopedOperation& operator=(ScopedOperation const&) = delete;
+
+    ~ScopedOperation() {
+        auto const duration = Clock::now() - start;
+        recordOperation(op,
+                        bitwidth,
+                        static_cast<std::uint64_t>(
+                            std::chrono::duration_cast<
+                                std::chrono::nanoseconds>(duration)
+                                .count()));
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    InstrumentedOp op;
+    std::size_t bitwidth;
+    Clock::time_point start;
+};
+
+/// Nesting depth of traced operations on this thread
+extern thread_local int traceDepth;
+
+/// `true` while a trace is being recorded
+bool isTracing();
+
+void traceOperation(APIntOp op, APInt const& lhs, APInt const& rhs);
+
+void traceOperation(APFloatOp op, APFloat const& lhs, APFloat const& rhs);
+
+/// Records an operation if it is not nested in another traced operation
+class ScopedTrace {
+public:
+    template <typename Op, typename T>
+    ScopedTrace(Op op, T const& lhs, T const& rhs) {
+        if (traceDepth++ == 0 && isTracing()) {
+            traceOperation(op, lhs, rhs);
+        }
+    }
+
+    ScopedTrace(APIntOp op, APInt const& lhs, int shiftAmount) {
+        if (traceDepth++ == 0 && isTracing()) {
+            traceOperation(op, lhs, APInt(shiftAmount, lhs.bitwidth()));
+        }
+    }
+
+    ScopedTrace(ScopedTrace const&) = delete;
+    ScopedTrace& operator=(ScopedTrace const&) = delete;
+
+    ~ScopedTrace() { --traceDepth; }
+};
+
+} // namespace APMath::internal
+
+#define APMATH_INSTRUMENT(Op, bitwidth)                                        \
+    ::APMath::internal::ScopedOperation apmathScopedOperation(                 \
+        ::APMath::InstrumentedOp::Op, bitwidth)
+
+#define APMATH_RECORD_ALLOCATION(numBytes)                                     \
+    ::APMath::internal::recordAllocation(numBytes)
+
+#define APMATH_RECORD_DEALLOCATION(numBytes)                                   \
+    ::APMath::internal::recordDeallocation(numBytes)
+
+#define APMATH_TRACE(op, lhs, rhs)                                             \
+    ::APMath::internal::ScopedTrace apmathScopedTrace(op, lhs, rhs)
+
+#else
+
+#define APMATH_INSTRUMENT(Op, bitwidth)        ((void)0)
+#define APMATH_RECORD_ALLOCATION(numBytes)     ((void)0)
+#define APMATH_RECORD_DEALLOCATION(numBytes)   ((void)0)
+#define APMATH_TRACE(op, lhs, rhs)             ((void)0)
+
+#endif
+
+#endif // APMATH_INSTRUMENT_H_
@@ -0,0 +1,141 @@
+#include <APMath/Instrumentation.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+
+#include "Instrument.h"
+
+using namespace APMath;
+
+using std::size_t;
+using std::uint64_t;
+
+char const* APMath::toString(InstrumentedOp op) {
+    switch (op) {
+    case InstrumentedOp::Add:
+        return "Add";
+    case InstrumentedOp::Sub:
+        return "Sub";
+    case InstrumentedOp::Mul:
+        return "Mul";
+    case InstrumentedOp::UDivRem:
+        return "UDivRem";
+    case InstrumentedOp::SDivRem:
+        return "SDivRem";
+    case InstrumentedOp::DivExact:
+        return "DivExact";
+    case InstrumentedOp::BtwAnd:
+        return "BtwAnd";
+    case InstrumentedOp::BtwOr:
+        return "BtwOr";
+    case InstrumentedOp::BtwXor:
+        return "BtwXor";
+    case InstrumentedOp::Shift:
+        return "Shift";
+    case InstrumentedOp::Extend:
+        return "Extend";
+    case InstrumentedOp::Compare:
+        return "Compare";
+    case InstrumentedOp::ToString:
+        return "ToString";
+    case InstrumentedOp::Parse:
+        return "Parse";
+    case InstrumentedOp::FAdd:
+        return "FAdd";
+    case InstrumentedOp::FSub:
+        return "FSub";
+    case InstrumentedOp::FMul:
+        return "FMul";
+    case InstrumentedOp::FDiv:
+        return "FDiv";
+    case InstrumentedOp::FMath:
+        return "FMath";
+    case InstrumentedOp::Conversion:
+        return "Conversion";
+    }
+    assert(false);
+    std::abort();
+}
+
+std::string InstrumentationSnapshot::toJSON() const {
+    std::string result = "{\"operations\":{";
+    bool first = true;
+    for (size_t i = 0; i < NumInstrumentedOps; ++i) {
+        Operation const& operation = operations[i];
+        if (operation.calls == 0) {
+            continue;
+        }
+        if (!first) {
+            result += ',';
+        }
+        first = false;
+        result += '"';
+        result += toString(static_cast<InstrumentedOp>(i));
+        result += "\":{\"calls\":" + std::to_string(operation.calls);
+        result += ",\"nanoseconds\":" + std::to_string(operation.nanoseconds);
+        /// The histogram is written as an object keyed by the upper bound of
+        /// each nonempty bucket
+        result += ",\"bitwidths\":{";
+        bool firstBucket = true;
+        for (size_t j = 0; j < NumBitwidthBuckets; ++j) {
+            if (operation.bitwidthHistogram[j] == 0) {
+                continue;
+            }
+            if (!firstBucket) {
+                result += ',';
+            }
+            firstBucket = false;
+            result += '"' + std::to_string(uint64_t(1) << j) + "\":";
+            result += std::to_string(operation.bitwidthHistogram[j]);
+        }
+        result += "}}";
+    }
+    result += "},\"allocations\":" + std::to_string(allocations);
+    result += ",\"deallocations\":" + std::to_string(deallocations);
+    result += ",\"allocatedBytes\":" + std::to_string(allocatedBytes);
+    result += ",\"currentBytes\":" + std::to_string(currentBytes);
+    result += ",\"peakBytes\":" + std::to_string(peakBytes);
+    result += '}';
+    return result;
+}
+
+#if APMATH_INSTRUMENTATION
+
+static thread_local InstrumentationSnapshot counters;
+
+void internal::recordOperation(InstrumentedOp op,
+                               size_t bitwidth,
+                               uint64_t nanoseconds) {
+    auto& operation = counters.operations[static_cast<size_t>(op)];
+    ++operation.calls;
+    operation.nanoseconds += nanoseconds;
+    size_t const bucket =
+        bitwidth <= 1 ? 0 : static_cast<size_t>(std::bit_width(bitwidth - 1));
+    ++operation.bitwidthHistogram[std::min(bucket, NumBitwidthBuckets - 1)];
+}
+
+void internal::recordAllocation(size_t numBytes) {
+    ++counters.allocations;
+    counters.allocatedBytes += numBytes;
+    counters.currentBytes += static_cast<std::int64_t>(numBytes);
+    counters.peakBytes = std::max(counters.peakBytes, counters.currentBytes);
+}
+
+void internal::recordDeallocation(size_t numBytes) {
+    ++counters.deallocations;
+    counters.currentBytes -= static_cast<std::int64_t>(numBytes);
+}
+
+InstrumentationSnapshot APMath::instrumentationSnapshot() { return counters; }
+
+void APMath::resetInstrumentation() { counters = {}; }
+
+#else
+
+InstrumentationSnapshot APMath::instrumentationSnapshot() { return {}; }
+
+void APMath::resetInstrumentation() {}
+
+#endif
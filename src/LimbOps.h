@@ -0,0 +1,527 @@
+#ifndef APMATH_LIMBOPS_H_
+#define APMATH_LIMBOPS_H_
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include <APMath/APInt.h>
+
+/// Low level kernels operating on raw limb buffers.
+/// These are shared between the translation units implementing `APInt`
+/// operations and are not part of the public interface. Unless stated
+/// otherwise buffers are little endian arrays of limbs and the functions do
+/// not allocate.
+
+namespace APMath::internal {
+
+/// Grants the implementation access to the limb storage of `APInt`
+struct APIntAccess {
+    static Limb* limbPtr(APInt& value) { return value.limbPtr(); }
+
+    static Limb const* limbPtr(APInt const& value) { return value.limbPtr(); }
+
+    static std::size_t numLimbs(APInt const& value) {
+        return value.numLimbs();
+    }
+
+    static Limb topLimbMask(APInt const& value) { return value.topLimbMask(); }
+
+    /// Clears the bits above the bitwidth of \p value
+    static void clearUnusedBits(APInt& value) {
+        value.limbPtr()[value.numLimbs() - 1] &= value.topLimbMask();
+    }
+};
+
+/// Limb buffer with inline storage for up to \p InlineLimbs limbs. Larger
+/// buffers are allocated on the heap. Contents are uninitialized.
+template <std::size_t InlineLimbs>
+class ScratchLimbs {
+public:
+    explicit ScratchLimbs(std::size_t size): _size(size) {
+        if (size > InlineLimbs) {
+            _heap = std::make_unique<Limb[]>(size);
+        }
+    }
+
+    ScratchLimbs(ScratchLimbs const&) = delete;
+    ScratchLimbs& operator=(ScratchLimbs const&) = delete;
+
+    Limb* data() { return _heap ? _heap.get() : _inline; }
+    Limb const* data() const { return _heap ? _heap.get() : _inline; }
+
+    std::size_t size() const { return _size; }
+
+    Limb& operator[](std::size_t index) {
+        assert(index < _size);
+        return data()[index];
+    }
+
+private:
+    std::size_t _size;
+    std::unique_ptr<Limb[]> _heap;
+    Limb _inline[InlineLimbs];
+};
+
+/// \Returns the high limb of the full product `a * b`
+inline Limb mulHi(Limb a, Limb b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<Limb>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    constexpr Limb mask = 0xFFFF'FFFF;
+    Limb const a0 = a & mask;
+    Limb const a1 = a >> 32;
+    Limb const b0 = b & mask;
+    Limb const b1 = b >> 32;
+    Limb const d0 = a1 * b0 + (a0 * b0 >> 32);
+    Limb const d1 = a0 * b1;
+    Limb const c1 = d0 + d1;
+    Limb const c2 = (c1 >> 32) + (c1 < d0 ? 0x1'0000'0000u : 0);
+    return a1 * b1 + c2;
+#endif
+}
+
+/// \Returns \p a with the order of its bytes reversed
+inline Limb byteSwap(Limb a) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(a);
+#else
+    a = (a & 0x00FF'00FF'00FF'00FF) << 8 | (a >> 8 & 0x00FF'00FF'00FF'00FF);
+    a = (a & 0x0000'FFFF'0000'FFFF) << 16 | (a >> 16 & 0x0000'FFFF'0000'FFFF);
+    return a << 32 | a >> 32;
+#endif
+}
+
+/// \Returns \p a with the order of its bits reversed
+inline Limb bitReverse(Limb a) {
+    a = byteSwap(a);
+    a = (a & 0x0F0F'0F0F'0F0F'0F0F) << 4 | (a >> 4 & 0x0F0F'0F0F'0F0F'0F0F);
+    a = (a & 0x3333'3333'3333'3333) << 2 | (a >> 2 & 0x3333'3333'3333'3333);
+    a = (a & 0x5555'5555'5555'5555) << 1 | (a >> 1 & 0x5555'5555'5555'5555);
+    return a;
+}
+
+/// Divides the two limb number `(hi, lo)` by \p d
+/// \pre `hi < d`
+/// \Returns the quotient and writes the remainder to \p rem
+inline Limb divWide(Limb hi, Limb lo, Limb d, Limb& rem) {
+    assert(hi < d);
+#if defined(__SIZEOF_INT128__)
+    auto const n = static_cast<unsigned __int128>(hi) << 64 | lo;
+    rem = static_cast<Limb>(n % d);
+    return static_cast<Limb>(n / d);
+#else
+    /// Hacker's Delight `divlu`
+    constexpr Limb b = Limb(1) << 32;
+    constexpr Limb mask = b - 1;
+    int const s = std::countl_zero(d);
+    d <<= s;
+    Limb const vn1 = d >> 32;
+    Limb const vn0 = d & mask;
+    Limb const un32 = (hi << s) | (s == 0 ? 0 : lo >> (64 - s));
+    Limb const un10 = lo << s;
+    Limb const un1 = un10 >> 32;
+    Limb const un0 = un10 & mask;
+    Limb q1 = un32 / vn1;
+    Limb rhat = un32 - q1 * vn1;
+    while (q1 >= b || q1 * vn0 > b * rhat + un1) {
+        --q1;
+        rhat += vn1;
+        if (rhat >= b) {
+            break;
+        }
+    }
+    Limb const un21 = un32 * b + un1 - q1 * d;
+    Limb q0 = un21 / vn1;
+    rhat = un21 - q0 * vn1;
+    while (q0 >= b || q0 * vn0 > b * rhat + un0) {
+        --q0;
+        rhat += vn1;
+        if (rhat >= b) {
+            break;
+        }
+    }
+    rem = (un21 * b + un0 - q0 * d) >> s;
+    return q1 * b + q0;
+#endif
+}
+
+/// \Returns the number of limbs of \p a without leading zero limbs
+inline std::size_t normalizedSize(Limb const* a, std::size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        --n;
+    }
+    return n;
+}
+
+/// Compares \p a and \p b of \p n limbs each
+inline int cmpLimbs(Limb const* a, Limb const* b, std::size_t n) {
+    for (std::size_t i = n; i > 0;) {
+        --i;
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/// Compares \p a with \p na limbs and \p b with \p nb limbs
+inline int cmpLimbs(Limb const* a,
+                    std::size_t na,
+                    Limb const* b,
+                    std::size_t nb) {
+    na = normalizedSize(a, na);
+    nb = normalizedSize(b, nb);
+    if (na != nb) {
+        return na < nb ? -1 : 1;
+    }
+    return cmpLimbs(a, b, na);
+}
+
+/// `r = a + b` for \p n limbs. \p r may alias \p a or \p b
+/// \Returns the carry out
+inline Limb addLimbs(Limb* r, Limb const* a, Limb const* b, std::size_t n) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb const s = a[i] + b[i];
+        Limb const c1 = s < a[i];
+        r[i] = s + carry;
+        carry = c1 | (r[i] < s);
+    }
+    return carry;
+}
+
+/// `r = a - b` for \p n limbs. \p r may alias \p a or \p b
+/// \Returns the borrow out
+inline Limb subLimbs(Limb* r, Limb const* a, Limb const* b, std::size_t n) {
+    Limb borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb const d = a[i] - b[i];
+        Limb const b1 = a[i] < b[i];
+        r[i] = d - borrow;
+        borrow = b1 | (d < borrow);
+    }
+    return borrow;
+}
+
+/// `r = a + b` where \p a has \p n limbs and \p b is a single limb
+/// \Returns the carry out
+inline Limb addLimb(Limb* r, Limb const* a, std::size_t n, Limb b) {
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = a[i] + b;
+        b = r[i] < b;
+    }
+    return b;
+}
+
+/// `r = a - b` where \p a has \p n limbs and \p b is a single limb
+/// \Returns the borrow out
+inline Limb subLimb(Limb* r, Limb const* a, std::size_t n, Limb b) {
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb const ai = a[i];
+        r[i] = ai - b;
+        b = ai < b;
+    }
+    return b;
+}
+
+/// `a -= b` for \p n limbs of \p a, stops as soon as the borrow is resolved
+/// \Returns the borrow out
+inline Limb decrementLimbs(Limb* a, std::size_t n, Limb b) {
+    for (std::size_t i = 0; i < n && b != 0; ++i) {
+        Limb const ai = a[i];
+        a[i] = ai - b;
+        b = ai < b;
+    }
+    return b;
+}
+
+/// \Returns the inverse of the odd limb \p d modulo `2^LimbBitSize`
+inline Limb inverse2Adic(Limb d) {
+    assert(d % 2 == 1);
+    /// `3 * d ^ 2` is correct to 5 bits, every Newton step doubles that
+    Limb inv = (3 * d) ^ 2;
+    for (int i = 0; i < 4; ++i) {
+        inv *= 2 - d * inv;
+    }
+    return inv;
+}
+
+/// `r = a * b` for \p n limbs of \p a
+/// \Returns the high limb of the product
+inline Limb mulLimb(Limb* r, Limb const* a, std::size_t n, Limb b) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb const lo = a[i] * b;
+        Limb hi = mulHi(a[i], b);
+        r[i] = lo + carry;
+        hi += r[i] < lo;
+        carry = hi;
+    }
+    return carry;
+}
+
+/// `r += a * b` for \p n limbs of \p a and \p r
+/// \Returns the carry out
+inline Limb mulAddLimb(Limb* r, Limb const* a, std::size_t n, Limb b) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb lo = a[i] * b;
+        Limb hi = mulHi(a[i], b);
+        lo += carry;
+        hi += lo < carry;
+        r[i] += lo;
+        hi += r[i] < lo;
+        carry = hi;
+    }
+    return carry;
+}
+
+/// `r -= a * b` for \p n limbs of \p a and \p r
+/// \Returns the borrow out
+inline Limb mulSubLimb(Limb* r, Limb const* a, std::size_t n, Limb b) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb lo = a[i] * b;
+        Limb hi = mulHi(a[i], b);
+        lo += carry;
+        hi += lo < carry;
+        Limb const t = r[i];
+        r[i] = t - lo;
+        hi += t < lo;
+        carry = hi;
+    }
+    return carry;
+}
+
+/// `r = a * b` (schoolbook). \p r must have `na + nb` limbs and must not alias
+/// the operands.
+inline void mulSchoolbook(Limb* r,
+                          Limb const* a,
+                          std::size_t na,
+                          Limb const* b,
+                          std::size_t nb) {
+    assert(na > 0 && nb > 0);
+    r[na] = mulLimb(r, a, na, b[0]);
+    for (std::size_t j = 1; j < nb; ++j) {
+        r[na + j] = mulAddLimb(r + j, a, na, b[j]);
+    }
+}
+
+/// `r = a << s` for \p n limbs with `s < LimbBitSize`. \p r may alias \p a
+/// \Returns the bits shifted out
+inline Limb shlLimbs(Limb* r, Limb const* a, std::size_t n, unsigned s) {
+    assert(s < LimbBitSize);
+    if (s == 0) {
+        std::memmove(r, a, n * LimbSize);
+        return 0;
+    }
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb const ai = a[i];
+        r[i] = ai << s | carry;
+        carry = ai >> (LimbBitSize - s);
+    }
+    return carry;
+}
+
+/// `r = a >> s` for \p n limbs with `s < LimbBitSize`. \p r may alias \p a
+inline void shrLimbs(Limb* r, Limb const* a, std::size_t n, unsigned s) {
+    assert(s < LimbBitSize);
+    if (s == 0) {
+        std::memmove(r, a, n * LimbSize);
+        return;
+    }
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        r[i] = a[i] >> s | a[i + 1] << (LimbBitSize - s);
+    }
+    if (n > 0) {
+        r[n - 1] = a[n - 1] >> s;
+    }
+}
+
+/// \Returns the number of trailing zero bits of \p a with \p n limbs
+/// \pre \p a is not zero
+inline std::size_t ctzLimbs(Limb const* a, std::size_t n) {
+    std::size_t i = 0;
+    while (a[i] == 0) {
+        ++i;
+        assert(i < n);
+    }
+    return i * LimbBitSize + static_cast<std::size_t>(std::countr_zero(a[i]));
+}
+
+/// \Returns a limb with the low \p numBits `<= LimbBitSize` bits set
+inline Limb lowBitMask(std::size_t numBits) {
+    return numBits == LimbBitSize ? ~Limb(0) : (Limb(1) << numBits) - 1;
+}
+
+/// \Returns the \p numBits `<= LimbBitSize` bits of \p data starting at bit
+/// \p pos
+inline Limb loadBits(Limb const* data, std::size_t pos, std::size_t numBits) {
+    std::size_t const index = pos / LimbBitSize;
+    std::size_t const offset = pos % LimbBitSize;
+    Limb value = data[index] >> offset;
+    if (offset + numBits > LimbBitSize) {
+        value |= data[index + 1] << (LimbBitSize - offset);
+    }
+    return value & lowBitMask(numBits);
+}
+
+/// Writes the low \p numBits `<= LimbBitSize` bits of \p value to \p data
+/// starting at bit \p pos. Other bits of \p data are preserved
+inline void storeBits(Limb* data,
+                      std::size_t pos,
+                      std::size_t numBits,
+                      Limb value) {
+    std::size_t const index = pos / LimbBitSize;
+    std::size_t const offset = pos % LimbBitSize;
+    Limb const mask = lowBitMask(numBits);
+    value &= mask;
+    data[index] = (data[index] & ~(mask << offset)) | (value << offset);
+    if (offset + numBits > LimbBitSize) {
+        Limb const highMask = lowBitMask(offset + numBits - LimbBitSize);
+        data[index + 1] = (data[index + 1] & ~highMask) |
+                          (value >> (LimbBitSize - offset));
+    }
+}
+
+/// `a >>= bits` for \p n limbs
+inline void shrBitsInPlace(Limb* a, std::size_t n, std::size_t bits) {
+    std::size_t const limbShift = std::min(bits / LimbBitSize, n);
+    if (limbShift > 0) {
+        std::memmove(a, a + limbShift, (n - limbShift) * LimbSize);
+        std::memset(a + n - limbShift, 0, limbShift * LimbSize);
+    }
+    shrLimbs(a, a, n - limbShift, bits % LimbBitSize);
+}
+
+/// `a <<= bits` for \p n limbs. Bits shifted out of the top limb are lost
+inline void shlBitsInPlace(Limb* a, std::size_t n, std::size_t bits) {
+    std::size_t const limbShift = std::min(bits / LimbBitSize, n);
+    if (limbShift > 0) {
+        std::memmove(a + limbShift, a, (n - limbShift) * LimbSize);
+        std::memset(a, 0, limbShift * LimbSize);
+    }
+    shlLimbs(a + limbShift,
+             a + limbShift,
+             n - limbShift,
+             static_cast<unsigned>(bits % LimbBitSize));
+}
+
+/// Funnel shift left: `r` is the high half of the concatenation `hi:lo` of
+/// two \p bitwidth bit integers shifted left by \p s with `0 < s < bitwidth`.
+/// \p r may alias \p hi or \p lo
+inline void fshlLimbs(Limb* r,
+                      Limb const* hi,
+                      Limb const* lo,
+                      std::size_t bitwidth,
+                      std::size_t s) {
+    assert(0 < s && s < bitwidth);
+    std::size_t const n = ceilDiv(bitwidth, LimbBitSize);
+    ScratchLimbs<4> low(n);
+    std::memcpy(low.data(), lo, n * LimbSize);
+    shrBitsInPlace(low.data(), n, bitwidth - s);
+    std::memmove(r, hi, n * LimbSize);
+    shlBitsInPlace(r, n, s);
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] |= low[i];
+    }
+    r[n - 1] &= lowBitMask(bitwidth - (n - 1) * LimbBitSize);
+}
+
+/// `q = a / d` for \p n limbs of \p a. \p q may alias \p a
+/// \Returns the remainder
+inline Limb divremLimb(Limb* q, Limb const* a, std::size_t n, Limb d) {
+    assert(d != 0);
+    Limb rem = 0;
+    for (std::size_t i = n; i > 0;) {
+        --i;
+        q[i] = divWide(rem, a[i], d, rem);
+    }
+    return rem;
+}
+
+/// \Returns `a % d` for \p n limbs of \p a
+inline Limb remLimb(Limb const* a, std::size_t n, Limb d) {
+    assert(d != 0);
+    Limb rem = 0;
+    for (std::size_t i = n; i > 0;) {
+        --i;
+        divWide(rem, a[i], d, rem);
+    }
+    return rem;
+}
+
+/// Knuth's algorithm D.
+/// Computes `q = u / v` and `r = u % v` where \p u has \p m limbs and \p v
+/// has \p n limbs with `m >= n` and `v[n - 1] != 0`. \p q must have
+/// `m - n + 1` limbs and \p r must have \p n limbs. \p q and \p r may be null
+/// if the respective result is not needed. No buffer may alias another.
+inline void divremKnuth(Limb* q,
+                        Limb* r,
+                        Limb const* u,
+                        std::size_t m,
+                        Limb const* v,
+                        std::size_t n) {
+    assert(n > 0 && m >= n && v[n - 1] != 0);
+    if (n == 1) {
+        ScratchLimbs<8> qs(q ? 0 : m);
+        Limb const rem = divremLimb(q ? q : qs.data(), u, m, v[0]);
+        if (r) {
+            r[0] = rem;
+        }
+        return;
+    }
+    unsigned const s = static_cast<unsigned>(std::countl_zero(v[n - 1]));
+    ScratchLimbs<16> vn(n);
+    ScratchLimbs<32> un(m + 1);
+    shlLimbs(vn.data(), v, n, s);
+    un[m] = shlLimbs(un.data(), u, m, s);
+    Limb const vTop = vn[n - 1];
+    Limb const vNext = vn[n - 2];
+    for (std::size_t j = m - n + 1; j > 0;) {
+        --j;
+        Limb qhat;
+        Limb rhat;
+        bool rhatOverflow = false;
+        if (un[j + n] >= vTop) {
+            qhat = LimbMax;
+            rhat = un[j + n - 1] + vTop;
+            rhatOverflow = rhat < vTop;
+        }
+        else {
+            qhat = divWide(un[j + n], un[j + n - 1], vTop, rhat);
+        }
+        while (!rhatOverflow) {
+            Limb const pHi = mulHi(qhat, vNext);
+            Limb const pLo = qhat * vNext;
+            if (pHi < rhat || (pHi == rhat && pLo <= un[j + n - 2])) {
+                break;
+            }
+            --qhat;
+            rhat += vTop;
+            rhatOverflow = rhat < vTop;
+        }
+        Limb const borrow = mulSubLimb(un.data() + j, vn.data(), n, qhat);
+        Limb const top = un[j + n];
+        un[j + n] = top - borrow;
+        if (top < borrow) {
+            --qhat;
+            un[j + n] += addLimbs(un.data() + j, un.data() + j, vn.data(), n);
+        }
+        if (q) {
+            q[j] = qhat;
+        }
+    }
+    if (r) {
+        shrLimbs(r, un.data(), n, s);
+    }
+}
+
+} // namespace APMath::internal
+
+#endif // APMATH_LIMBOPS_H_
@@ -0,0 +1,200 @@
+#include "Multiply.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+/// `r = |x - y|` where \p x has \p nx limbs and \p y has \p ny limbs and \p r
+/// has `n >= max(nx, ny)` limbs
+/// \Returns `true` if `x < y`
+static bool absDiff(Limb* r,
+                    Limb const* x,
+                    size_t nx,
+                    Limb const* y,
+                    size_t ny,
+                    size_t n) {
+    std::memcpy(r, x, nx * LimbSize);
+    std::memset(r + nx, 0, (n - nx) * LimbSize);
+    Limb const borrow = subLimbs(r, r, y, ny);
+    if (decrementLimbs(r + ny, n - ny, borrow) == 0) {
+        return false;
+    }
+    /// Two's complement negation
+    Limb carry = 1;
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = ~r[i] + carry;
+        carry &= r[i] == 0;
+    }
+    return true;
+}
+
+/// Number of scratch limbs used by `karatsuba()` for operands of \p n limbs
+static size_t karatsubaScratchSize(size_t n) {
+    size_t size = 0;
+    while (n >= KaratsubaThreshold) {
+        size_t const l = n - n / 2;
+        size += 6 * l + 1;
+        n = l;
+    }
+    return size;
+}
+
+/// Adds the middle term `z0 + z2 +- t` of the Karatsuba product at offset \p h
+/// of \p r, which holds `z2 * B^2h + z0`. \p mid is scratch space of `2l + 1`
+/// limbs.
+static void karatsubaCombine(Limb* r,
+                             Limb const* t,
+                             Limb* mid,
+                             size_t h,
+                             size_t l,
+                             bool negative) {
+    /// `mid` is non-negative and fits into `2l + 1` limbs
+    std::memcpy(mid, r + 2 * h, 2 * l * LimbSize);
+    Limb carry = addLimbs(mid, mid, r, 2 * h);
+    mid[2 * l] = addLimb(mid + 2 * h, mid + 2 * h, 2 * (l - h), carry);
+    if (negative) {
+        mid[2 * l] -= subLimbs(mid, mid, t, 2 * l);
+    }
+    else {
+        mid[2 * l] += addLimbs(mid, mid, t, 2 * l);
+    }
+    carry = addLimbs(r + h, r + h, mid, 2 * l + 1);
+    addLimb(r + h + 2 * l + 1, r + h + 2 * l + 1, h - 1, carry);
+}
+
+/// Karatsuba step with the three half sized products computed in parallel
+static void karatsubaParallel(Limb* r, Limb const* a, Limb const* b, size_t n) {
+    size_t const h = n / 2;
+    size_t const l = n - h;
+    ScratchLimbs<1> buffer(6 * l + 1);
+    Limb* const da = buffer.data();
+    Limb* const db = da + l;
+    Limb* const t = db + l;
+    Limb* const mid = t + 2 * l;
+    bool const negA = absDiff(da, a, h, a + h, l, l);
+    bool const negB = absDiff(db, b + h, l, b, h, l);
+    TaskGroup group;
+    group.run([=] { mulKaratsuba(r, a, b, h); });
+    group.run([=] { mulKaratsuba(r + 2 * h, a + h, b + h, l); });
+    mulKaratsuba(t, da, db, l);
+    group.wait();
+    karatsubaCombine(r, t, mid, h, l, negA != negB);
+}
+
+/// Splits the operands into `a = a1 * B^h + a0` and `b = b1 * B^h + b0` and
+/// computes `a * b = z2 * B^2h + (z0 + z2 + (a0 - a1)(b1 - b0)) * B^h + z0`
+/// with `z0 = a0 * b0` and `z2 = a1 * b1`, i.e. three half sized products
+static void karatsuba(Limb* r,
+                      Limb const* a,
+                      Limb const* b,
+                      size_t n,
+                      Limb* scratch) {
+    if (n < KaratsubaThreshold) {
+        mulSchoolbook(r, a, n, b, n);
+        return;
+    }
+    if (shouldParallelize(n)) {
+        karatsubaParallel(r, a, b, n);
+        return;
+    }
+    size_t const h = n / 2;
+    size_t const l = n - h;
+    karatsuba(r, a, b, h, scratch);
+    karatsuba(r + 2 * h, a + h, b + h, l, scratch);
+    Limb* const da = scratch;
+    Limb* const db = da + l;
+    Limb* const t = db + l;
+    Limb* const mid = t + 2 * l;
+    Limb* const child = mid + 2 * l + 1;
+    bool const negA = absDiff(da, a, h, a + h, l, l);
+    bool const negB = absDiff(db, b + h, l, b, h, l);
+    karatsuba(t, da, db, l, child);
+    karatsubaCombine(r, t, mid, h, l, negA != negB);
+}
+
+void internal::mulKaratsuba(Limb* r, Limb const* a, Limb const* b, size_t n) {
+    ScratchLimbs<32> scratch(karatsubaScratchSize(n));
+    karatsuba(r, a, b, n, scratch.data());
+}
+
+void internal::mulLimbs(Limb* r,
+                        Limb const* a,
+                        size_t na,
+                        Limb const* b,
+                        size_t nb) {
+    assert(na > 0 && nb > 0);
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb < KaratsubaThreshold) {
+        mulSchoolbook(r, a, na, b, nb);
+        return;
+    }
+    if (nb >= NTTThreshold) {
+        mulNTT(r, a, na, b, nb);
+        return;
+    }
+    if (na == nb) {
+        mulKaratsuba(r, a, b, nb);
+        return;
+    }
+    /// Unbalanced operands are multiplied in chunks of `nb` limbs of `a`. Every
+    /// chunk product ends above all previously written limbs, so its carry
+    /// goes into a limb that is still zero.
+    ScratchLimbs<32> tmp(2 * nb);
+    std::memset(r, 0, (na + nb) * LimbSize);
+    for (size_t i = 0; i < na; i += nb) {
+        size_t const len = std::min(nb, na - i);
+        mulLimbs(tmp.data(), a + i, len, b, nb);
+        Limb const carry = addLimbs(r + i, r + i, tmp.data(), len + nb);
+        if (i + len + nb < na + nb) {
+            r[i + len + nb] = carry;
+        }
+        else {
+            assert(carry == 0);
+        }
+    }
+}
+
+void internal::mulLimbsLow(Limb* r,
+                           Limb const* a,
+                           size_t na,
+                           Limb const* b,
+                           size_t nb,
+                           size_t n) {
+    na = normalizedSize(a, std::min(na, n));
+    nb = normalizedSize(b, std::min(nb, n));
+    if (na == 0 || nb == 0) {
+        std::memset(r, 0, n * LimbSize);
+        return;
+    }
+    if (na + nb <= n) {
+        mulLimbs(r, a, na, b, nb);
+        std::memset(r + na + nb, 0, (n - na - nb) * LimbSize);
+        return;
+    }
+    /// The truncated schoolbook product does about half the work of the full
+    /// one, so it stays competitive for somewhat larger operands
+    if (std::min(na, nb) < 2 * KaratsubaThreshold) {
+        std::memset(r, 0, n * LimbSize);
+        for (size_t j = 0; j < nb; ++j) {
+            size_t const len = std::min(na, n - j);
+            Limb const carry = mulAddLimb(r + j, a, len, b[j]);
+            if (j + len < n) {
+                r[j + len] = carry;
+            }
+        }
+        return;
+    }
+    ScratchLimbs<32> full(na + nb);
+    mulLimbs(full.data(), a, na, b, nb);
+    std::memcpy(r, full.data(), n * LimbSize);
+}
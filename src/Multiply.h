@@ -0,0 +1,51 @@
+#ifndef APMATH_MULTIPLY_H_
+#define APMATH_MULTIPLY_H_
+
+#include <cstddef>
+
+#include "LimbOps.h"
+
+/// Multiplication of limb buffers. Unlike the kernels in `LimbOps.h` these
+/// functions select an algorithm based on the operand sizes and may allocate
+/// scratch memory.
+
+namespace APMath::internal {
+
+/// Operand size in limbs from which on Karatsuba multiplication is used
+inline constexpr std::size_t KaratsubaThreshold = 32;
+
+/// Operand size in limbs from which on the number theoretic transform is used
+inline constexpr std::size_t NTTThreshold = 4096;
+
+/// `r = a * b`. \p r must have `na + nb` limbs and must not alias the
+/// operands. \p a and \p b may be the same buffer.
+void mulLimbs(Limb* r,
+              Limb const* a,
+              std::size_t na,
+              Limb const* b,
+              std::size_t nb);
+
+/// `r = a * b mod 2^(n * LimbBitSize)`. \p r must have \p n limbs and must not
+/// alias the operands.
+void mulLimbsLow(Limb* r,
+                 Limb const* a,
+                 std::size_t na,
+                 Limb const* b,
+                 std::size_t nb,
+                 std::size_t n);
+
+/// `r = a * b` using Karatsuba's algorithm for equally sized operands. \p r
+/// must have `2 * n` limbs and must not alias the operands.
+void mulKaratsuba(Limb* r, Limb const* a, Limb const* b, std::size_t n);
+
+/// `r = a * b` using a number theoretic transform over three 64 bit primes.
+/// \p r must have `na + nb` limbs and must not alias the operands.
+void mulNTT(Limb* r,
+            Limb const* a,
+            std::size_t na,
+            Limb const* b,
+            std::size_t nb);
+
+} // namespace APMath::internal
+
+#endif // APMATH_MULTIPLY_H_
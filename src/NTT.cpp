@@ -0,0 +1,297 @@
+#include "Multiply.h"
+#include "ThreadPool.h"
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+namespace {
+
+/// Arithmetic modulo a prime `p < 2^62` in Montgomery form with `R = 2^64`
+class PrimeField {
+public:
+    PrimeField(Limb p, Limb generator): p(p), pInv(inverse2Adic(p)) {
+        divWide(1, 0, p, r1);
+        divWide(mulHi(r1, r1), r1 * r1, p, r2);
+        g = toMont(generator);
+    }
+
+    Limb modulus() const { return p; }
+
+    Limb toMont(Limb a) const { return mul(a % p, r2); }
+
+    Limb fromMont(Limb a) const { return mul(a, 1); }
+
+    Limb one() const { return r1; }
+
+    Limb add(Limb a, Limb b) const {
+        Limb const s = a + b;
+        return s >= p ? s - p : s;
+    }
+
+    Limb sub(Limb a, Limb b) const { return a >= b ? a - b : a + p - b; }
+
+    /// `a * b / R mod p`. Since `m * p` agrees with `a * b` in the low limb, the
+    /// result is the difference of the high limbs.
+    Limb mul(Limb a, Limb b) const {
+        Limb const lo = a * b;
+        Limb const hi = mulHi(a, b);
+        Limb const mh = mulHi(lo * pInv, p);
+        return hi >= mh ? hi - mh : hi - mh + p;
+    }
+
+    Limb pow(Limb a, Limb e) const {
+        Limb r = one();
+        for (; e != 0; e >>= 1) {
+            if (e & 1) {
+                r = mul(r, a);
+            }
+            a = mul(a, a);
+        }
+        return r;
+    }
+
+    Limb inverse(Limb a) const { return pow(a, p - 2); }
+
+    /// \Returns a primitive `2^logN`-th root of unity in Montgomery form
+    Limb rootOfUnity(unsigned logN) const {
+        assert(((p - 1) >> logN) << logN == p - 1);
+        return pow(g, (p - 1) >> logN);
+    }
+
+private:
+    Limb p;
+    Limb pInv;
+    Limb r1;
+    Limb r2;
+    Limb g;
+};
+
+/// Primes of the form `c * 2^k + 1` with `k >= 55` and their primitive roots.
+/// Their product exceeds `2^183`, which bounds every coefficient of the
+/// convolution of two limb sequences of length below `2^55`.
+constexpr size_t NumPrimes = 3;
+constexpr std::array<std::pair<Limb, Limb>, NumPrimes> NTTPrimes = { {
+    { 29 * (Limb(1) << 57) + 1, 3 },
+    { 69 * (Limb(1) << 55) + 1, 5 },
+    { 27 * (Limb(1) << 56) + 1, 5 },
+} };
+constexpr unsigned MaxLogLength = 55;
+
+/// Constants for Garner's CRT recombination
+struct CRT {
+    std::array<PrimeField, NumPrimes> fields;
+    /// `p0 mod p1` and `p0 mod p2`
+    Limb p0Mod1, p0Mod2;
+    /// `p0^-1 mod p1` and `(p0 * p1)^-1 mod p2` in Montgomery form
+    Limb inv0Mod1, inv01Mod2;
+    /// `p0 * p1` as two limbs
+    Limb p01Lo, p01Hi;
+
+    CRT():
+        fields{ PrimeField(NTTPrimes[0].first, NTTPrimes[0].second),
+                PrimeField(NTTPrimes[1].first, NTTPrimes[1].second),
+                PrimeField(NTTPrimes[2].first, NTTPrimes[2].second) } {
+        Limb const p0 = fields[0].modulus();
+        Limb const p1 = fields[1].modulus();
+        auto& F1 = fields[1];
+        auto& F2 = fields[2];
+        p0Mod1 = F1.toMont(p0);
+        p0Mod2 = F2.toMont(p0);
+        inv0Mod1 = F1.inverse(p0Mod1);
+        inv01Mod2 = F2.inverse(F2.mul(p0Mod2, F2.toMont(p1)));
+        p01Lo = p0 * p1;
+        p01Hi = mulHi(p0, p1);
+    }
+
+    /// Recombines the residues \p x0, \p x1, \p x2 (in normal form) into the
+    /// three limb value \p v
+    void recombine(Limb x0, Limb x1, Limb x2, Limb* v) const {
+        auto& F1 = fields[1];
+        auto& F2 = fields[2];
+        /// `y1 = (x1 - y0) / p0 mod p1` with `y0 = x0`
+        Limb const y1 = F1.mul(F1.sub(x1, x0 % F1.modulus()), inv0Mod1);
+        /// `y2 = (x2 - y0 - y1 * p0) / (p0 * p1) mod p2`
+        Limb const t = F2.add(x0 % F2.modulus(), F2.mul(y1, p0Mod2));
+        Limb const y2 = F2.mul(F2.sub(x2, t), inv01Mod2);
+        /// `v = y0 + y1 * p0 + y2 * p0 * p1`
+        Limb const p0 = fields[0].modulus();
+        Limb lo = y1 * p0;
+        Limb mid = mulHi(y1, p0);
+        lo += x0;
+        mid += lo < x0;
+        Limb const w0 = y2 * p01Lo;
+        Limb w1 = mulHi(y2, p01Lo);
+        Limb const w1b = y2 * p01Hi;
+        w1 += w1b;
+        Limb hi = mulHi(y2, p01Hi) + (w1 < w1b);
+        v[0] = lo + w0;
+        Limb carry = v[0] < w0;
+        v[1] = mid + w1;
+        Limb const c1 = v[1] < w1;
+        v[1] += carry;
+        carry = c1 | (v[1] < carry);
+        v[2] = hi + carry;
+    }
+};
+
+CRT const& crt() {
+    static CRT const instance;
+    return instance;
+}
+
+/// Fills \p roots with `roots[h + j] = w_2h^j` for all powers of two
+/// `h < n`, where `w_2h` is a primitive `2h`-th root of unity
+void computeRoots(PrimeField const& F, Limb* roots, size_t n, bool inverse) {
+    unsigned const logN = static_cast<unsigned>(std::countr_zero(n));
+    Limb w = F.rootOfUnity(logN);
+    if (inverse) {
+        w = F.inverse(w);
+    }
+    size_t const h = n / 2;
+    roots[h] = F.one();
+    for (size_t j = 1; j < h; ++j) {
+        roots[h + j] = F.mul(roots[h + j - 1], w);
+    }
+    for (size_t k = h / 2; k > 0; k /= 2) {
+        for (size_t j = 0; j < k; ++j) {
+            roots[k + j] = roots[2 * (k + j)];
+        }
+    }
+}
+
+/// Decimation in frequency transform. Leaves the result in bit reversed order.
+void forward(PrimeField const& F, Limb* a, size_t n, Limb const* roots) {
+    for (size_t len = n; len >= 2; len /= 2) {
+        size_t const h = len / 2;
+        for (size_t s = 0; s < n; s += len) {
+            for (size_t j = 0; j < h; ++j) {
+                Limb const u = a[s + j];
+                Limb const v = a[s + j + h];
+                a[s + j] = F.add(u, v);
+                a[s + j + h] = F.mul(F.sub(u, v), roots[h + j]);
+            }
+        }
+    }
+}
+
+/// Decimation in time transform with inverse roots. Expects its input in bit
+/// reversed order and leaves `n` times the inverse transform.
+void inverse(PrimeField const& F, Limb* a, size_t n, Limb const* roots) {
+    for (size_t len = 2; len <= n; len *= 2) {
+        size_t const h = len / 2;
+        for (size_t s = 0; s < n; s += len) {
+            for (size_t j = 0; j < h; ++j) {
+                Limb const u = a[s + j];
+                Limb const v = F.mul(a[s + j + h], roots[h + j]);
+                a[s + j] = F.add(u, v);
+                a[s + j + h] = F.sub(u, v);
+            }
+        }
+    }
+}
+
+void load(PrimeField const& F, Limb* f, Limb const* a, size_t na, size_t n) {
+    for (size_t i = 0; i < na; ++i) {
+        f[i] = F.toMont(a[i]);
+    }
+    std::memset(f + na, 0, (n - na) * LimbSize);
+}
+
+/// Computes the cyclic convolution of \p a and \p b modulo the prime of \p F
+/// into \p fa in normal form. \p fb is scratch space.
+void convolve(PrimeField const& F,
+              Limb* fa,
+              Limb* fb,
+              Limb* roots,
+              Limb const* a,
+              size_t na,
+              Limb const* b,
+              size_t nb,
+              size_t n) {
+    bool const square = a == b && na == nb;
+    computeRoots(F, roots, n, false);
+    load(F, fa, a, na, n);
+    forward(F, fa, n, roots);
+    if (square) {
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = F.mul(fa[i], fa[i]);
+        }
+    }
+    else {
+        load(F, fb, b, nb, n);
+        forward(F, fb, n, roots);
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = F.mul(fa[i], fb[i]);
+        }
+    }
+    computeRoots(F, roots, n, true);
+    inverse(F, fa, n, roots);
+    /// Multiplying the Montgomery form of `n * c` by `n^-1` in normal form
+    /// yields `c` in normal form
+    Limb const nInv = F.fromMont(F.inverse(F.toMont(n)));
+    for (size_t i = 0; i < n; ++i) {
+        fa[i] = F.mul(fa[i], nInv);
+    }
+}
+
+} // namespace
+
+void internal::mulNTT(Limb* r,
+                      Limb const* a,
+                      size_t na,
+                      Limb const* b,
+                      size_t nb) {
+    assert(na > 0 && nb > 0);
+    size_t const numCoeffs = na + nb - 1;
+    size_t const n = std::bit_ceil(numCoeffs);
+    assert(std::countr_zero(n) <= int(MaxLogLength) && "Operands too large");
+    CRT const& C = crt();
+    /// The residues modulo the primes are computed in parallel, each task needs
+    /// its own scratch space then. Otherwise they are computed one after
+    /// another on this thread and share the scratch space, so they must not
+    /// be submitted to the pool even if one exists.
+    bool const parallel = shouldParallelize(nb);
+    size_t const numScratch = parallel ? NumPrimes : 1;
+    ScratchLimbs<1> buffer((NumPrimes + 2 * numScratch) * n);
+    Limb* const residues = buffer.data();
+    auto residue = [=, &C](size_t i) {
+        Limb* const fb = residues + (NumPrimes + 2 * (i % numScratch)) * n;
+        Limb* const roots = fb + n;
+        convolve(C.fields[i], residues + i * n, fb, roots, a, na, b, nb, n);
+    };
+    if (parallel) {
+        TaskGroup group;
+        for (size_t i = 0; i < NumPrimes; ++i) {
+            group.run([=] { residue(i); });
+        }
+        group.wait();
+    }
+    else {
+        for (size_t i = 0; i < NumPrimes; ++i) {
+            residue(i);
+        }
+    }
+    /// Carry propagation of the recombined coefficients
+    Limb acc[3] = {};
+    for (size_t k = 0; k < numCoeffs; ++k) {
+        Limb v[3];
+        C.recombine(residues[k], residues[n + k], residues[2 * n + k], v);
+        Limb const carry = addLimbs(acc, acc, v, 3);
+        assert(carry == 0);
+        (void)carry;
+        r[k] = acc[0];
+        acc[0] = acc[1];
+        acc[1] = acc[2];
+        acc[2] = 0;
+    }
+    r[numCoeffs] = acc[0];
+    assert(acc[1] == 0);
+}
@@ -0,0 +1,566 @@
+#include <APMath/APInt.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "Divide.h"
+#include "LimbOps.h"
+#include "Multiply.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+/// Up to this number of limbs `gcd()` uses the binary algorithm, above it uses
+/// Lehmer's algorithm
+static constexpr size_t BinaryGCDThreshold = 2;
+
+/// Stein's binary GCD on single limbs
+static Limb gcdLimb(Limb a, Limb b) {
+    if (a == 0) {
+        return b;
+    }
+    if (b == 0) {
+        return a;
+    }
+    int const shift = std::countr_zero(a | b);
+    a >>= std::countr_zero(a);
+    do {
+        b >>= std::countr_zero(b);
+        if (a > b) {
+            std::swap(a, b);
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+/// Binary GCD of \p a and \p b with \p n limbs each. The result is written to
+/// \p a, \p b is clobbered.
+static void binaryGCD(Limb* a, Limb* b, size_t n) {
+    Limb* const result = a;
+    size_t na = normalizedSize(a, n);
+    size_t nb = normalizedSize(b, n);
+    if (na == 0) {
+        std::memcpy(a, b, n * LimbSize);
+        return;
+    }
+    if (nb == 0) {
+        return;
+    }
+    size_t const za = ctzLimbs(a, na);
+    size_t const zb = ctzLimbs(b, nb);
+    shrBitsInPlace(a, na, za);
+    shrBitsInPlace(b, nb, zb);
+    while (true) {
+        /// Both `a` and `b` are odd here
+        na = normalizedSize(a, na);
+        nb = normalizedSize(b, nb);
+        if (na == 1 && nb == 1) {
+            a[0] = gcdLimb(a[0], b[0]);
+            break;
+        }
+        int const c = cmpLimbs(a, na, b, nb);
+        if (c == 0) {
+            break;
+        }
+        if (c < 0) {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        Limb const borrow = subLimbs(a, a, b, nb);
+        subLimb(a + nb, a + nb, na - nb, borrow);
+        na = normalizedSize(a, na);
+        shrBitsInPlace(a, na, ctzLimbs(a, na));
+    }
+    if (a != result) {
+        std::memcpy(result, a, na * LimbSize);
+    }
+    std::memset(result + na, 0, (n - na) * LimbSize);
+    shlBitsInPlace(result, n, std::min(za, zb));
+}
+
+namespace {
+
+/// Cosequence computed by `lehmerSimulate()`
+struct LehmerCosequence {
+    Limb u0, u1, v0, v1;
+    /// `true` if an odd number of quotients has been simulated, i.e. the
+    /// cosequence `(u0, v0)` has an even index
+    bool even;
+};
+
+/// Euclidean remainder sequence on limb buffers with optional tracking of the
+/// Bezout coefficients.
+///
+/// `a` and `b` hold the current remainders `r_i` and `r_i+1` of the original
+/// operands `a0` and `b0`, such that `r_i = s_i * a0 + t_i * b0`. The signs of
+/// the coefficients alternate with `i`, so only their magnitudes are stored in
+/// `sa`, `sb`, `ta` and `tb`: `s_i = (-1)^i * sa` and `t_i = (-1)^(i+1) * ta`.
+class Euclid {
+public:
+    Euclid(Limb const* a0,
+           size_t na0,
+           Limb const* b0,
+           size_t nb0,
+           bool trackS,
+           bool trackT):
+        n(std::max(na0, nb0)),
+        trackS(trackS),
+        trackT(trackT),
+        buffer((n + 1) * 8) {
+        Limb* p = buffer.data();
+        for (Limb** ptr: { &a, &b, &tmp0, &tmp1, &sa, &sb, &ta, &tb }) {
+            *ptr = p;
+            p += n + 1;
+        }
+        std::memset(buffer.data(), 0, buffer.size() * LimbSize);
+        std::memcpy(a, a0, na0 * LimbSize);
+        std::memcpy(b, b0, nb0 * LimbSize);
+        sa[0] = 1;
+        tb[0] = 1;
+    }
+
+    /// Runs the algorithm until the second remainder is zero.
+    void run() {
+        while (true) {
+            size_t const na = normalizedSize(a, n);
+            size_t const nb = normalizedSize(b, n);
+            if (nb == 0) {
+                return;
+            }
+            if (nb >= 2 && na == nb && cmpLimbs(a, b, na) >= 0) {
+                auto const seq = lehmerSimulate(na);
+                if (seq.v0 != 0) {
+                    lehmerUpdate(seq);
+                    continue;
+                }
+            }
+            euclidStep(na, nb);
+        }
+    }
+
+    Limb const* gcd() const { return a; }
+
+    /// \Returns `true` if the first Bezout coefficient is negative
+    bool sNegative() const { return parity; }
+
+    /// \Returns `true` if the second Bezout coefficient is negative
+    bool tNegative() const { return !parity; }
+
+    Limb const* sMagnitude() const { return sa; }
+
+    Limb const* tMagnitude() const { return ta; }
+
+private:
+    /// Reads the leading `sizeof(DWord)` bytes of \p x with \p na limbs after
+    /// shifting left by \p shift bits
+    template <typename DWord>
+    DWord topBits(Limb const* x, size_t na, unsigned shift) const {
+        DWord result = 0;
+        constexpr size_t Words = sizeof(DWord) / LimbSize;
+        for (size_t i = 0; i < Words; ++i) {
+            result <<= Words > 1 ? LimbBitSize : 0;
+            size_t const index = na - 1 - i;
+            Limb const hi = i < na ? x[index] : 0;
+            Limb const lo = i + 1 < na ? x[index - 1] : 0;
+            result |= shift == 0 ? hi :
+                                   hi << shift | lo >> (LimbBitSize - shift);
+        }
+        return result;
+    }
+
+    /// Lehmer's simulation of the Euclidean algorithm on the leading digits of
+    /// `a` and `b` with Collins' stopping condition (Jebelean's exact
+    /// variant). With a double-width `DWord` the leading two limbs are used
+    /// ("double-digit" Lehmer), which yields cofactors of up to a full limb per
+    /// step.
+    template <typename DWord>
+    LehmerCosequence lehmerSimulateImpl(size_t na) const {
+        unsigned const shift =
+            static_cast<unsigned>(std::countl_zero(a[na - 1]));
+        DWord a1 = topBits<DWord>(a, na, shift);
+        DWord a2 = topBits<DWord>(b, na, shift);
+        DWord u0 = 0, u1 = 1, u2 = 0;
+        DWord v0 = 0, v1 = 0, v2 = 1;
+        bool even = false;
+        while (a2 >= v2 && a1 - a2 >= v1 && a1 - a2 - v1 >= v2) {
+            DWord const q = a1 / a2;
+            /// Cofactors must fit into a single limb
+            if (u2 != 0 && q > (LimbMax - u1) / u2) {
+                break;
+            }
+            if (q > (LimbMax - v1) / v2) {
+                break;
+            }
+            DWord const r = a1 - q * a2;
+            a1 = a2;
+            a2 = r;
+            DWord const u3 = u1 + q * u2;
+            DWord const v3 = v1 + q * v2;
+            u0 = u1;
+            u1 = u2;
+            u2 = u3;
+            v0 = v1;
+            v1 = v2;
+            v2 = v3;
+            even = !even;
+        }
+        return { static_cast<Limb>(u0),
+                 static_cast<Limb>(u1),
+                 static_cast<Limb>(v0),
+                 static_cast<Limb>(v1),
+                 even };
+    }
+
+    LehmerCosequence lehmerSimulate(size_t na) const {
+#if defined(__SIZEOF_INT128__)
+        return lehmerSimulateImpl<unsigned __int128>(na);
+#else
+        return lehmerSimulateImpl<Limb>(na);
+#endif
+    }
+
+    /// `r = cx * x - cy * y` where the result is known to be non-negative
+    void linComb(Limb* r, Limb const* x, Limb cx, Limb const* y, Limb cy) {
+        r[n] = mulLimb(r, x, n, cx);
+        r[n] -= mulSubLimb(r, y, n, cy);
+        assert(r[n] == 0);
+    }
+
+    /// `r = cx * x + cy * y`
+    void addComb(Limb* r, Limb const* x, Limb cx, Limb const* y, Limb cy) {
+        r[n] = mulLimb(r, x, n, cx);
+        r[n] += mulAddLimb(r, y, n, cy);
+    }
+
+    void lehmerUpdate(LehmerCosequence const& seq) {
+        auto [u0, u1, v0, v1, even] = seq;
+        if (even) {
+            linComb(tmp0, a, u0, b, v0);
+            linComb(tmp1, b, v1, a, u1);
+        }
+        else {
+            linComb(tmp0, b, v0, a, u0);
+            linComb(tmp1, a, u1, b, v1);
+        }
+        std::swap(a, tmp0);
+        std::swap(b, tmp1);
+        if (trackS) {
+            addComb(tmp0, sa, u0, sb, v0);
+            addComb(tmp1, sa, u1, sb, v1);
+            std::swap(sa, tmp0);
+            std::swap(sb, tmp1);
+        }
+        if (trackT) {
+            addComb(tmp0, ta, u0, tb, v0);
+            addComb(tmp1, ta, u1, tb, v1);
+            std::swap(ta, tmp0);
+            std::swap(tb, tmp1);
+        }
+        /// The new first remainder is `r_(i + k - 1)` after `k` quotients and
+        /// `even` is set if `k` is odd
+        parity ^= !even;
+    }
+
+    /// Single step of the Euclidean algorithm with a full division
+    void euclidStep(size_t na, size_t nb) {
+        size_t const nq = na >= nb ? na - nb + 1 : 0;
+        ScratchLimbs<16> q(std::max<size_t>(nq, 1));
+        if (nq > 0) {
+            divremLimbs(q.data(), tmp0, a, na, b, nb);
+            std::memset(tmp0 + nb, 0, (n + 1 - nb) * LimbSize);
+        }
+        else {
+            std::memcpy(tmp0, a, (n + 1) * LimbSize);
+        }
+        std::swap(a, b);
+        std::swap(b, tmp0);
+        if (nq > 0) {
+            if (trackS) {
+                cofactorStep(sa, sb, q.data(), nq);
+            }
+            if (trackT) {
+                cofactorStep(ta, tb, q.data(), nq);
+            }
+        }
+        else {
+            std::swap(sa, sb);
+            std::swap(ta, tb);
+        }
+        parity = !parity;
+    }
+
+    /// `(x, y) = (y, x + q * y)`
+    void cofactorStep(Limb*& x, Limb*& y, Limb const* q, size_t nq) {
+        size_t const ny = normalizedSize(y, n + 1);
+        if (ny > 0) {
+            ScratchLimbs<32> prod(nq + ny);
+            mulLimbs(prod.data(), q, nq, y, ny);
+            size_t const np = normalizedSize(prod.data(), nq + ny);
+            assert(np <= n + 1);
+            Limb const carry = addLimbs(x, x, prod.data(), np);
+            addLimb(x + np, x + np, n + 1 - np, carry);
+        }
+        std::swap(x, y);
+    }
+
+    size_t n;
+    bool trackS, trackT;
+    bool parity = false;
+    ScratchLimbs<64> buffer;
+    Limb *a, *b, *tmp0, *tmp1, *sa, *sb, *ta, *tb;
+};
+
+} // namespace
+
+/// \Returns the signed value `negative ? -magnitude : magnitude` with
+/// \p bitwidth bits
+static APInt makeSigned(Limb const* magnitude,
+                        size_t n,
+                        bool negative,
+                        size_t bitwidth) {
+    APInt result(std::span<Limb const>(magnitude, n), bitwidth);
+    if (negative) {
+        result.negate();
+    }
+    return result;
+}
+
+APInt APMath::gcd(APInt const& a, APInt const& b) {
+    assert(a.bitwidth() == b.bitwidth());
+    size_t const n = APIntAccess::numLimbs(a);
+    if (n <= BinaryGCDThreshold) {
+        APInt result = a;
+        APInt tmp = b;
+        binaryGCD(APIntAccess::limbPtr(result), APIntAccess::limbPtr(tmp), n);
+        return result;
+    }
+    Euclid euclid(APIntAccess::limbPtr(a),
+                  n,
+                  APIntAccess::limbPtr(b),
+                  n,
+                  false,
+                  false);
+    euclid.run();
+    return APInt(std::span<Limb const>(euclid.gcd(), n), a.bitwidth());
+}
+
+std::tuple<APInt, APInt, APInt> APMath::egcd(APInt const& a, APInt const& b) {
+    assert(a.bitwidth() == b.bitwidth());
+    size_t const n = APIntAccess::numLimbs(a);
+    Euclid euclid(APIntAccess::limbPtr(a),
+                  n,
+                  APIntAccess::limbPtr(b),
+                  n,
+                  true,
+                  true);
+    euclid.run();
+    size_t const bw = a.bitwidth();
+    return { APInt(std::span<Limb const>(euclid.gcd(), n), bw),
+             makeSigned(euclid.sMagnitude(), n + 1, euclid.sNegative(), bw),
+             makeSigned(euclid.tMagnitude(), n + 1, euclid.tNegative(), bw) };
+}
+
+std::optional<APInt> APMath::modInverse(APInt const& a, APInt const& m) {
+    assert(a.bitwidth() == m.bitwidth());
+    if (m.none()) {
+        return std::nullopt;
+    }
+    size_t const n = APIntAccess::numLimbs(a);
+    Limb const* mp = APIntAccess::limbPtr(m);
+    size_t const nm = normalizedSize(mp, n);
+    /// Reduce `a` modulo `m` first so the remainders stay below `m`
+    ScratchLimbs<8> aRed(nm);
+    size_t const na = normalizedSize(APIntAccess::limbPtr(a), n);
+    if (na >= nm) {
+        divremLimbs(nullptr, aRed.data(), APIntAccess::limbPtr(a), na, mp, nm);
+    }
+    else {
+        std::memset(aRed.data(), 0, nm * LimbSize);
+        std::memcpy(aRed.data(), APIntAccess::limbPtr(a), na * LimbSize);
+    }
+    Euclid euclid(aRed.data(), nm, mp, nm, true, false);
+    euclid.run();
+    Limb const* g = euclid.gcd();
+    if (g[0] != 1 || normalizedSize(g, nm) != 1) {
+        return std::nullopt;
+    }
+    APInt result(std::span<Limb const>(euclid.sMagnitude(), nm), a.bitwidth());
+    if (euclid.sNegative() && result.any()) {
+        return APMath::sub(m, result);
+    }
+    return result;
+}
+
+APInt APMath::lcm(APInt const& a, APInt const& b) {
+    assert(a.bitwidth() == b.bitwidth());
+    if (a.none() || b.none()) {
+        return APInt(0, a.bitwidth());
+    }
+    APInt const g = APMath::gcd(a, b);
+    APInt const quotient = APMath::divExact(a, g);
+    return APMath::mul(quotient, b);
+}
+
+/// Integer square root of a single limb
+static Limb isqrtLimb(Limb a) {
+    Limb r = static_cast<Limb>(std::sqrt(static_cast<double>(a)));
+    /// Correct the rounding error of the floating point estimate
+    while (r > 0xFFFF'FFFF || r * r > a) {
+        --r;
+    }
+    while (r < 0xFFFF'FFFF && (r + 1) * (r + 1) <= a) {
+        ++r;
+    }
+    return r;
+}
+
+/// Writes the integer \p k th root of \p a to \p x using Newton's iteration
+/// `x' = ((k - 1) * x + a / x^(k - 1)) / k`, seeded with the power of two
+/// `2^ceil(bitwidth(a) / k)` derived from the leading zero count, which is
+/// guaranteed to be above the root. \p a has \p m limbs with `a[m - 1] != 0`
+/// and \p x must have `m + 2` limbs. Does not allocate for `m <= 4`.
+static void irootLimbs(Limb* x, Limb const* a, size_t m, unsigned k) {
+    assert(k >= 2);
+    size_t const L = m + 2;
+    size_t const bits =
+        m * LimbBitSize - static_cast<size_t>(std::countl_zero(a[m - 1]));
+    size_t const rootBits = ceilDiv(bits, k);
+    ScratchLimbs<32> buffer(2 * L + 2 * (2 * m + 2));
+    Limb* const y = buffer.data();
+    Limb* const q = y + L;
+    Limb* const pow = q + L;
+    Limb* const tmp = pow + 2 * m + 2;
+    std::memset(x, 0, L * LimbSize);
+    x[rootBits / LimbBitSize] = Limb(1) << rootBits % LimbBitSize;
+    while (true) {
+        size_t const nx = normalizedSize(x, L);
+        Limb const* divisor = x;
+        size_t nd = nx;
+        if (k > 2) {
+            std::memcpy(pow, x, nx * LimbSize);
+            /// Stop early once the power exceeds `a`, the quotient is zero then
+            for (unsigned i = 2; i < k && nd <= m; ++i) {
+                mulLimbs(tmp, pow, nd, x, nx);
+                nd = normalizedSize(tmp, nd + nx);
+                std::memcpy(pow, tmp, nd * LimbSize);
+            }
+            divisor = pow;
+        }
+        std::memset(q, 0, L * LimbSize);
+        if (nd <= m) {
+            divremLimbs(q, nullptr, a, m, divisor, nd);
+        }
+        mulLimb(y, x, L, k - 1);
+        addLimbs(y, y, q, L);
+        divremLimb(y, y, L, k);
+        if (cmpLimbs(y, x, L) >= 0) {
+            return;
+        }
+        std::memcpy(x, y, L * LimbSize);
+    }
+}
+
+APInt APMath::isqrt(APInt const& n) { return iroot(n, 2); }
+
+APInt APMath::iroot(APInt const& n, unsigned k) {
+    assert(k > 0);
+    Limb const* a = APIntAccess::limbPtr(n);
+    size_t const m = normalizedSize(a, APIntAccess::numLimbs(n));
+    if (m == 0 || k == 1) {
+        return n;
+    }
+    if (ilog2(n) < k) {
+        /// `1 <= n < 2^k`
+        return APInt(1, n.bitwidth());
+    }
+    if (m == 1 && k == 2) {
+        return APInt(isqrtLimb(a[0]), n.bitwidth());
+    }
+    ScratchLimbs<8> root(m + 2);
+    irootLimbs(root.data(), a, m, k);
+    return APInt(std::span<Limb const>(root.data(), m + 2), n.bitwidth());
+}
+
+size_t APMath::ilog2(APInt const& n) {
+    assert(n.any());
+    return n.bitwidth() - 1 - n.clz();
+}
+
+/// `r = base^e` where the result is known to fit into \p m limbs. \p tmp must
+/// have `2 * m` limbs.
+/// \Returns the number of limbs of the result
+static size_t powLimbs(Limb* r,
+                       Limb* tmp,
+                       Limb base,
+                       size_t e,
+                       [[maybe_unused]] size_t m) {
+    r[0] = 1;
+    size_t nr = 1;
+    for (size_t bit = std::bit_width(e); bit > 0;) {
+        --bit;
+        mulLimbs(tmp, r, nr, r, nr);
+        nr = normalizedSize(tmp, 2 * nr);
+        std::memcpy(r, tmp, nr * LimbSize);
+        if ((e >> bit) & 1) {
+            r[nr] = mulLimb(r, r, nr, base);
+            nr += r[nr] != 0;
+        }
+        assert(nr <= m);
+    }
+    return nr;
+}
+
+size_t APMath::ilog(APInt const& n, unsigned base) {
+    assert(base >= 2);
+    size_t const log2n = ilog2(n);
+    if (std::has_single_bit(base)) {
+        return log2n / static_cast<size_t>(std::countr_zero(base));
+    }
+    Limb const* a = APIntAccess::limbPtr(n);
+    size_t const m = normalizedSize(a, APIntAccess::numLimbs(n));
+    if (m == 1) {
+        size_t e = 0;
+        for (Limb v = a[0]; v >= base; v /= base) {
+            ++e;
+        }
+        return e;
+    }
+    /// Estimate the logarithm from the leading 64 bits and correct the
+    /// estimate with exact powers
+    unsigned const shift = static_cast<unsigned>(std::countl_zero(a[m - 1]));
+    Limb const top = a[m - 1] << shift |
+                     (shift == 0 ? 0 : a[m - 2] >> (LimbBitSize - shift));
+    double const log2Estimate =
+        static_cast<double>(log2n) +
+        std::log2(std::ldexp(static_cast<double>(top), 1 - int(LimbBitSize)));
+    size_t e = static_cast<size_t>(log2Estimate / std::log2(double(base)));
+    e = e > 0 ? e - 1 : 0;
+    ScratchLimbs<16> buffer(3 * m + 1);
+    Limb* p = buffer.data();
+    Limb* next = p + m + 1;
+    size_t np = powLimbs(p, next, base, e, m);
+    while (true) {
+        next[np] = mulLimb(next, p, np, base);
+        size_t const nn = np + (next[np] != 0);
+        if (cmpLimbs(next, nn, a, m) > 0) {
+            return e;
+        }
+        std::swap(p, next);
+        np = nn;
+        ++e;
+    }
+}
+
+size_t APMath::numDigits(APInt const& n, unsigned base) {
+    if (n.none()) {
+        return 1;
+    }
+    return ilog(n, base) + 1;
+}
@@ -0,0 +1,562 @@
+#include <APMath/APInt.h>
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Divide.h"
+#include "LimbOps.h"
+#include "Multiply.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+namespace {
+
+/// Montgomery arithmetic modulo an odd modulus `m` of `k` limbs with
+/// `R = 2^(64k)`. Values in Montgomery form are `k` limb buffers fully reduced
+/// modulo `m`. Results may alias operands.
+class Montgomery {
+public:
+    Montgomery(Limb const* m, size_t k):
+        m(m), k(k), mInv(-inverse2Adic(m[0])), t(k + 2) {
+        assert(k > 0 && m[k - 1] != 0 && m[0] % 2 == 1);
+    }
+
+    size_t size() const { return k; }
+
+    Limb const* modulus() const { return m; }
+
+    /// `r = a * R mod m` for \p a with \p na limbs
+    void toMont(Limb* r, Limb const* a, size_t na) {
+        ScratchLimbs<16> u(k + na);
+        std::memset(u.data(), 0, k * LimbSize);
+        std::memcpy(u.data() + k, a, na * LimbSize);
+        size_t const nu = normalizedSize(u.data(), k + na);
+        if (nu < k) {
+            std::memset(r, 0, k * LimbSize);
+            return;
+        }
+        divremLimbs(nullptr, r, u.data(), nu, m, k);
+    }
+
+    /// `r = a * R^-1 mod m`
+    void fromMont(Limb* r, Limb const* a) {
+        ScratchLimbs<8> one(k);
+        std::memset(one.data(), 0, k * LimbSize);
+        one[0] = 1;
+        mul(r, a, one.data());
+    }
+
+    /// `r = R mod m`, the Montgomery form of 1
+    void one(Limb* r) {
+        Limb const oneLimb = 1;
+        toMont(r, &oneLimb, 1);
+    }
+
+    /// `r = a * b * R^-1 mod m` (coarsely integrated operand scanning)
+    void mul(Limb* r, Limb const* a, Limb const* b) {
+        std::memset(t.data(), 0, (k + 2) * LimbSize);
+        for (size_t i = 0; i < k; ++i) {
+            accumulate(mulAddLimb(t.data(), a, k, b[i]));
+            Limb const q = t[0] * mInv;
+            accumulate(mulAddLimb(t.data(), m, k, q));
+            std::memmove(t.data(), t.data() + 1, (k + 1) * LimbSize);
+            t[k + 1] = 0;
+        }
+        if (t[k] != 0 || cmpLimbs(t.data(), m, k) >= 0) {
+            subLimbs(t.data(), t.data(), m, k);
+        }
+        std::memcpy(r, t.data(), k * LimbSize);
+    }
+
+    /// `r = a * a * R^-1 mod m`
+    void sqr(Limb* r, Limb const* a) { mul(r, a, a); }
+
+    /// `r = a + b mod m`
+    void add(Limb* r, Limb const* a, Limb const* b) {
+        Limb const carry = addLimbs(r, a, b, k);
+        if (carry || cmpLimbs(r, m, k) >= 0) {
+            subLimbs(r, r, m, k);
+        }
+    }
+
+    /// `r = a - b mod m`
+    void sub(Limb* r, Limb const* a, Limb const* b) {
+        if (subLimbs(r, a, b, k)) {
+            addLimbs(r, r, m, k);
+        }
+    }
+
+    /// `r = a / 2 mod m`
+    void half(Limb* r, Limb const* a) {
+        Limb carry = 0;
+        if (a[0] % 2 == 1) {
+            carry = addLimbs(r, a, m, k);
+        }
+        else {
+            std::memmove(r, a, k * LimbSize);
+        }
+        shrLimbs(r, r, k, 1);
+        r[k - 1] |= carry << (LimbBitSize - 1);
+    }
+
+    /// `r = b^e` in Montgomery form with a fixed window of 4 bits. \p b is in
+    /// Montgomery form and \p e has \p ne limbs.
+    void pow(Limb* r, Limb const* b, Limb const* e, size_t ne) {
+        constexpr size_t WindowBits = 4;
+        std::vector<Limb> table((size_t(1) << WindowBits) * k);
+        one(table.data());
+        for (size_t i = 1; i < (size_t(1) << WindowBits); ++i) {
+            mul(&table[i * k], &table[(i - 1) * k], b);
+        }
+        std::memcpy(r, table.data(), k * LimbSize);
+        size_t const bits = ceilDiv(ne * LimbBitSize, WindowBits) * WindowBits;
+        for (size_t pos = bits; pos > 0;) {
+            pos -= WindowBits;
+            for (size_t i = 0; i < WindowBits; ++i) {
+                sqr(r, r);
+            }
+            size_t const limbIndex = pos / LimbBitSize;
+            Limb const window =
+                limbIndex < ne ? (e[limbIndex] >> pos % LimbBitSize) & 0xF : 0;
+            if (window != 0) {
+                mul(r, r, &table[window * k]);
+            }
+        }
+    }
+
+private:
+    void accumulate(Limb carry) {
+        t[k] += carry;
+        t[k + 1] += t[k] < carry;
+    }
+
+    Limb const* m;
+    size_t k;
+    Limb mInv;
+    ScratchLimbs<16> t;
+};
+
+} // namespace
+
+/// `a * b mod m` for single limbs `a, b < m`
+static Limb mulModLimb(Limb a, Limb b, Limb m) {
+    Limb rem;
+    divWide(mulHi(a, b), a * b, m, rem);
+    return rem;
+}
+
+/// `b^e mod m` for single limbs
+static Limb powModLimb(Limb b, Limb e, Limb m) {
+    Limb result = 1 % m;
+    b %= m;
+    for (; e != 0; e >>= 1) {
+        if (e & 1) {
+            result = mulModLimb(result, b, m);
+        }
+        b = mulModLimb(b, b, m);
+    }
+    return result;
+}
+
+/// `r = a * b mod m` for moduli without Montgomery form. All buffers have
+/// \p k limbs.
+static void mulModPlain(Limb* r,
+                        Limb const* a,
+                        Limb const* b,
+                        Limb const* m,
+                        size_t k) {
+    ScratchLimbs<16> prod(2 * k);
+    mulLimbs(prod.data(), a, k, b, k);
+    size_t const np = normalizedSize(prod.data(), 2 * k);
+    size_t const nm = normalizedSize(m, k);
+    std::memset(r, 0, k * LimbSize);
+    if (np < nm) {
+        std::memcpy(r, prod.data(), np * LimbSize);
+        return;
+    }
+    divremLimbs(nullptr, r, prod.data(), np, m, nm);
+}
+
+APInt APMath::powMod(APInt const& base, APInt const& exp, APInt const& mod) {
+    assert(base.bitwidth() == exp.bitwidth());
+    assert(base.bitwidth() == mod.bitwidth());
+    assert(mod.any());
+    size_t const bw = base.bitwidth();
+    size_t const k = normalizedSize(APIntAccess::limbPtr(mod),
+                                    APIntAccess::numLimbs(mod));
+    Limb const* m = APIntAccess::limbPtr(mod);
+    Limb const* e = APIntAccess::limbPtr(exp);
+    size_t const ne = normalizedSize(e, APIntAccess::numLimbs(exp));
+    size_t const nb = normalizedSize(APIntAccess::limbPtr(base),
+                                     APIntAccess::numLimbs(base));
+    if (k == 1) {
+        Limb b = remLimb(APIntAccess::limbPtr(base), nb, m[0]);
+        Limb r = 1 % m[0];
+        for (size_t bit = 0; bit < ne * LimbBitSize; ++bit) {
+            if ((e[bit / LimbBitSize] >> bit % LimbBitSize) & 1) {
+                r = mulModLimb(r, b, m[0]);
+            }
+            b = mulModLimb(b, b, m[0]);
+        }
+        return APInt(r, bw);
+    }
+    ScratchLimbs<16> b(k);
+    ScratchLimbs<16> r(k);
+    if (m[0] % 2 == 1) {
+        Montgomery mont(m, k);
+        mont.toMont(b.data(),
+                    APIntAccess::limbPtr(base),
+                    std::max(nb, size_t(1)));
+        mont.pow(r.data(), b.data(), e, ne);
+        mont.fromMont(r.data(), r.data());
+    }
+    else {
+        std::memset(b.data(), 0, k * LimbSize);
+        if (nb >= k) {
+            divremLimbs(nullptr,
+                        b.data(),
+                        APIntAccess::limbPtr(base),
+                        nb,
+                        m,
+                        k);
+        }
+        else {
+            std::memcpy(b.data(), APIntAccess::limbPtr(base), nb * LimbSize);
+        }
+        std::memset(r.data(), 0, k * LimbSize);
+        r[0] = 1;
+        for (size_t bit = ne * LimbBitSize; bit > 0;) {
+            --bit;
+            mulModPlain(r.data(), r.data(), r.data(), m, k);
+            if ((e[bit / LimbBitSize] >> bit % LimbBitSize) & 1) {
+                mulModPlain(r.data(), r.data(), b.data(), m, k);
+            }
+        }
+    }
+    return APInt(std::span<Limb const>(r.data(), k), bw);
+}
+
+/// Number of primes in `SmallPrimes`
+static constexpr size_t NumSmallPrimes = 168;
+
+/// All primes below 1000
+static constexpr auto SmallPrimes = [] {
+    std::array<std::uint32_t, NumSmallPrimes> primes{};
+    size_t count = 0;
+    for (std::uint32_t n = 2; count < NumSmallPrimes; ++n) {
+        bool prime = true;
+        for (size_t i = 0; i < count && primes[i] * primes[i] <= n; ++i) {
+            if (n % primes[i] == 0) {
+                prime = false;
+                break;
+            }
+        }
+        if (prime) {
+            primes[count++] = n;
+        }
+    }
+    return primes;
+}();
+
+enum class TrialDivisionResult { Prime, Composite, Unknown };
+
+/// Trial division of \p a with \p n limbs by all primes below 1000. Several
+/// primes are combined into one single limb divisor to reduce the number of
+/// passes over \p a.
+static TrialDivisionResult trialDivision(Limb const* a, size_t n) {
+    if (n == 1 && a[0] < 2) {
+        return TrialDivisionResult::Composite;
+    }
+    size_t i = 0;
+    while (i < NumSmallPrimes) {
+        size_t const begin = i;
+        Limb product = 1;
+        while (i < NumSmallPrimes && product <= LimbMax / SmallPrimes[i]) {
+            product *= SmallPrimes[i++];
+        }
+        Limb const rem = remLimb(a, n, product);
+        for (size_t j = begin; j < i; ++j) {
+            if (rem % SmallPrimes[j] == 0) {
+                return n == 1 && a[0] == SmallPrimes[j] ?
+                           TrialDivisionResult::Prime :
+                           TrialDivisionResult::Composite;
+            }
+        }
+    }
+    if (n == 1 && a[0] < 1000 * 1000) {
+        return TrialDivisionResult::Prime;
+    }
+    return TrialDivisionResult::Unknown;
+}
+
+/// Deterministic Miller-Rabin test for all single limb values
+static bool isPrimeLimb(Limb n) {
+    /// Bases found by Jim Sinclair, correct for all `n < 2^64`
+    static constexpr Limb Bases[] = { 2,      325,     9375,      28178,
+                                      450775, 9780504, 1795265022 };
+    int const s = std::countr_zero(n - 1);
+    Limb const d = (n - 1) >> s;
+    for (Limb base: Bases) {
+        base %= n;
+        if (base == 0) {
+            continue;
+        }
+        Limb x = powModLimb(base, d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool witness = true;
+        for (int r = 1; r < s && witness; ++r) {
+            x = mulModLimb(x, x, n);
+            witness = x != n - 1;
+        }
+        if (witness) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Strong Miller-Rabin test of the odd multi limb number `n` with base 2
+static bool millerRabinBase2(Montgomery& mont) {
+    size_t const k = mont.size();
+    Limb const* n = mont.modulus();
+    ScratchLimbs<16> d(k);
+    subLimb(d.data(), n, k, 1);
+    size_t const s = ctzLimbs(d.data(), k);
+    shrBitsInPlace(d.data(), k, s);
+    ScratchLimbs<16> one(k);
+    ScratchLimbs<16> minusOne(k);
+    ScratchLimbs<16> x(k);
+    mont.one(one.data());
+    mont.sub(minusOne.data(), n, one.data());
+    Limb const two = 2;
+    mont.toMont(x.data(), &two, 1);
+    mont.pow(x.data(), x.data(), d.data(), normalizedSize(d.data(), k));
+    if (cmpLimbs(x.data(), one.data(), k) == 0 ||
+        cmpLimbs(x.data(), minusOne.data(), k) == 0)
+    {
+        return true;
+    }
+    for (size_t r = 1; r < s; ++r) {
+        mont.sqr(x.data(), x.data());
+        if (cmpLimbs(x.data(), minusOne.data(), k) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// \Returns the Jacobi symbol `(a / n)` for odd positive `n` and small
+/// non-zero \p a, given `n mod |a|` as \p nModA and `n mod 8` as \p nMod8
+static int jacobi(std::int64_t a, Limb nModA, Limb nMod8) {
+    int result = 1;
+    Limb x = static_cast<Limb>(a < 0 ? -a : a);
+    /// `(-1 / n) = (-1)^((n - 1) / 2)`
+    if (a < 0 && nMod8 % 4 == 3) {
+        result = -result;
+    }
+    /// `(2 / n) = (-1)^((n^2 - 1) / 8)`
+    while (x % 2 == 0) {
+        x /= 2;
+        if (nMod8 == 3 || nMod8 == 5) {
+            result = -result;
+        }
+    }
+    /// Quadratic reciprocity: `(x / n) = (n mod x / x)` up to sign
+    if (x % 4 == 3 && nMod8 % 4 == 3) {
+        result = -result;
+    }
+    Limb y = x;
+    x = nModA % y;
+    /// Both operands fit into a single limb from here on
+    while (x != 0) {
+        while (x % 2 == 0) {
+            x /= 2;
+            if (y % 8 == 3 || y % 8 == 5) {
+                result = -result;
+            }
+        }
+        std::swap(x, y);
+        if (x % 4 == 3 && y % 4 == 3) {
+            result = -result;
+        }
+        x %= y;
+    }
+    return y == 1 ? result : 0;
+}
+
+/// Montgomery form of the small signed integer \p value
+static void smallToMont(Montgomery& mont, Limb* r, std::int64_t value) {
+    Limb const magnitude =
+        value < 0 ? Limb(0) - static_cast<Limb>(value) : Limb(value);
+    mont.toMont(r, &magnitude, 1);
+    if (value < 0) {
+        ScratchLimbs<16> zero(mont.size());
+        std::memset(zero.data(), 0, mont.size() * LimbSize);
+        mont.sub(r, zero.data(), r);
+    }
+}
+
+/// Strong Lucas probable prime test with Selfridge's parameters
+static bool strongLucas(Montgomery& mont, APInt const& nInt) {
+    size_t const k = mont.size();
+    Limb const* n = mont.modulus();
+    /// Perfect squares never yield a Jacobi symbol of -1
+    APInt const root = isqrt(nInt);
+    if (mul(zext(root, nInt.bitwidth() + 1), zext(root, nInt.bitwidth() + 1)) ==
+        zext(nInt, nInt.bitwidth() + 1))
+    {
+        return false;
+    }
+    std::int64_t D = 5;
+    while (true) {
+        Limb const absD = static_cast<Limb>(D < 0 ? -D : D);
+        Limb const nModD = remLimb(n, k, absD);
+        int const j = jacobi(D, nModD, n[0] % 8);
+        if (j == -1) {
+            break;
+        }
+        if (j == 0) {
+            /// `gcd(D, n) > 1` and `n` is larger than `|D|`
+            return false;
+        }
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+    std::int64_t const Q = (1 - D) / 4;
+    /// `n + 1 = d * 2^s`
+    ScratchLimbs<16> d(k + 1);
+    d[k] = addLimb(d.data(), n, k, 1);
+    size_t const s = ctzLimbs(d.data(), k + 1);
+    shrBitsInPlace(d.data(), k + 1, s);
+    size_t const nd = normalizedSize(d.data(), k + 1);
+    ScratchLimbs<16> buffer(7 * k);
+    Limb* const U = buffer.data();
+    Limb* const V = U + k;
+    Limb* const Qk = V + k;
+    Limb* const DMont = Qk + k;
+    Limb* const QMont = DMont + k;
+    Limb* const t0 = QMont + k;
+    Limb* const t1 = t0 + k;
+    smallToMont(mont, DMont, D);
+    smallToMont(mont, QMont, Q);
+    /// `P = 1`, start with `U_1 = 1`, `V_1 = P`, `Q^1`
+    mont.one(U);
+    mont.one(V);
+    std::memcpy(Qk, QMont, k * LimbSize);
+    size_t const dBits = (nd - 1) * LimbBitSize + std::bit_width(d[nd - 1]);
+    for (size_t bit = dBits - 1; bit > 0;) {
+        --bit;
+        /// `U_2m = U_m V_m`, `V_2m = V_m^2 - 2 Q^m`
+        mont.mul(U, U, V);
+        mont.sqr(V, V);
+        mont.sub(V, V, Qk);
+        mont.sub(V, V, Qk);
+        mont.sqr(Qk, Qk);
+        if ((d[bit / LimbBitSize] >> bit % LimbBitSize) & 1) {
+            /// `U_m+1 = (P U_m + V_m) / 2`, `V_m+1 = (D U_m + P V_m) / 2`
+            mont.add(t0, U, V);
+            mont.mul(t1, DMont, U);
+            mont.add(t1, t1, V);
+            mont.half(U, t0);
+            mont.half(V, t1);
+            mont.mul(Qk, Qk, QMont);
+        }
+    }
+    auto isZero = [&](Limb const* x) { return normalizedSize(x, k) == 0; };
+    if (isZero(U) || isZero(V)) {
+        return true;
+    }
+    for (size_t r = 1; r < s; ++r) {
+        mont.sqr(V, V);
+        mont.sub(V, V, Qk);
+        mont.sub(V, V, Qk);
+        if (isZero(V)) {
+            return true;
+        }
+        mont.sqr(Qk, Qk);
+    }
+    return false;
+}
+
+bool APMath::isProbablePrime(APInt const& nInt) {
+    Limb const* n = APIntAccess::limbPtr(nInt);
+    size_t const k = normalizedSize(n, APIntAccess::numLimbs(nInt));
+    if (k == 0) {
+        return false;
+    }
+    switch (trialDivision(n, k)) {
+    case TrialDivisionResult::Prime:
+        return true;
+    case TrialDivisionResult::Composite:
+        return false;
+    case TrialDivisionResult::Unknown:
+        break;
+    }
+    if (k == 1) {
+        return isPrimeLimb(n[0]);
+    }
+    Montgomery mont(n, k);
+    return millerRabinBase2(mont) && strongLucas(mont, nInt);
+}
+
+std::optional<APInt> APMath::nextPrime(APInt const& n) {
+    size_t const bw = n.bitwidth();
+    /// No prime fits into one bit. This must be checked first because
+    /// `ucmp(2)` truncates the `2` to the bitwidth of `n`.
+    if (bw < 2) {
+        return std::nullopt;
+    }
+    APInt const two(2, bw);
+    if (n.ucmp(2) < 0) {
+        return two;
+    }
+    /// Start at the next odd number
+    APInt candidate = n;
+    candidate.add(APInt(n.test(0) ? 2 : 1, bw));
+    if (candidate.ucmp(n) <= 0) {
+        return std::nullopt;
+    }
+    /// Sieve candidates incrementally by tracking their residues modulo the
+    /// small primes, so only candidates without small factors are tested
+    /// further.
+    Limb const* c = APIntAccess::limbPtr(candidate);
+    size_t const k = APIntAccess::numLimbs(candidate);
+    std::array<std::uint32_t, NumSmallPrimes> residues;
+    for (size_t i = 1; i < NumSmallPrimes; ++i) {
+        residues[i] = static_cast<std::uint32_t>(remLimb(c, k, SmallPrimes[i]));
+    }
+    /// Small candidates may be equal to one of the sieving primes
+    bool const sieve = candidate.ucmp(SmallPrimes.back()) > 0;
+    while (true) {
+        bool sieved = false;
+        for (size_t i = 1; i < NumSmallPrimes && sieve; ++i) {
+            if (residues[i] == 0) {
+                sieved = true;
+                break;
+            }
+        }
+        if (!sieved && isProbablePrime(candidate)) {
+            return candidate;
+        }
+        candidate.add(two);
+        /// `candidate` is odd and at least 3, so it wrapped around iff it is
+        /// now less than 2
+        if (candidate.ucmp(2) < 0) {
+            return std::nullopt;
+        }
+        for (size_t i = 1; i < NumSmallPrimes; ++i) {
+            residues[i] += 2;
+            if (residues[i] >= SmallPrimes[i]) {
+                residues[i] -= SmallPrimes[i];
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include "RadixConversion.h"
+
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Divide.h"
+#include "Multiply.h"
+#include "ThreadPool.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+static char intToSymbol(Limb l) {
+    if (l < 10) {
+        return static_cast<char>('0' + static_cast<int>(l));
+    }
+    return static_cast<char>('A' + static_cast<int>(l) - 10);
+}
+
+namespace {
+
+/// Divide and conquer conversion: The number is split by the largest power
+/// `C^(2^i)` of the chunk `C = base^k` with about half its limbs. Quotient and
+/// remainder are converted independently to the high and low digits.
+class RadixConverter {
+public:
+    RadixConverter(int base, size_t n): base(base) {
+        chunk = Limb(base);
+        chunkDigits = 1;
+        while (chunk <= LimbMax / Limb(base)) {
+            chunk *= Limb(base);
+            ++chunkDigits;
+        }
+        powers.push_back({ chunk });
+        while (2 * powers.back().size() <= n) {
+            auto const& p = powers.back();
+            std::vector<Limb> sqr(2 * p.size());
+            mulLimbs(sqr.data(), p.data(), p.size(), p.data(), p.size());
+            sqr.resize(normalizedSize(sqr.data(), sqr.size()));
+            powers.push_back(std::move(sqr));
+        }
+    }
+
+    /// Writes the \p width least significant digits of \p a to \p out,
+    /// padded with leading zeros.
+    /// \pre `a < base^width`
+    void convert(Limb const* a, size_t n, char* out, size_t width) const {
+        n = normalizedSize(a, n);
+        size_t i = powers.size();
+        while (i > 0 && 2 * powers[i - 1].size() > n + 1) {
+            --i;
+        }
+        if (n < RadixDCThreshold || i == 0 ||
+            (chunkDigits << (i - 1)) >= width)
+        {
+            convertBasecase(a, n, out, width);
+            return;
+        }
+        auto const& p = powers[i - 1];
+        size_t const np = p.size();
+        size_t const lowDigits = chunkDigits << (i - 1);
+        if (n < np) {
+            convertBasecase(a, n, out, width);
+            return;
+        }
+        std::vector<Limb> q(n - np + 1);
+        std::vector<Limb> r(np);
+        divremLimbs(q.data(), r.data(), a, n, p.data(), np);
+        auto high = [&] { convert(q.data(), q.size(), out, width - lowDigits); };
+        auto low = [&] {
+            convert(r.data(), np, out + width - lowDigits, lowDigits);
+        };
+        if (shouldParallelize(n)) {
+            TaskGroup group;
+            group.run(high);
+            low();
+            group.wait();
+        }
+        else {
+            high();
+            low();
+        }
+    }
+
+private:
+    /// Repeatedly divides by the chunk and emits its digits
+    void convertBasecase(Limb const* a,
+                         size_t n,
+                         char* out,
+                         size_t width) const {
+        ScratchLimbs<RadixDCThreshold> q(n);
+        std::memcpy(q.data(), a, n * LimbSize);
+        char* pos = out + width;
+        while (pos > out) {
+            Limb rem = n == 0 ? 0 : divremLimb(q.data(), q.data(), n, chunk);
+            n = normalizedSize(q.data(), n);
+            for (unsigned j = 0; j < chunkDigits && pos > out; ++j) {
+                *--pos = intToSymbol(rem % Limb(base));
+                rem /= Limb(base);
+            }
+        }
+        assert(n == 0 && "Number has more digits than requested");
+    }
+
+    int base;
+    Limb chunk;
+    unsigned chunkDigits;
+    /// `powers[i] = chunk^(2^i)`
+    std::vector<std::vector<Limb>> powers;
+};
+
+} // namespace
+
+std::string internal::limbsToString(Limb const* a, size_t n, int base) {
+    assert(base >= 2 && base <= 36);
+    n = normalizedSize(a, n);
+    if (n == 0) {
+        return "0";
+    }
+    size_t const bits = n * LimbBitSize - size_t(std::countl_zero(a[n - 1]));
+    /// Upper bound of the number of digits with some slack for rounding
+    size_t const width =
+        static_cast<size_t>(double(bits) / std::log2(double(base))) + 2;
+    std::string res(width, '0');
+    RadixConverter(base, n).convert(a, n, res.data(), width);
+    res.erase(0, res.find_first_not_of('0'));
+    return res;
+}
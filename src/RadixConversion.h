@@ -0,0 +1,20 @@
+#ifndef APMATH_RADIXCONVERSION_H_
+#define APMATH_RADIXCONVERSION_H_
+
+#include <cstddef>
+#include <string>
+
+#include "LimbOps.h"
+
+namespace APMath::internal {
+
+/// Number of limbs from which on `limbsToString()` splits the number by powers
+/// of the base instead of dividing by single limbs
+inline constexpr std::size_t RadixDCThreshold = 32;
+
+/// Converts the number \p a of \p n limbs to its digits in base \p base
+std::string limbsToString(Limb const* a, std::size_t n, int base);
+
+} // namespace APMath::internal
+
+#endif // APMATH_RADIXCONVERSION_H_
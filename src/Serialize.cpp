@@ -0,0 +1,241 @@
+#include <APMath/Serialize.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+#include <APMath/APIntRef.h>
+#include <APMath/Conversion.h>
+
+#include "LimbOps.h"
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+using std::uint64_t;
+
+static size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+static size_t writeVarint(uint64_t value, std::byte* dest) {
+    size_t i = 0;
+    while (value >= 0x80) {
+        dest[i++] = std::byte((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    dest[i++] = std::byte(value);
+    return i;
+}
+
+/// Reads a varint from the front of \p buffer and advances it
+static std::optional<uint64_t> readVarint(std::span<std::byte const>& buffer) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < buffer.size() && i < 10; ++i) {
+        auto const byte = static_cast<uint64_t>(buffer[i]);
+        /// The tenth byte may only contribute the top bit
+        if (i == 9 && byte > 1) {
+            return std::nullopt;
+        }
+        value |= (byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            buffer = buffer.subspan(i + 1);
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+/// \Returns the limb at \p index of the payload of \p value, i.e. of the
+/// value or its complement
+static Limb payloadLimb(APInt const& value, size_t index, bool complement) {
+    Limb limb = value.limb(index);
+    if (!complement) {
+        return limb;
+    }
+    limb = ~limb;
+    size_t const numLimbs = value.limbs().size();
+    if (index == numLimbs - 1) {
+        limb &= lowBitMask(value.bitwidth() - index * LimbBitSize);
+    }
+    return limb;
+}
+
+/// \Returns the number of payload bytes without leading zero bytes
+static size_t payloadSize(APInt const& value, bool complement) {
+    for (size_t i = value.limbs().size(); i-- > 0;) {
+        Limb const limb = payloadLimb(value, i, complement);
+        if (limb != 0) {
+            size_t const activeBits =
+                LimbBitSize - static_cast<size_t>(std::countl_zero(limb));
+            return i * LimbSize + ceilDiv(activeBits, CHAR_BIT);
+        }
+    }
+    return 0;
+}
+
+size_t APMath::serializedSize(APInt const& value) {
+    bool const complement = value.negative();
+    size_t const numBytes = payloadSize(value, complement);
+    return varintSize(value.bitwidth() << 1) + varintSize(numBytes) +
+           numBytes;
+}
+
+size_t APMath::serializedSize(APFloat const& value) {
+    APFloatPrec const prec = value.precision();
+    return varintSize(prec.mantissaWidth) + varintSize(prec.exponentWidth) +
+           ceilDiv(prec.totalBitwidth(), CHAR_BIT);
+}
+
+size_t APMath::serialize(APInt const& value, std::span<std::byte> buffer) {
+    assert(buffer.size() >= serializedSize(value));
+    bool const complement = value.negative();
+    size_t const numBytes = payloadSize(value, complement);
+    std::byte* dest = buffer.data();
+    dest += writeVarint(value.bitwidth() << 1 | size_t(complement), dest);
+    dest += writeVarint(numBytes, dest);
+    for (size_t i = 0; i < numBytes; i += LimbSize) {
+        Limb limb = payloadLimb(value, i / LimbSize, complement);
+        size_t const count = std::min(LimbSize, numBytes - i);
+        for (size_t j = 0; j < count; ++j, limb >>= CHAR_BIT) {
+            *dest++ = std::byte(limb & 0xFF);
+        }
+    }
+    return static_cast<size_t>(dest - buffer.data());
+}
+
+size_t APMath::serialize(APFloat const& value, std::span<std::byte> buffer) {
+    assert(buffer.size() >= serializedSize(value));
+    APFloatPrec const prec = value.precision();
+    std::byte* dest = buffer.data();
+    dest += writeVarint(prec.mantissaWidth, dest);
+    dest += writeVarint(prec.exponentWidth, dest);
+    Limb bits = value.limbs()[0];
+    size_t const numBytes = ceilDiv(prec.totalBitwidth(), CHAR_BIT);
+    for (size_t i = 0; i < numBytes; ++i, bits >>= CHAR_BIT) {
+        *dest++ = std::byte(bits & 0xFF);
+    }
+    return static_cast<size_t>(dest - buffer.data());
+}
+
+template <typename T>
+static std::vector<std::byte> serializeArray(std::span<T const> values) {
+    size_t size = varintSize(values.size());
+    for (auto& value: values) {
+        size += serializedSize(value);
+    }
+    std::vector<std::byte> result(size);
+    size_t pos = writeVarint(values.size(), result.data());
+    for (auto& value: values) {
+        pos += serialize(value, std::span(result).subspan(pos));
+    }
+    assert(pos == size);
+    return result;
+}
+
+std::vector<std::byte> APMath::serialize(std::span<APInt const> values) {
+    return serializeArray(values);
+}
+
+std::vector<std::byte> APMath::serialize(std::span<APFloat const> values) {
+    return serializeArray(values);
+}
+
+std::optional<APInt> APMath::deserializeAPInt(
+    std::span<std::byte const>& buffer) {
+    std::span<std::byte const> rest = buffer;
+    auto const header = readVarint(rest);
+    auto const numBytes = readVarint(rest);
+    if (!header || !numBytes) {
+        return std::nullopt;
+    }
+    uint64_t const bitwidth = *header >> 1;
+    bool const complement = *header & 1;
+    if (bitwidth == 0 || bitwidth > APInt::maxBitwidth() ||
+        *numBytes > ceilDiv(bitwidth, CHAR_BIT) || *numBytes > rest.size())
+    {
+        return std::nullopt;
+    }
+    /// The payload must not have bits above the bitwidth
+    size_t const payloadBits = *numBytes * CHAR_BIT;
+    if (payloadBits > bitwidth &&
+        (static_cast<unsigned>(rest[*numBytes - 1]) >>
+         (CHAR_BIT - (payloadBits - bitwidth))) != 0)
+    {
+        return std::nullopt;
+    }
+    APInt value(bitwidth);
+    std::span<Limb> const limbs = APIntRef(value).limbs();
+    for (size_t i = 0; i < *numBytes; ++i) {
+        limbs[i / LimbSize] |= static_cast<Limb>(rest[i])
+                               << (i % LimbSize * CHAR_BIT);
+    }
+    if (complement) {
+        value.flip();
+    }
+    buffer = rest.subspan(*numBytes);
+    return value;
+}
+
+std::optional<APFloat> APMath::deserializeAPFloat(
+    std::span<std::byte const>& buffer) {
+    std::span<std::byte const> rest = buffer;
+    auto const mantissaWidth = readVarint(rest);
+    auto const exponentWidth = readVarint(rest);
+    if (!mantissaWidth || !exponentWidth) {
+        return std::nullopt;
+    }
+    APFloatPrec const prec = { *mantissaWidth, *exponentWidth };
+    if (prec != APFloatPrec::Single() && prec != APFloatPrec::Double()) {
+        return std::nullopt;
+    }
+    size_t const numBytes = prec.totalBitwidth() / CHAR_BIT;
+    if (numBytes > rest.size()) {
+        return std::nullopt;
+    }
+    APInt const bits = APInt::fromBytes(rest.first(numBytes),
+                                        std::endian::little,
+                                        prec.totalBitwidth());
+    buffer = rest.subspan(numBytes);
+    return bitcast<APFloat>(bits);
+}
+
+template <typename T, typename F>
+static std::optional<std::vector<T>> deserializeArray(
+    std::span<std::byte const> buffer, F deserializeOne) {
+    auto const count = readVarint(buffer);
+    /// Every value needs at least two bytes
+    if (!count || *count > buffer.size() / 2) {
+        return std::nullopt;
+    }
+    std::vector<T> result;
+    result.reserve(*count);
+    for (uint64_t i = 0; i < *count; ++i) {
+        auto value = deserializeOne(buffer);
+        if (!value) {
+            return std::nullopt;
+        }
+        result.push_back(std::move(*value));
+    }
+    if (!buffer.empty()) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+std::optional<std::vector<APInt>> APMath::deserializeAPInts(
+    std::span<std::byte const> buffer) {
+    return deserializeArray<APInt>(buffer, deserializeAPInt);
+}
+
+std::optional<std::vector<APFloat>> APMath::deserializeAPFloats(
+    std::span<std::byte const> buffer) {
+    return deserializeArray<APFloat>(buffer, deserializeAPFloat);
+}
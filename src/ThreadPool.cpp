@@ -0,0 +1,182 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <APMath/Parallel.h>
+
+using namespace APMath;
+using namespace APMath::internal;
+
+using std::size_t;
+
+namespace {
+
+struct Task {
+    std::function<void()> function;
+    TaskGroup* group;
+};
+
+/// Task deque of one thread. The owner pops from the back, thieves steal from
+/// the front.
+struct alignas(64) TaskQueue {
+    std::mutex mutex;
+    std::deque<Task*> tasks;
+};
+
+/// Index of the queue of the current thread. Threads that are not workers of
+/// the pool share the last queue.
+thread_local size_t queueIndex = size_t(-1);
+
+} // namespace
+
+namespace APMath::internal {
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t numWorkers): queues(numWorkers + 1) {
+        workers.reserve(numWorkers);
+        for (size_t i = 0; i < numWorkers; ++i) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(sleepMutex);
+            stop = true;
+        }
+        sleepCV.notify_all();
+        for (auto& worker: workers) {
+            worker.join();
+        }
+    }
+
+    void push(Task* task) {
+        auto& queue = queues[ownQueue()];
+        {
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(task);
+        }
+        numQueued.fetch_add(1, std::memory_order_release);
+        /// Taking the lock orders the notification after a sleeping worker
+        /// has checked `numQueued`
+        { std::lock_guard lock(sleepMutex); }
+        sleepCV.notify_one();
+    }
+
+    /// Executes one pending task if there is any
+    /// \Returns `true` if a task was executed
+    bool runOne() {
+        Task* task = pop();
+        if (!task) {
+            return false;
+        }
+        task->function();
+        task->group->pending.fetch_sub(1, std::memory_order_acq_rel);
+        delete task;
+        return true;
+    }
+
+    size_t numThreads() const { return workers.size() + 1; }
+
+private:
+    size_t ownQueue() const {
+        return queueIndex < queues.size() ? queueIndex : queues.size() - 1;
+    }
+
+    Task* pop() {
+        if (numQueued.load(std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+        size_t const own = ownQueue();
+        for (size_t i = 0; i < queues.size(); ++i) {
+            size_t const index = (own + i) % queues.size();
+            auto& queue = queues[index];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            Task* task;
+            if (index == own) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+            else {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+            numQueued.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+        return nullptr;
+    }
+
+    void work(size_t index) {
+        queueIndex = index;
+        while (true) {
+            if (runOne()) {
+                continue;
+            }
+            std::unique_lock lock(sleepMutex);
+            sleepCV.wait(lock, [&] {
+                return stop || numQueued.load(std::memory_order_acquire) > 0;
+            });
+            if (stop) {
+                return;
+            }
+        }
+    }
+
+    std::vector<TaskQueue> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> numQueued = 0;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCV;
+    bool stop = false;
+};
+
+} // namespace APMath::internal
+
+static ParallelOptions globalOptions;
+static std::unique_ptr<ThreadPool> globalPool;
+
+void APMath::setParallelOptions(ParallelOptions const& options) {
+    globalPool.reset();
+    globalOptions = options;
+    if (globalOptions.numThreads == 0) {
+        globalOptions.numThreads =
+            std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (globalOptions.numThreads > 1) {
+        globalPool = std::make_unique<ThreadPool>(globalOptions.numThreads - 1);
+    }
+}
+
+ParallelOptions APMath::parallelOptions() { return globalOptions; }
+
+bool internal::shouldParallelize(size_t numLimbs) {
+    return globalPool && numLimbs >= globalOptions.cutoff;
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    if (!globalPool) {
+        task();
+        return;
+    }
+    pending.fetch_add(1, std::memory_order_relaxed);
+    globalPool->push(new Task{ std::move(task), this });
+}
+
+void TaskGroup::wait() {
+    while (pending.load(std::memory_order_acquire) != 0) {
+        if (!globalPool->runOne()) {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef APMATH_THREADPOOL_H_
+#define APMATH_THREADPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+/// Fork-join parallelism for the recursive algorithms. Tasks are scheduled on
+/// the thread pool configured with `setParallelOptions()`. Without a pool they
+/// run immediately on the calling thread.
+
+namespace APMath::internal {
+
+/// \Returns `true` if work on operands of \p numLimbs limbs shall be split
+/// across threads
+bool shouldParallelize(std::size_t numLimbs);
+
+/// A set of tasks that can be waited for
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    TaskGroup(TaskGroup const&) = delete;
+    TaskGroup& operator=(TaskGroup const&) = delete;
+    ~TaskGroup() { wait(); }
+
+    /// Schedules \p task for execution
+    void run(std::function<void()> task);
+
+    /// Blocks until all tasks of this group have finished. The waiting thread
+    /// executes pending tasks in the meantime, so nested groups cannot
+    /// deadlock.
+    void wait();
+
+private:
+    friend class ThreadPool;
+
+    std::atomic<std::size_t> pending = 0;
+};
+
+} // namespace APMath::internal
+
+#endif // APMATH_THREADPOOL_H_
@@ -0,0 +1,321 @@
+#include <APMath/Trace.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+#include <APMath/Serialize.h>
+
+#include "Instrument.h"
+
+using namespace APMath;
+
+using std::size_t;
+using std::uint64_t;
+
+static constexpr char Magic[8] = { 'A', 'P', 'M', 'T', 'R', 'C', '1', '\0' };
+static constexpr unsigned FloatTag = 0x80;
+
+static constexpr std::array IntOpNames = {
+    "Add",    "Sub",    "Mul",    "UDiv",   "URem",   "SDiv",
+    "SRem",   "BtwAnd", "BtwOr",  "BtwXor", "LShl",   "LShr",
+    "AShr",   "CmpEQ",  "CmpNE",  "CmpULT", "CmpULE", "CmpUGT",
+    "CmpUGE", "CmpSLT", "CmpSLE", "CmpSGT", "CmpSGE",
+};
+
+static constexpr std::array FloatOpNames = {
+    "Add", "Sub", "Mul", "Div", "Pow", "Hypot",
+};
+
+static_assert(IntOpNames.size() == size_t(APIntOp::CmpSGE) + 1);
+static_assert(FloatOpNames.size() == size_t(APFloatOp::Hypot) + 1);
+
+/// \Returns `true` if `op(lhs, rhs)` has a defined result
+static bool isExecutable(APIntOp op, APInt const& lhs, APInt const& rhs) {
+    switch (op) {
+    case APIntOp::UDiv:
+    case APIntOp::URem:
+    case APIntOp::SDiv:
+    case APIntOp::SRem:
+        return !rhs.none();
+    case APIntOp::LShl:
+    case APIntOp::LShr:
+    case APIntOp::AShr:
+        return ucmp(rhs, lhs.bitwidth()) < 0;
+    default:
+        return true;
+    }
+}
+
+#if APMATH_INSTRUMENTATION
+
+namespace {
+
+/// The trace being recorded. Records are buffered and written to the file
+/// when the buffer is full or recording stops.
+struct Recorder {
+    static constexpr size_t BufferSize = 1 << 20;
+
+    std::mutex mutex;
+    std::atomic<bool> active = false;
+    std::ofstream file;
+    std::vector<std::byte> buffer;
+
+    /// Writes the buffered records of a trace that is still being recorded
+    /// at program exit, so the file is not truncated
+    ~Recorder() {
+        if (active.load(std::memory_order_relaxed)) {
+            active.store(false, std::memory_order_relaxed);
+            flush();
+        }
+    }
+
+    void flush() {
+        file.write(reinterpret_cast<char const*>(buffer.data()),
+                   static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    template <typename T>
+    void record(unsigned tag, T const& lhs, T const& rhs) {
+        std::lock_guard lock(mutex);
+        if (!active.load(std::memory_order_relaxed)) {
+            return;
+        }
+        size_t const lhsSize = serializedSize(lhs);
+        size_t const rhsSize = serializedSize(rhs);
+        size_t pos = buffer.size();
+        buffer.resize(pos + 1 + lhsSize + rhsSize);
+        buffer[pos++] = std::byte(tag);
+        pos += serialize(lhs, std::span(buffer).subspan(pos, lhsSize));
+        serialize(rhs, std::span(buffer).subspan(pos, rhsSize));
+        if (buffer.size() >= BufferSize) {
+            flush();
+        }
+    }
+};
+
+} // namespace
+
+static Recorder recorder;
+
+thread_local int internal::traceDepth = 0;
+
+bool internal::isTracing() {
+    return recorder.active.load(std::memory_order_relaxed);
+}
+
+void internal::traceOperation(APIntOp op, APInt const& lhs, APInt const& rhs) {
+    recorder.record(static_cast<unsigned>(op), lhs, rhs);
+}
+
+void internal::traceOperation(APFloatOp op,
+                              APFloat const& lhs,
+                              APFloat const& rhs) {
+    recorder.record(FloatTag | static_cast<unsigned>(op), lhs, rhs);
+}
+
+bool APMath::startTrace(std::string const& path) {
+    std::lock_guard lock(recorder.mutex);
+    if (recorder.active.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    recorder.file.open(path, std::ios::binary | std::ios::trunc);
+    if (!recorder.file) {
+        recorder.file.close();
+        recorder.file.clear();
+        return false;
+    }
+    recorder.file.write(Magic, sizeof(Magic));
+    recorder.buffer.reserve(Recorder::BufferSize);
+    recorder.active.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+bool APMath::stopTrace() {
+    std::lock_guard lock(recorder.mutex);
+    if (!recorder.active.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    recorder.active.store(false, std::memory_order_relaxed);
+    recorder.flush();
+    bool const success = static_cast<bool>(recorder.file);
+    recorder.file.close();
+    recorder.file.clear();
+    return success;
+}
+
+#else
+
+bool APMath::startTrace(std::string const&) { return false; }
+
+bool APMath::stopTrace() { return false; }
+
+#endif
+
+std::optional<Trace> Trace::fromBytes(std::span<std::byte const> bytes) {
+    if (bytes.size() < sizeof(Magic) ||
+        std::memcmp(bytes.data(), Magic, sizeof(Magic)) != 0)
+    {
+        return std::nullopt;
+    }
+    bytes = bytes.subspan(sizeof(Magic));
+    Trace trace;
+    while (!bytes.empty()) {
+        auto const tag = static_cast<unsigned>(bytes.front());
+        bytes = bytes.subspan(1);
+        bool const isFloat = (tag & FloatTag) != 0;
+        unsigned const op = tag & ~FloatTag;
+        if (isFloat) {
+            auto lhs = op < FloatOpNames.size() ? deserializeAPFloat(bytes) :
+                                                  std::nullopt;
+            auto rhs = lhs ? deserializeAPFloat(bytes) : std::nullopt;
+            if (!rhs || lhs->precision() != rhs->precision()) {
+                return std::nullopt;
+            }
+            size_t const index = trace.floatOperands.size();
+            trace.entries.push_back({ true, std::uint8_t(op), index });
+            trace.floatOperands.push_back(std::move(*lhs));
+            trace.floatOperands.push_back(std::move(*rhs));
+        }
+        else {
+            auto lhs = op < IntOpNames.size() ? deserializeAPInt(bytes) :
+                                                std::nullopt;
+            auto rhs = lhs ? deserializeAPInt(bytes) : std::nullopt;
+            if (!rhs || lhs->bitwidth() != rhs->bitwidth() ||
+                !isExecutable(APIntOp(op), *lhs, *rhs))
+            {
+                return std::nullopt;
+            }
+            size_t const index = trace.intOperands.size();
+            trace.entries.push_back({ false, std::uint8_t(op), index });
+            trace.intOperands.push_back(std::move(*lhs));
+            trace.intOperands.push_back(std::move(*rhs));
+        }
+    }
+    return trace;
+}
+
+std::optional<Trace> Trace::read(std::string const& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::vector<char> const data{ std::istreambuf_iterator<char>(file),
+                                  std::istreambuf_iterator<char>() };
+    return fromBytes(std::as_bytes(std::span(data)));
+}
+
+/// Index of the statistics of \p entry in `ReplayStatistics::operations`
+/// before empty entries are removed
+static size_t statisticsIndex(Trace::Entry const& entry) {
+    return entry.isFloat ? IntOpNames.size() + entry.op : entry.op;
+}
+
+/// Executes \p entry. The result is returned so the call cannot be optimized
+/// away.
+static uint64_t execute(Trace const& trace, Trace::Entry const& entry) {
+    if (entry.isFloat) {
+        return evaluate(trace.floatOperation(entry)).limbs()[0];
+    }
+    return evaluate(trace.intOperation(entry)).limb(0);
+}
+
+ReplayStatistics APMath::replay(Trace const& trace, size_t repetitions) {
+    using Clock = std::chrono::steady_clock;
+    ReplayStatistics result;
+    uint64_t checksum = 0;
+    auto const start = Clock::now();
+    for (size_t r = 0; r < repetitions; ++r) {
+        for (auto& entry: trace.entries) {
+            checksum += execute(trace, entry);
+        }
+    }
+    result.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    result.numOperations = repetitions * trace.entries.size();
+    std::vector<std::vector<uint64_t>> latencies(IntOpNames.size() +
+                                                 FloatOpNames.size());
+    for (size_t r = 0; r < repetitions; ++r) {
+        for (auto& entry: trace.entries) {
+            auto const begin = Clock::now();
+            checksum += execute(trace, entry);
+            auto const end = Clock::now();
+            latencies[statisticsIndex(entry)].push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+                                                                     begin)
+                    .count()));
+        }
+    }
+    for (size_t i = 0; i < latencies.size(); ++i) {
+        auto& values = latencies[i];
+        if (values.empty()) {
+            continue;
+        }
+        std::sort(values.begin(), values.end());
+        ReplayStatistics::Operation operation;
+        operation.name = i < IntOpNames.size() ?
+                             std::string("APInt.") + IntOpNames[i] :
+                             std::string("APFloat.") +
+                                 FloatOpNames[i - IntOpNames.size()];
+        operation.count = values.size();
+        for (uint64_t value: values) {
+            operation.totalNanoseconds += value;
+        }
+        auto percentile = [&](size_t p) {
+            return values[(values.size() - 1) * p / 100];
+        };
+        operation.p50 = percentile(50);
+        operation.p90 = percentile(90);
+        operation.p99 = percentile(99);
+        operation.max = values.back();
+        result.operations.push_back(std::move(operation));
+    }
+    /// Keep the checksum alive
+    volatile uint64_t sink = checksum;
+    (void)sink;
+    return result;
+}
+
+std::string ReplayStatistics::toString() const {
+    std::string result;
+    char line[160];
+    std::snprintf(line,
+                  sizeof(line),
+                  "%zu operations in %.6f s (%.0f ops/s)\n",
+                  numOperations,
+                  seconds,
+                  operationsPerSecond());
+    result += line;
+    std::snprintf(line,
+                  sizeof(line),
+                  "%-16s %10s %12s %10s %10s %10s %10s\n",
+                  "Operation",
+                  "Count",
+                  "Total [ns]",
+                  "p50 [ns]",
+                  "p90 [ns]",
+                  "p99 [ns]",
+                  "Max [ns]");
+    result += line;
+    for (auto& op: operations) {
+        std::snprintf(line,
+                      sizeof(line),
+                      "%-16s %10zu %12llu %10llu %10llu %10llu %10llu\n",
+                      op.name.c_str(),
+                      op.count,
+                      static_cast<unsigned long long>(op.totalNanoseconds),
+                      static_cast<unsigned long long>(op.p50),
+                      static_cast<unsigned long long>(op.p90),
+                      static_cast<unsigned long long>(op.p99),
+                      static_cast<unsigned long long>(op.max));
+        result += line;
+    }
+    return result;
+}
@@ -1,13 +1,22 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
+#include <array>
+#include <atomic>
 #include <limits>
+#include <random>
+#include <thread>
 #include <vector>
 
 #include <APMath/API.h>
 #include <APMath/APInt.h>
+#include <APMath/APIntAccumulator.h>
+#include <APMath/APIntRef.h>
+
+#include "Test.h"
 
 using namespace APMath;
+using test::randomAPInt;
 
 TEST_CASE("Lifetime") {
     size_t const bitwidth =
@@ -227,6 +236,65 @@ TEST_CASE("mul - 4") {
     CHECK(a.ucmp(ref) == 0);
 }
 
+/// Reference product using the schoolbook multiply-add of `APIntAccumulator`
+static APInt schoolbookMul(APInt const& lhs, APInt const& rhs) {
+    APIntAccumulator acc(lhs.bitwidth());
+    acc.mulAdd(lhs, rhs);
+    return acc.value();
+}
+
+TEST_CASE("mul - 5") {
+    /// Operand sizes in limbs covering the schoolbook, Karatsuba and NTT
+    /// ranges, including unbalanced products
+    auto const [na, nb] = GENERATE(table<size_t, size_t>({ { 31, 33 },
+                                                           { 40, 40 },
+                                                           { 97, 130 },
+                                                           { 300, 45 },
+                                                           { 513, 511 },
+                                                           { 5000, 2100 },
+                                                           { 4100, 4097 } }));
+    std::mt19937_64 rng(na * nb);
+    size_t const bitwidth = 64 * (na + nb);
+    APInt const a = zext(randomAPInt(rng, 64 * na), bitwidth);
+    APInt const b = zext(randomAPInt(rng, 64 * nb), bitwidth);
+    CHECK(mul(a, b) == schoolbookMul(a, b));
+    CHECK(mul(a, a) == schoolbookMul(a, a));
+    /// Truncated products
+    APInt const c = randomAPInt(rng, 64 * na + 7);
+    APInt const d = randomAPInt(rng, 64 * na + 7);
+    CHECK(mul(c, d) == schoolbookMul(c, d));
+}
+
+TEST_CASE("mul - 6") {
+    /// `(2^k - 1)^2 == 2^2k - 2^(k + 1) + 1` with all limbs saturated
+    size_t const k = GENERATE(64u * 40, 64u * 3000, 64u * 5000);
+    APInt x(0, 2 * k);
+    x.sub(APInt(1, 2 * k));
+    x.lshr(int(k));
+    APInt expected(0, 2 * k);
+    expected.sub(APInt(1, 2 * k).lshl(int(k + 1)));
+    expected.add(APInt(1, 2 * k));
+    CHECK(mul(x, x) == expected);
+}
+
+TEST_CASE("mul - 7") {
+    /// Products above the NTT threshold against the sum of partial products of
+    /// `a = a1 * 2^s + a0`, which are computed by Karatsuba
+    std::mt19937_64 rng(7);
+    size_t const na = 9000;
+    size_t const nb = 4500;
+    size_t const bitwidth = 64 * (na + nb);
+    size_t const s = 64 * 4000;
+    APInt const a = zext(randomAPInt(rng, 64 * na), bitwidth);
+    APInt const b = zext(randomAPInt(rng, 64 * nb), bitwidth);
+    APInt const a0 = lshr(lshl(a, int(bitwidth - s)), int(bitwidth - s));
+    APInt const a1 = lshr(a, int(s));
+    APInt expected = mul(a1, b);
+    expected.lshl(int(s));
+    expected.add(mul(a0, b));
+    CHECK(mul(a, b) == expected);
+}
+
 TEST_CASE("udivrem - 1") {
     uint64_t const aVal =
         GENERATE(0u, 1u, 7u, 10u, 100u, 99999u, 0xFFFF'FFFF'FFFF'FFFFull);
@@ -240,6 +308,23 @@ TEST_CASE("udivrem - 1") {
     CHECK(r.ucmp(aVal % bVal) == 0);
 }
 
+TEST_CASE("udivrem - 2") {
+    /// Sizes in limbs covering Knuth's algorithm and Newton division with
+    /// long and short quotients
+    auto const [nn, nd] = GENERATE(table<size_t, size_t>({ { 3, 1 },
+                                                           { 10, 3 },
+                                                           { 300, 150 },
+                                                           { 7000, 3100 },
+                                                           { 10000, 6500 } }));
+    std::mt19937_64 rng(nn + nd);
+    size_t const bitwidth = 64 * (nn + 1);
+    APInt const num = zext(randomAPInt(rng, 64 * nn), bitwidth);
+    APInt const den = zext(randomAPInt(rng, 64 * nd - 17), bitwidth);
+    auto const [q, r] = udivrem(num, den);
+    CHECK(r.ucmp(den) < 0);
+    CHECK(add(mul(q, den), r) == num);
+}
+
 TEST_CASE("sdivrem - 1") {
     int64_t const aVal = GENERATE(-100, 0, 1, 7, 10, 100, 99999);
     int64_t const bVal = GENERATE(-100, 1, 2, 7, 99999);
@@ -259,6 +344,39 @@ TEST_CASE("sdivrem - 1") {
     CHECK(r.ucmp(rRef) == 0);
 }
 
+TEST_CASE("divExact - 1") {
+    CHECK(divExact(APInt(42, 64), APInt(6, 64)) == 7);
+    CHECK(divExact(APInt(0, 64), APInt(6, 64)) == 0);
+    CHECK(divExact(APInt(96, 8), APInt(32, 8)) == 3);
+    /// Pointer difference `(p - q) / sizeof(T)`
+    CHECK(divExact(APInt(24 * 0x1234'5678'9ABC, 64), APInt(24, 64)) ==
+          0x1234'5678'9ABC);
+    size_t const bitwidth = GENERATE(64u, 65u, 128u, 200u, 512u, 1000u);
+    std::mt19937_64 rng(bitwidth);
+    for (int i = 0; i < 20; ++i) {
+        APInt const q =
+            randomAPInt(rng, bitwidth).lshr(int(bitwidth / 2 + 1));
+        APInt const d =
+            randomAPInt(rng, bitwidth).lshr(int(bitwidth / 2 + i % 7));
+        if (d.none()) {
+            continue;
+        }
+        APInt const a = mul(q, d);
+        CHECK(divExact(a, d) == q);
+        CHECK(divExact(a, q.any() ? q : d) == (q.any() ? d : q));
+    }
+}
+
+TEST_CASE("sdivExact - 1") {
+    int64_t const qVal = GENERATE(-100, -1, 0, 1, 7, 99999);
+    int64_t const dVal = GENERATE(-96, -1, 1, 2, 7, 99999);
+    size_t const bitwidth = GENERATE(48u, 64u, 65u, 128u);
+    APInt const a = APInt(uint64_t(qVal * dVal), 64).sext(bitwidth);
+    APInt const d = APInt(uint64_t(dVal), 64).sext(bitwidth);
+    CHECK(sdivExact(a, d) == APInt(uint64_t(qVal), 64).sext(bitwidth));
+    CHECK(sdivExact(a, d) == sdiv(a, d));
+}
+
 TEST_CASE("lshl - 1") {
     APInt a(6, 64);
     a.lshl(1);
@@ -331,6 +449,91 @@ TEST_CASE("ashr - 1") {
     CHECK(a.ucmp(ref) == 0);
 }
 
+TEST_CASE("rotl - 1") {
+    size_t const bitwidth = GENERATE(1u, 7u, 64u, 65u, 128u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const a = randomAPInt(rng, bitwidth);
+    for (int n: { 0, 1, 3, 63, 64, 65, 130, -1, -70 }) {
+        APInt const rotated = rotl(a, n);
+        size_t const bw = bitwidth;
+        size_t const s = ((n % (int)bw) + bw) % bw;
+        for (size_t i = 0; i < bw; ++i) {
+            CHECK(rotated.test((i + s) % bw) == a.test(i));
+        }
+        CHECK(rotr(rotated, n) == a);
+        CHECK(fshl(a, a, n) == rotated);
+        CHECK(fshr(a, a, n) == rotr(a, n));
+    }
+}
+
+TEST_CASE("Funnel shift - 1") {
+    size_t const bitwidth = GENERATE(8u, 64u, 100u, 192u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const hi = randomAPInt(rng, bitwidth);
+    APInt const lo = randomAPInt(rng, bitwidth);
+    APInt concat = zext(hi, 2 * bitwidth);
+    concat.lshl(static_cast<int>(bitwidth));
+    concat.btwor(zext(lo, 2 * bitwidth));
+    for (int n: { 0, 1, 5, 63, 64, 99 }) {
+        if ((size_t)n >= bitwidth) {
+            continue;
+        }
+        APInt const left = lshl(concat, n).lshr(static_cast<int>(bitwidth));
+        CHECK(fshl(hi, lo, n) == zext(left, bitwidth));
+        APInt const right = lshr(concat, n);
+        CHECK(fshr(hi, lo, n) == zext(right, bitwidth));
+    }
+}
+
+TEST_CASE("bswap - 1") {
+    APInt a(0x0102'0304'0506'0708, 64);
+    CHECK(bswap(a) == APInt(0x0807'0605'0403'0201, 64));
+    APInt b(0x0A0B0C, 24);
+    CHECK(bswap(b) == APInt(0x0C0B0A, 24));
+    size_t const bitwidth = GENERATE(8u, 16u, 72u, 128u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const c = randomAPInt(rng, bitwidth);
+    APInt const swapped = bswap(c);
+    size_t const numBytes = bitwidth / 8;
+    for (size_t i = 0; i < numBytes; ++i) {
+        CHECK(swapped.extractBits(8 * i, 8) ==
+              c.extractBits(8 * (numBytes - 1 - i), 8));
+    }
+    CHECK(bswap(swapped) == c);
+}
+
+TEST_CASE("bitreverse - 1") {
+    CHECK(bitreverse(APInt(0b0001'1011, 5)) == APInt(0b11011, 5));
+    CHECK(bitreverse(APInt(1, 64)) == APInt(uint64_t(1) << 63, 64));
+    size_t const bitwidth = GENERATE(1u, 13u, 64u, 65u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const a = randomAPInt(rng, bitwidth);
+    APInt const reversed = bitreverse(a);
+    for (size_t i = 0; i < bitwidth; ++i) {
+        CHECK(reversed.test(bitwidth - 1 - i) == a.test(i));
+    }
+    CHECK(bitreverse(reversed) == a);
+}
+
+TEST_CASE("min/max/abs - 1") {
+    size_t const bitwidth = GENERATE(8u, 64u, 100u);
+    APInt const one(1, bitwidth);
+    APInt const mOne = negate(one);
+    CHECK(umin(one, mOne) == one);
+    CHECK(umax(one, mOne) == mOne);
+    CHECK(smin(one, mOne) == mOne);
+    CHECK(smax(one, mOne) == one);
+    CHECK(abs(mOne) == one);
+    CHECK(abs(one) == one);
+    CHECK(abs(APInt(0, bitwidth)) == APInt(0, bitwidth));
+    CHECK(abs(APInt::SMin(bitwidth)) == APInt::SMin(bitwidth));
+    CHECK(abs(negate(APInt(42, bitwidth))) == APInt(42, bitwidth));
+    CHECK(smin(APInt::SMin(bitwidth), APInt::SMax(bitwidth)) ==
+          APInt::SMin(bitwidth));
+    CHECK(umin(APInt::SMin(bitwidth), APInt::SMax(bitwidth)) ==
+          APInt::SMax(bitwidth));
+}
+
 TEST_CASE("negate - 1") {
     uint64_t const aVal = GENERATE(-100u, uint64_t(-1), 0u, 1u, 100u);
     size_t const bitwidth = GENERATE(64u, 65u, 127, 128u);
@@ -398,6 +601,240 @@ TEST_CASE("Bitset operations") {
     CHECK(a.all());
 }
 
+TEST_CASE("Bit fields - 1") {
+    APInt a({ 0xFEDCBA9876543210, 0x0123456789ABCDEF }, 128);
+    CHECK(a.extractBits(4, 8) == APInt(0x21, 8));
+    CHECK(a.extractBits(60, 8) == APInt(0xFF, 8));
+    CHECK(a.extractBits(0, 128) == a);
+    CHECK(a.extractBits(32, 96) ==
+          APInt({ 0x89ABCDEFFEDCBA98, 0x01234567 }, 96));
+    a.insertBits(APInt(0xA5, 8), 60);
+    CHECK(a.limbs()[0] == 0x5EDCBA9876543210);
+    CHECK(a.limbs()[1] == 0x0123456789ABCDEA);
+    a.clearBits(0, 128);
+    CHECK(a.none());
+    a.setBits(3, 70);
+    CHECK(a.popcount() == 67);
+    CHECK(a.findNextSet(0) == 3);
+    CHECK(a.findNextSet(69) == 69);
+    CHECK(a.findNextSet(70) == 128);
+    CHECK(a.findPrevSet(127) == 69);
+    CHECK(a.findPrevSet(2) == 128);
+    a.clearBits(10, 10);
+    CHECK(a.popcount() == 67);
+}
+
+TEST_CASE("Bit fields - 2") {
+    size_t const bitwidth = GENERATE(1u, 20u, 64u, 65u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    for (int i = 0; i < 50; ++i) {
+        APInt const a = randomAPInt(rng, bitwidth);
+        size_t const lo = rng() % bitwidth;
+        size_t const width = 1 + rng() % (bitwidth - lo);
+        size_t const hi = lo + width;
+        APInt const field = a.extractBits(lo, width);
+        CHECK(field == zext(lshr(a, (int)lo), width));
+        APInt const value = randomAPInt(rng, width);
+        APInt inserted = a;
+        inserted.insertBits(value, lo);
+        APInt set = a;
+        set.setBits(lo, hi);
+        APInt cleared = a;
+        cleared.clearBits(lo, hi);
+        for (size_t j = 0; j < bitwidth; ++j) {
+            bool const inRange = j >= lo && j < hi;
+            bool const expected = inRange ? value.test(j - lo) : a.test(j);
+            CHECK(inserted.test(j) == expected);
+            CHECK(set.test(j) == (inRange || a.test(j)));
+            CHECK(cleared.test(j) == (!inRange && a.test(j)));
+        }
+        size_t next = bitwidth, prev = bitwidth;
+        for (size_t j = lo; j < bitwidth; ++j) {
+            if (a.test(j)) {
+                next = j;
+                break;
+            }
+        }
+        for (size_t j = lo + 1; j-- > 0;) {
+            if (a.test(j)) {
+                prev = j;
+                break;
+            }
+        }
+        CHECK(a.findNextSet(lo) == next);
+        CHECK(a.findPrevSet(lo) == prev);
+    }
+}
+
+TEST_CASE("Hash - 1") {
+    CHECK(APInt(0, 8).hash() != APInt(0, 64).hash());
+    CHECK(APInt(1, 64).hash() != APInt(1, 65).hash());
+    CHECK(APInt(5, 64).hash(1) != APInt(5, 64).hash(2));
+    size_t const bitwidth = GENERATE(1u, 64u, 65u, 128u, 300u, 520u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const a = randomAPInt(rng, bitwidth);
+    APInt b = a;
+    CHECK(a.hash() == b.hash());
+    CHECK(a.hash(7) == APIntView(a).hash(7));
+    b.flip(bitwidth - 1);
+    CHECK(a.hash() != b.hash());
+}
+
+TEST_CASE("Hash - 2") {
+    /// Seeded hashes are stable and must not change between versions
+    CHECK(APInt(0, 64).hash(0) == 0x939A'9BD0'9743'05C0);
+    CHECK(APInt(0x1234'5678, 32).hash(42) == 0x4719'BB82'90DE'A96C);
+    CHECK(APInt({ 1, 2, 3, 4, 5 }, 300).hash(42) == 0x1D73'32A0'F314'C0C3);
+}
+
+TEST_CASE("Shared storage - 1") {
+    std::mt19937_64 rng(1);
+    APInt const value = randomAPInt(rng, 4096);
+    APInt a = value;
+    CHECK(!a.isShared());
+    CHECK(a.useCount() == 1);
+    a.share();
+    CHECK(a.isShared());
+    CHECK(a == value);
+    APInt b = a;
+    APInt c;
+    c = b;
+    CHECK(b.isShared());
+    CHECK(a.limbs().data() == b.limbs().data());
+    CHECK(a.limbs().data() == c.limbs().data());
+    CHECK(a.useCount() == 3);
+    /// Mutation copies the limbs
+    b.add(APInt(1, 4096));
+    CHECK(b.isShared());
+    CHECK(b.limbs().data() != a.limbs().data());
+    CHECK(a.useCount() == 2);
+    CHECK(b.useCount() == 1);
+    CHECK(a == value);
+    CHECK(c == value);
+    CHECK(b == add(value, APInt(1, 4096)));
+    /// A unique owner modifies in place
+    APInt::Limb const* const bLimbs = b.limbs().data();
+    b.flip();
+    CHECK(b.limbs().data() == bLimbs);
+    /// Free functions leave their shared arguments unchanged
+    CHECK(sub(a, APInt(1, 4096)) == sub(value, APInt(1, 4096)));
+    CHECK(lshr(c, 100) == lshr(value, 100));
+    CHECK(a == value);
+    CHECK(c == value);
+    APInt d = std::move(c);
+    CHECK(d.useCount() == 2);
+    c = APInt(5, 8);
+    CHECK(!c.isShared());
+    d.zext(64);
+    CHECK(!d.isShared());
+    CHECK(a.useCount() == 1);
+    CHECK(APInt(7, 64).share().useCount() == 1);
+    /// Exact division of shared integers
+    APInt const divisor =
+        btwor(lshr(randomAPInt(rng, 4096), 2048), APInt(1, 4096));
+    APInt const quotient = lshr(randomAPInt(rng, 4096), 2049);
+    APInt const multiple = mul(quotient, divisor);
+    APInt e = multiple;
+    e.share();
+    APInt f = e;
+    f.divExact(divisor);
+    CHECK(f == quotient);
+    CHECK(e == multiple);
+    e.divExact(divisor);
+    CHECK(e == quotient);
+    APInt g = negate(multiple);
+    g.share();
+    APInt h = g;
+    h.sdivExact(divisor);
+    CHECK(h == negate(quotient));
+    CHECK(g == negate(multiple));
+    g.sdivExact(divisor);
+    CHECK(g == negate(quotient));
+}
+
+TEST_CASE("Shared storage - 2") {
+    std::mt19937_64 rng(2);
+    APInt shared = randomAPInt(rng, 1000);
+    APInt const value = shared;
+    shared.share();
+    APInt const negated = negate(value);
+    std::atomic<int> numMismatches = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 1000; ++i) {
+                APInt copy = shared;
+                if (i % 10 == t) {
+                    copy.negate();
+                    numMismatches += copy != negated;
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    CHECK(numMismatches == 0);
+    CHECK(shared.useCount() == 1);
+    CHECK(shared == value);
+}
+
+TEST_CASE("Byte conversion - 1") {
+    std::array<std::byte, 5> const bytes = { std::byte(0x01),
+                                             std::byte(0x23),
+                                             std::byte(0x45),
+                                             std::byte(0x67),
+                                             std::byte(0x89) };
+    CHECK(APInt::fromBytes(bytes, std::endian::little, 40) ==
+          APInt(0x8967452301, 40));
+    CHECK(APInt::fromBytes(bytes, std::endian::big, 40) ==
+          APInt(0x0123456789, 40));
+    CHECK(APInt::fromBytes(bytes, std::endian::big, 12) == APInt(0x123, 12));
+    CHECK(APInt::fromBytes(bytes, std::endian::little, 12) == APInt(0x301, 12));
+    std::array<std::byte, 5> out{};
+    APInt(0x0123456789, 40).toBytes(out, std::endian::big);
+    CHECK(out == bytes);
+    auto const values = APInt::fromBytes(bytes, std::endian::big, 16, 2);
+    CHECK(values == std::vector{ APInt(0x0123, 16), APInt(0x4567, 16) });
+    std::array<std::byte, 6> padded{};
+    APInt::toBytes(values, padded, std::endian::little, 3);
+    CHECK(padded == std::array{ std::byte(0x23),
+                                std::byte(0x01),
+                                std::byte(0),
+                                std::byte(0x67),
+                                std::byte(0x45),
+                                std::byte(0) });
+}
+
+TEST_CASE("Byte conversion - 2") {
+    size_t const bitwidth = GENERATE(1u, 8u, 24u, 64u, 70u, 128u, 300u);
+    std::mt19937_64 rng(bitwidth);
+    size_t const numBytes = (bitwidth + 7) / 8;
+    for (int i = 0; i < 10; ++i) {
+        APInt const a = randomAPInt(rng, bitwidth);
+        std::vector<std::byte> little(numBytes), big(numBytes);
+        a.toBytes(little, std::endian::little);
+        a.toBytes(big, std::endian::big);
+        for (size_t j = 0; j < numBytes; ++j) {
+            auto const expected = std::byte(a.limb(j / 8) >> (j % 8 * 8));
+            CHECK(little[j] == expected);
+            CHECK(big[numBytes - 1 - j] == expected);
+        }
+        CHECK(APInt::fromBytes(little, std::endian::little, bitwidth) == a);
+        CHECK(APInt::fromBytes(big, std::endian::big, bitwidth) == a);
+    }
+    std::vector<APInt> values;
+    for (int i = 0; i < 7; ++i) {
+        values.push_back(randomAPInt(rng, bitwidth));
+    }
+    size_t const stride = numBytes + 5;
+    std::vector<std::byte> buffer(values.size() * stride);
+    for (auto endian: { std::endian::little, std::endian::big }) {
+        APInt::toBytes(values, buffer, endian, stride);
+        CHECK(APInt::fromBytes(buffer, endian, bitwidth, stride) == values);
+    }
+}
+
 TEST_CASE("zext - 1") {
     APInt a(6, 3);
     a.zext(64);
@@ -443,6 +880,22 @@ TEST_CASE("String conversion") {
     CHECK(APInt(0xFF, 64).signedToString(10) == "255");
 }
 
+TEST_CASE("String conversion - large") {
+    /// Large enough to take the divide and conquer path
+    size_t const k = 2000;
+    APInt x(1, 8192);
+    for (size_t i = 0; i < k; ++i) {
+        x.mul(APInt(10, 8192));
+    }
+    CHECK(x.toString(10) == "1" + std::string(k, '0'));
+    x.sub(APInt(1, 8192));
+    CHECK(x.toString(10) == std::string(k, '9'));
+    std::mt19937_64 rng(42);
+    int const base = GENERATE(2, 7, 10, 16, 36);
+    APInt const y = randomAPInt(rng, 64 * 150 - 5);
+    CHECK(APInt::parse(y.toString(base), base, y.bitwidth()).value() == y);
+}
+
 TEST_CASE("String parse - 1") {
     APInt const a = APInt::parse(" - f'F", 16).value();
     CHECK(a.bitwidth() == 9);
@@ -462,6 +915,8 @@ TEST_CASE("String parse - 2") {
     CHECK(!a);
     auto b = APInt::parse("-127", 10, 8).value();
     CHECK(b == 129); // 129 == -127 in 8 bit two's complement
+    CHECK(APInt::parse("21", 3, 8).value() == 7);
+    CHECK(APInt::parse("-16", 7, 8).value() == 243);
 }
 
 TEST_CASE("Conversion to native") {
@@ -502,3 +957,227 @@ TEST_CASE("Min/Max") {
                APInt::parse("0xFFFF'FFFF'FFFF'FFFF'FFFF", 16, 80).value()) ==
           0);
 }
+
+static APInt referenceGCD(APInt a, APInt b) {
+    while (b.any()) {
+        a = urem(a, b);
+        a.swap(b);
+    }
+    return a;
+}
+
+TEST_CASE("gcd - 1") {
+    CHECK(gcd(APInt(12, 64), APInt(18, 64)) == 6);
+    CHECK(gcd(APInt(0, 64), APInt(18, 64)) == 18);
+    CHECK(gcd(APInt(18, 64), APInt(0, 64)) == 18);
+    CHECK(gcd(APInt(0, 64), APInt(0, 64)) == 0);
+    CHECK(gcd(APInt(17, 64), APInt(5, 64)) == 1);
+    CHECK(gcd(APInt(1, 1), APInt(1, 1)) == 1);
+    APInt const a = APInt::parse("1234567890123456789012345678901234567890",
+                                 10,
+                                 256)
+                        .value();
+    APInt const b = APInt::parse("9876543210987654321098765432109876543210",
+                                 10,
+                                 256)
+                        .value();
+    CHECK(gcd(a, b).toString() == "90000000009000000000900000000090");
+}
+
+TEST_CASE("gcd - 2") {
+    size_t const bitwidth = GENERATE(8u, 64u, 100u, 128u, 192u, 320u, 640u);
+    std::mt19937_64 rng(bitwidth);
+    for (int i = 0; i < 20; ++i) {
+        APInt const g = lshr(randomAPInt(rng, bitwidth), int(bitwidth / 2));
+        APInt const a = mul(randomAPInt(rng, bitwidth).lshr(int(bitwidth / 2)),
+                            g);
+        APInt const b = mul(randomAPInt(rng, bitwidth).lshr(int(bitwidth / 3)),
+                            g);
+        INFO("a = " << a.toString() << "\nb = " << b.toString());
+        APInt const ref = referenceGCD(a, b);
+        CHECK(gcd(a, b) == ref);
+        CHECK(gcd(b, a) == ref);
+        auto const [g2, x, y] = egcd(a, b);
+        CHECK(g2 == ref);
+        CHECK(add(mul(a, x), mul(b, y)) == ref);
+    }
+}
+
+TEST_CASE("egcd - 1") {
+    auto const [g, x, y] = egcd(APInt(240, 32), APInt(46, 32));
+    CHECK(g == 2);
+    CHECK(x.signedToString() == "-9");
+    CHECK(y.signedToString() == "47");
+    auto const [g0, x0, y0] = egcd(APInt(0, 32), APInt(7, 32));
+    CHECK(g0 == 7);
+    CHECK(x0 == 0);
+    CHECK(y0 == 1);
+}
+
+TEST_CASE("modInverse - 1") {
+    /// 2^127 - 1 is prime
+    APInt const m = APInt::SMax(128);
+    size_t const bitwidth = GENERATE(128u, 256u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const mExt = zext(m, bitwidth);
+    for (int i = 0; i < 20; ++i) {
+        APInt const a = randomAPInt(rng, bitwidth);
+        if (urem(a, mExt).none()) {
+            continue;
+        }
+        auto const inv = modInverse(a, mExt);
+        REQUIRE(inv);
+        CHECK(inv->ucmp(mExt) < 0);
+        APInt const prod =
+            mul(zext(urem(a, mExt), 2 * bitwidth), zext(*inv, 2 * bitwidth));
+        CHECK(urem(prod, zext(mExt, 2 * bitwidth)) == 1);
+    }
+    CHECK(!modInverse(APInt(6, 64), APInt(9, 64)));
+    CHECK(!modInverse(APInt(6, 64), APInt(0, 64)));
+    CHECK(modInverse(APInt(3, 64), APInt(7, 64)).value() == 5);
+    CHECK(modInverse(APInt(5, 64), APInt(1, 64)).value() == 0);
+}
+
+TEST_CASE("lcm - 1") {
+    CHECK(lcm(APInt(4, 64), APInt(6, 64)) == 12);
+    CHECK(lcm(APInt(0, 64), APInt(6, 64)) == 0);
+    CHECK(lcm(APInt(7, 200), APInt(13, 200)) == 91);
+    APInt const a = APInt({ 0, 6 }, 256);
+    APInt const b = APInt({ 0, 0, 10 }, 256);
+    CHECK(lcm(a, b) == APInt({ 0, 0, 30 }, 256));
+}
+
+TEST_CASE("isqrt - 1") {
+    CHECK(isqrt(APInt(0, 64)) == 0);
+    CHECK(isqrt(APInt(1, 64)) == 1);
+    CHECK(isqrt(APInt(15, 64)) == 3);
+    CHECK(isqrt(APInt(16, 64)) == 4);
+    CHECK(isqrt(APInt::UMax(64)) == 0xFFFF'FFFF);
+    CHECK(isqrt(APInt::UMax(128)) == APInt::UMax(64).zext(128));
+    CHECK(isqrt(APInt::UMax(7)) == 11);
+}
+
+TEST_CASE("iroot - 1") {
+    size_t const bitwidth = GENERATE(32u, 64u, 65u, 128u, 256u, 1000u);
+    unsigned const k = GENERATE(2u, 3u, 5u, 17u);
+    std::mt19937_64 rng(bitwidth * k);
+    size_t const wide = bitwidth * (k + 1);
+    for (int i = 0; i < 10; ++i) {
+        APInt const n = randomAPInt(rng, bitwidth).lshr(i * 3);
+        APInt const r = iroot(n, k);
+        APInt power(1, wide);
+        APInt nextPower(1, wide);
+        for (unsigned j = 0; j < k; ++j) {
+            power.mul(zext(r, wide));
+            nextPower.mul(add(zext(r, wide), APInt(1, wide)));
+        }
+        INFO("n = " << n.toString() << ", k = " << k);
+        CHECK(power.ucmp(zext(n, wide)) <= 0);
+        CHECK(nextPower.ucmp(zext(n, wide)) > 0);
+    }
+}
+
+TEST_CASE("ilog - 1") {
+    CHECK(ilog2(APInt(1, 64)) == 0);
+    CHECK(ilog2(APInt(255, 64)) == 7);
+    CHECK(ilog2(APInt({ 0, 1 }, 128)) == 64);
+    CHECK(ilog(APInt(999, 64), 10) == 2);
+    CHECK(ilog(APInt(1000, 64), 10) == 3);
+    CHECK(ilog(APInt(80, 64), 3) == 3);
+    CHECK(ilog(APInt(81, 64), 3) == 4);
+    CHECK(ilog(APInt(64, 64), 8) == 2);
+    CHECK(numDigits(APInt(0, 8)) == 1);
+    CHECK(numDigits(APInt(255, 8), 16) == 2);
+    size_t const bitwidth = GENERATE(64u, 65u, 128u, 256u, 1000u);
+    unsigned const base = GENERATE(3u, 7u, 10u, 36u);
+    std::mt19937_64 rng(bitwidth * base);
+    for (int i = 0; i < 10; ++i) {
+        APInt const n = randomAPInt(rng, bitwidth).lshr(i * 5);
+        CHECK(numDigits(n, base) == n.toString(int(base)).size());
+    }
+    APInt power(1, 512);
+    for (int i = 0; i < 150; ++i) {
+        power.mul(APInt(10, 512));
+    }
+    CHECK(ilog(power, 10) == 150);
+    CHECK(ilog(sub(power, APInt(1, 512)), 10) == 149);
+}
+
+TEST_CASE("powMod - 1") {
+    CHECK(powMod(APInt(3, 64), APInt(4, 64), APInt(5, 64)) == 1);
+    CHECK(powMod(APInt(7, 64), APInt(0, 64), APInt(13, 64)) == 1);
+    CHECK(powMod(APInt(7, 64), APInt(5, 64), APInt(1, 64)) == 0);
+    /// Fermat's little theorem for the prime 2^127 - 1
+    APInt const p = APInt::SMax(128);
+    APInt const pMinus1 = sub(p, APInt(1, 128));
+    for (uint64_t a: { 2u, 3u, 12345u }) {
+        CHECK(powMod(APInt(a, 128), pMinus1, p) == 1);
+    }
+    /// Even modulus 2^70 against truncating multiplication
+    APInt const mod = lshl(APInt(1, 128), 70);
+    APInt ref(1, 70);
+    for (int i = 0; i < 100; ++i) {
+        ref.mul(APInt(3, 70));
+    }
+    CHECK(powMod(APInt(3, 128), APInt(100, 128), mod) == zext(ref, 128));
+}
+
+TEST_CASE("isProbablePrime - 1") {
+    std::vector<bool> sieve(5000, true);
+    sieve[0] = sieve[1] = false;
+    for (size_t i = 2; i < sieve.size(); ++i) {
+        for (size_t j = 2 * i; sieve[i] && j < sieve.size(); j += i) {
+            sieve[j] = false;
+        }
+    }
+    for (size_t i = 0; i < sieve.size(); ++i) {
+        INFO(i);
+        CHECK(isProbablePrime(APInt(i, 64)) == sieve[i]);
+    }
+    /// Carmichael numbers and strong pseudoprimes to several bases
+    for (uint64_t n: { 561ull,
+                       41041ull,
+                       3215031751ull,
+                       3825123056546413051ull,
+                       18446744073709551615ull })
+    {
+        INFO(n);
+        CHECK(!isProbablePrime(APInt(n, 64)));
+    }
+    CHECK(isProbablePrime(APInt((uint64_t(1) << 61) - 1, 64)));
+    CHECK(isProbablePrime(APInt(18446744073709551557ull, 64)));
+}
+
+TEST_CASE("isProbablePrime - 2") {
+    auto mersenne = [](size_t exp, size_t bitwidth) {
+        return zext(APInt::UMax(exp), bitwidth);
+    };
+    CHECK(isProbablePrime(mersenne(89, 128)));
+    CHECK(isProbablePrime(mersenne(127, 128)));
+    CHECK(isProbablePrime(mersenne(521, 600)));
+    CHECK(isProbablePrime(mersenne(1279, 1279)));
+    CHECK(!isProbablePrime(mersenne(67, 128)));
+    CHECK(!isProbablePrime(mul(mersenne(127, 256), mersenne(61, 256))));
+    CHECK(!isProbablePrime(mul(mersenne(107, 256), mersenne(107, 256))));
+    /// Strong pseudoprime to all prime bases up to 37
+    CHECK(!isProbablePrime(
+        APInt::parse("318665857834031151167461", 10, 128).value()));
+}
+
+TEST_CASE("nextPrime - 1") {
+    CHECK(nextPrime(APInt(0, 64)).value() == 2);
+    CHECK(nextPrime(APInt(2, 64)).value() == 3);
+    CHECK(nextPrime(APInt(13, 64)).value() == 17);
+    CHECK(nextPrime(APInt(996, 64)).value() == 997);
+    CHECK(nextPrime(APInt(997, 64)).value() == 1009);
+    CHECK(!nextPrime(APInt(1, 1)));
+    CHECK(!nextPrime(APInt(0, 1)));
+    CHECK(!nextPrime(APInt(7, 3)));
+    CHECK(!nextPrime(APInt(18446744073709551557ull, 64)));
+    CHECK(nextPrime(APInt(18446744073709551557ull, 65)).value() ==
+          APInt({ 13, 1 }, 65));
+    CHECK(nextPrime(lshl(APInt(1, 256), 200)).value() ==
+          add(lshl(APInt(1, 256), 200), APInt(235, 256)));
+    CHECK(nextPrime(lshl(APInt(1, 520), 512)).value() ==
+          add(lshl(APInt(1, 520), 512), APInt(75, 520)));
+}
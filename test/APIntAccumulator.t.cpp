@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/APIntAccumulator.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+TEST_CASE("APIntAccumulator - 1") {
+    APIntAccumulator acc(128);
+    CHECK(acc.value() == APInt(0, 128));
+    acc.add(APInt({ ~0ull, 0 }, 128));
+    acc.add(1);
+    CHECK(acc.value() == APInt({ 0, 1 }, 128));
+    acc.sub(2);
+    CHECK(acc.value() == APInt({ ~0ull - 1, 0 }, 128));
+    acc.sub(APInt({ 0, 1 }, 128));
+    CHECK(acc.value() == APInt({ ~0ull - 1, ~0ull }, 128));
+    acc.mulAdd(APInt({ 0, 1 }, 128), 2);
+    CHECK(acc.value() == APInt({ ~0ull - 1, 1 }, 128));
+    acc.clear();
+    CHECK(acc.value() == APInt(0, 128));
+    APIntAccumulator acc2(APInt(0x7F, 7));
+    acc2.add(1);
+    CHECK(acc2.value() == APInt(0, 7));
+}
+
+TEST_CASE("APIntAccumulator - 2") {
+    size_t const bitwidth = GENERATE(1u, 7u, 64u, 65u, 127u, 128u, 300u);
+    std::mt19937_64 rng(bitwidth);
+    APIntAccumulator acc(bitwidth);
+    APInt ref(0, bitwidth);
+    for (int i = 0; i < 200; ++i) {
+        APInt const a = randomAPInt(rng, bitwidth);
+        APInt const b = randomAPInt(rng, bitwidth);
+        uint64_t const c = rng();
+        switch (i % 6) {
+        case 0:
+            acc.add(a);
+            ref.add(a);
+            break;
+        case 1:
+            acc.sub(a);
+            ref.sub(a);
+            break;
+        case 2:
+            acc.add(c);
+            ref.add(APInt(c, bitwidth));
+            break;
+        case 3:
+            acc.sub(c);
+            ref.sub(APInt(c, bitwidth));
+            break;
+        case 4:
+            acc.mulAdd(a, b);
+            ref.add(mul(a, b));
+            break;
+        case 5:
+            acc.mulAdd(a, c);
+            ref.add(mul(a, APInt(c, bitwidth)));
+            break;
+        }
+        if (i % 17 == 0) {
+            CHECK(acc.value() == ref);
+        }
+    }
+    CHECK(acc.value() == ref);
+}
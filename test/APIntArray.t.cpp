@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/APIntArray.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+TEST_CASE("APIntArray - 1") {
+    APIntArray a(10, 8);
+    CHECK(a.size() == 10);
+    CHECK(a.bitwidth() == 8);
+    CHECK(a.limbs().size() == 2);
+    a[3] = APInt(0xAB, 8);
+    a[4] = 0x1CDull;
+    CHECK(a[3] == APInt(0xAB, 8));
+    CHECK(a[4].to64() == 0xCD);
+    CHECK(a.limbs()[0] == 0xCDAB000000ull);
+    a[4].add(APInt(0x33, 8));
+    CHECK(a[4].to64() == 0);
+    a[5] = a[3];
+    CHECK(a[5].ucmp(APInt(0xAB, 8)) == 0);
+    CHECK(a[5].scmp(APInt(0, 8)) < 0);
+    APInt const value = a[5];
+    CHECK(value == APInt(0xAB, 8));
+    a.push_back(APInt(1, 8));
+    CHECK(a.size() == 11);
+    CHECK(a[10] == APInt(1, 8));
+    a.resize(4);
+    CHECK(a.limbs().size() == 1);
+    CHECK(a.limbs()[0] == 0xAB000000ull);
+}
+
+TEST_CASE("APIntArray - 2") {
+    size_t const bitwidth = GENERATE(1u, 3u, 8u, 16u, 31u, 64u, 65u, 100u);
+    std::mt19937_64 rng(bitwidth);
+    size_t const size = 301;
+    std::vector<APInt> ref;
+    for (size_t i = 0; i < size; ++i) {
+        ref.push_back(randomAPInt(rng, bitwidth));
+    }
+    APIntArray a(ref);
+    CHECK(a.toAPInts() == ref);
+    CHECK(a.limbs().size() == (size * bitwidth + 63) / 64);
+    /// Fill
+    for (auto [index, count]: { std::pair<size_t, size_t>{ 0, size },
+                                { 1, 3 },
+                                { 7, 200 },
+                                { 150, 151 } })
+    {
+        APInt const value = randomAPInt(rng, bitwidth);
+        a.fill(index, count, value);
+        std::fill(ref.begin() + index, ref.begin() + index + count, value);
+        CHECK(a.toAPInts() == ref);
+    }
+    /// Copy between arrays and within an array in both directions
+    std::vector<APInt> other;
+    for (size_t i = 0; i < size; ++i) {
+        other.push_back(randomAPInt(rng, bitwidth));
+    }
+    APIntArray const b(other);
+    APIntArray::copy(a, 5, b, 17, 250);
+    std::copy(other.begin() + 17, other.begin() + 267, ref.begin() + 5);
+    CHECK(a.toAPInts() == ref);
+    CHECK(APIntArray::equal(a, 5, b, 17, 250));
+    CHECK(!APIntArray::equal(a, 4, b, 17, 250));
+    APIntArray::copy(a, 3, a, 50, 200);
+    std::copy(ref.begin() + 50, ref.begin() + 250, ref.begin() + 3);
+    CHECK(a.toAPInts() == ref);
+    APIntArray::copy(a, 90, a, 1, 200);
+    std::copy_backward(ref.begin() + 1, ref.begin() + 201, ref.begin() + 290);
+    CHECK(a.toAPInts() == ref);
+    CHECK(a == APIntArray(ref));
+    a[size - 1].btwxor(APInt(1, bitwidth));
+    CHECK(a != APIntArray(ref));
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/APIntPool.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+TEST_CASE("APIntPool - 1") {
+    APIntPool pool;
+    APIntView const zero = pool.intern(APInt(0, 64));
+    APIntView const one = pool.intern(APInt(1, 64));
+    CHECK(zero == 0);
+    CHECK(one == 1);
+    CHECK(pool.intern(APInt(0, 64)).limbs().data() == zero.limbs().data());
+    CHECK(pool.intern(APInt(1, 64)).limbs().data() == one.limbs().data());
+    /// Same limbs but different bitwidth is a different value
+    APIntView const zero32 = pool.intern(APInt(0, 32));
+    CHECK(zero32.bitwidth() == 32);
+    CHECK(zero32.limbs().data() != zero.limbs().data());
+    /// Wide values are copied into the pool
+    APInt wide = APInt::UMax(300);
+    APIntView const pooledWide = pool.intern(wide);
+    CHECK(pooledWide.limbs().data() != wide.limbs().data());
+    wide.clear(0);
+    CHECK(pooledWide == APIntView(APInt::UMax(300)));
+    CHECK(pool.contains(APInt::UMax(300)));
+    CHECK(!pool.contains(wide));
+    CHECK(pool.size() == 4);
+    auto const stats = pool.statistics();
+    CHECK(stats.numValues == 4);
+    CHECK(stats.numLookups == 6);
+    CHECK(stats.numHits == 2);
+    CHECK(stats.limbBytes == 8 * (1 + 1 + 1 + 5));
+    CHECK(stats.arenaBytes >= stats.limbBytes);
+    CHECK(stats.tableBytes > 0);
+}
+
+TEST_CASE("APIntPool - 2") {
+    APIntPool pool(1);
+    std::mt19937_64 rng(2);
+    APIntView const a = pool.intern(APInt(1, 64));
+    /// Large values get a block of their own and leave the arena of the small
+    /// values intact
+    (void)pool.intern(randomAPInt(rng, 300 * 64));
+    APIntView const b = pool.intern(APInt(2, 64));
+    (void)pool.intern(randomAPInt(rng, 300 * 64));
+    CHECK(b.limbs().data() == a.limbs().data() + 1);
+    auto const stats = pool.statistics();
+    CHECK(stats.limbBytes == 8 * (1 + 300 + 1 + 300));
+    CHECK(stats.arenaBytes == 8 * (512 + 300 + 300));
+}
+
+TEST_CASE("APIntPool concurrent interning") {
+    size_t const numShards = GENERATE(1u, 16u);
+    APIntPool pool(numShards);
+    std::mt19937_64 rng(numShards);
+    std::vector<APInt> values;
+    for (size_t i = 0; i < 200; ++i) {
+        values.push_back(randomAPInt(rng, 65 + rng() % 300));
+    }
+    size_t const numThreads = 4;
+    std::vector<std::vector<APIntView>> results(numThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t k = 0; k < 5; ++k) {
+                for (size_t i = 0; i < values.size(); ++i) {
+                    /// Each thread interns fresh copies in a different order
+                    APInt const copy = values[(i * (t + 1)) % values.size()];
+                    results[t].push_back(pool.intern(copy));
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    CHECK(pool.size() == values.size());
+    for (size_t t = 0; t < numThreads; ++t) {
+        for (size_t j = 0; j < results[t].size(); ++j) {
+            size_t const i = j % values.size();
+            APInt const& value = values[(i * (t + 1)) % values.size()];
+            APIntView const pooled = pool.intern(value);
+            CHECK(results[t][j].limbs().data() == pooled.limbs().data());
+            CHECK(results[t][j].bitwidth() == value.bitwidth());
+            CHECK(results[t][j] == APIntView(value));
+        }
+    }
+    auto const stats = pool.statistics();
+    CHECK(stats.numValues == values.size());
+    CHECK(stats.numHits == stats.numLookups - values.size());
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/APIntRef.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+TEST_CASE("APIntView - 1") {
+    uint64_t const buffer[] = { 0, 0xF0, 0x3, ~0ull };
+    /// A 66 bit integer in the middle of the buffer
+    APIntView const v(buffer + 1, 66);
+    CHECK(v.numLimbs() == 2);
+    CHECK(v.limb(1) == 0x3);
+    CHECK(v.test(4));
+    CHECK(!v.test(3));
+    CHECK(v.popcount() == 6);
+    CHECK(v.ctz() == 4);
+    CHECK(v.clz() == 0);
+    CHECK(v.any());
+    CHECK(!v.all());
+    CHECK(v.negative());
+    CHECK(v.to<uint32_t>() == 0xF0);
+    CHECK(v.toString(16) == "300000000000000F0");
+    APInt const copy = v.toAPInt();
+    CHECK(copy == APInt({ 0xF0, 0x3 }, 66));
+    CHECK(v == copy);
+    CHECK(v.hash() == copy.hash());
+    CHECK(v.ucmp(APInt({ 0xF1, 0x3 }, 66)) < 0);
+    CHECK(v.scmp(APInt(1, 66)) < 0);
+    CHECK(APIntView(buffer, 64).none());
+    CHECK(APIntView(buffer, 64) == 0);
+    std::unordered_set<APIntView> set = { v, APIntView(buffer, 64) };
+    CHECK(set.contains(APIntView(copy)));
+}
+
+TEST_CASE("APIntRef - 1") {
+    size_t const bitwidth = GENERATE(1u, 13u, 64u, 65u, 128u, 300u);
+    std::mt19937_64 rng(bitwidth);
+    for (int i = 0; i < 20; ++i) {
+        APInt const a = randomAPInt(rng, bitwidth);
+        APInt const b = randomAPInt(rng, bitwidth);
+        int const shift = static_cast<int>(rng() % bitwidth);
+        size_t const bit = rng() % bitwidth;
+        /// The referenced integer lives in a buffer with guard limbs on both
+        /// sides that must not be touched
+        std::vector<uint64_t> buffer(a.limbs().size() + 2, 0x5A5A);
+        auto ref = [&] {
+            std::copy(a.limbs().begin(), a.limbs().end(), buffer.begin() + 1);
+            return APIntRef(buffer.data() + 1, bitwidth);
+        };
+        CHECK(ref().add(b) == add(a, b));
+        CHECK(ref().sub(b) == sub(a, b));
+        CHECK(ref().mul(b) == mul(a, b));
+        CHECK(ref().btwand(b) == btwand(a, b));
+        CHECK(ref().btwor(b) == btwor(a, b));
+        CHECK(ref().btwxor(b) == btwxor(a, b));
+        CHECK(ref().lshl(shift) == lshl(a, shift));
+        CHECK(ref().lshr(shift) == lshr(a, shift));
+        CHECK(ref().ashr(shift) == ashr(a, shift));
+        CHECK(ref().negate() == negate(a));
+        CHECK(ref().flip() == btwnot(a));
+        CHECK(ref().flip(bit) == APInt(a).flip(bit));
+        CHECK(ref().set(bit) == APInt(a).set(bit));
+        CHECK(ref().clear(bit) == APInt(a).clear(bit));
+        CHECK(ref().assign(b) == b);
+        APIntRef r = ref();
+        CHECK(r.add(r) == add(a, a));
+        CHECK(buffer.front() == 0x5A5A);
+        CHECK(buffer.back() == 0x5A5A);
+    }
+    APInt value(0, 100);
+    APIntRef(value).set(99).add(APInt(1, 100));
+    CHECK(value == APInt({ 1, uint64_t(1) << 35 }, 100));
+}
@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/APIntVector.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+/// \Returns a random integer that is small or has all bits set in half of
+/// the cases
+static APInt randomOperand(std::mt19937_64& rng, size_t bitwidth) {
+    APInt const value = randomAPInt(rng, bitwidth);
+    switch (rng() % 4) {
+    case 0:
+        return APInt(rng() % 4, bitwidth);
+    case 1:
+        return APInt::UMax(bitwidth);
+    default:
+        return value;
+    }
+}
+
+static std::vector<APInt> randomAPInts(std::mt19937_64& rng,
+                                       size_t size,
+                                       size_t bitwidth) {
+    std::vector<APInt> result;
+    for (size_t i = 0; i < size; ++i) {
+        result.push_back(randomOperand(rng, bitwidth));
+    }
+    return result;
+}
+
+TEST_CASE("APIntVector - 1") {
+    APIntVector v(3, 100);
+    CHECK(v.size() == 3);
+    CHECK(v.bitwidth() == 100);
+    CHECK(v.numLimbs() == 2);
+    CHECK(v.element(1) == APInt(0, 100));
+    v.setElement(1, APInt({ 1, 2 }, 100));
+    CHECK(v.element(1) == APInt({ 1, 2 }, 100));
+    CHECK(v.limbs(1)[1] == 2);
+    std::vector<APInt> elems = { APInt(1, 8), APInt(255, 8), APInt(7, 8) };
+    APIntVector w(elems);
+    CHECK(w.toAPInts() == elems);
+    w.add(APIntVector(std::vector{ APInt(1, 8), APInt(1, 8), APInt(1, 8) }));
+    CHECK(w.toAPInts() ==
+          std::vector{ APInt(2, 8), APInt(0, 8), APInt(8, 8) });
+}
+
+TEST_CASE("APIntVector - 2") {
+    size_t const bitwidth = GENERATE(1u, 8u, 33u, 64u, 65u, 128u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    size_t const size = 37;
+    auto const a = randomAPInts(rng, size, bitwidth);
+    auto const b = randomAPInts(rng, size, bitwidth);
+    APIntVector const va(a), vb(b);
+    auto check = [&](APIntVector const& result, auto op) {
+        REQUIRE(result.size() == size);
+        for (size_t i = 0; i < size; ++i) {
+            INFO("bitwidth = " << bitwidth << ", i = " << i);
+            CHECK(result.element(i) == op(a[i], b[i]));
+        }
+    };
+    check(add(va, vb),
+          [](APInt const& x, APInt const& y) { return add(x, y); });
+    check(sub(va, vb),
+          [](APInt const& x, APInt const& y) { return sub(x, y); });
+    check(mul(va, vb),
+          [](APInt const& x, APInt const& y) { return mul(x, y); });
+    check(btwand(va, vb),
+          [](APInt const& x, APInt const& y) { return btwand(x, y); });
+    check(btwor(va, vb),
+          [](APInt const& x, APInt const& y) { return btwor(x, y); });
+    check(btwxor(va, vb),
+          [](APInt const& x, APInt const& y) { return btwxor(x, y); });
+    check(negate(va), [](APInt const& x, APInt const&) { return negate(x); });
+    check(btwnot(va), [](APInt const& x, APInt const&) { return btwnot(x); });
+    for (int s: { 0, 1, 7, 31, 63, 64, 65, 127, 130, 199 }) {
+        if (s >= (int)bitwidth) {
+            continue;
+        }
+        check(lshl(va, s),
+              [&](APInt const& x, APInt const&) { return lshl(x, s); });
+        check(lshr(va, s),
+              [&](APInt const& x, APInt const&) { return lshr(x, s); });
+        check(ashr(va, s),
+              [&](APInt const& x, APInt const&) { return ashr(x, s); });
+    }
+    auto checkCmp = [&](CmpPredicate pred, auto op) {
+        APIntVector const mask = cmp(pred, va, vb);
+        CHECK(mask.bitwidth() == 1);
+        check(mask, [&](APInt const& x, APInt const& y) {
+            return APInt(op(x, y), 1);
+        });
+        check(select(mask, va, vb),
+              [&](APInt const& x, APInt const& y) { return op(x, y) ? x : y; });
+    };
+    checkCmp(CmpPredicate::EQ,
+             [](APInt const& x, APInt const& y) { return ucmp(x, y) == 0; });
+    checkCmp(CmpPredicate::NE,
+             [](APInt const& x, APInt const& y) { return ucmp(x, y) != 0; });
+    checkCmp(CmpPredicate::ULT,
+             [](APInt const& x, APInt const& y) { return ucmp(x, y) < 0; });
+    checkCmp(CmpPredicate::ULE,
+             [](APInt const& x, APInt const& y) { return ucmp(x, y) <= 0; });
+    checkCmp(CmpPredicate::UGT,
+             [](APInt const& x, APInt const& y) { return ucmp(x, y) > 0; });
+    checkCmp(CmpPredicate::UGE,
+             [](APInt const& x, APInt const& y) { return ucmp(x, y) >= 0; });
+    checkCmp(CmpPredicate::SLT,
+             [](APInt const& x, APInt const& y) { return scmp(x, y) < 0; });
+    checkCmp(CmpPredicate::SLE,
+             [](APInt const& x, APInt const& y) { return scmp(x, y) <= 0; });
+    checkCmp(CmpPredicate::SGT,
+             [](APInt const& x, APInt const& y) { return scmp(x, y) > 0; });
+    checkCmp(CmpPredicate::SGE,
+             [](APInt const& x, APInt const& y) { return scmp(x, y) >= 0; });
+}
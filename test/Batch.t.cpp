@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+#include <APMath/Batch.h>
+#include <APMath/Parallel.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+TEST_CASE("Batch evaluate APInt") {
+    unsigned const numThreads = GENERATE(1u, 4u);
+    setParallelOptions({ .numThreads = numThreads, .batchSize = 7 });
+    std::mt19937_64 rng(numThreads);
+    size_t const bitwidth = 150;
+    using IntFn = APInt (*)(APInt const&, APInt const&);
+    IntFn const reference[] = {
+        [](APInt const& a, APInt const& b) { return add(a, b); },
+        [](APInt const& a, APInt const& b) { return sub(a, b); },
+        [](APInt const& a, APInt const& b) { return mul(a, b); },
+        [](APInt const& a, APInt const& b) { return udiv(a, b); },
+        [](APInt const& a, APInt const& b) { return urem(a, b); },
+        [](APInt const& a, APInt const& b) { return sdiv(a, b); },
+        [](APInt const& a, APInt const& b) { return srem(a, b); },
+        [](APInt const& a, APInt const& b) { return btwand(a, b); },
+        [](APInt const& a, APInt const& b) { return btwor(a, b); },
+        [](APInt const& a, APInt const& b) { return btwxor(a, b); },
+        [](APInt const& a, APInt const& b) { return lshl(a, b.to<int>()); },
+        [](APInt const& a, APInt const& b) { return lshr(a, b.to<int>()); },
+        [](APInt const& a, APInt const& b) { return ashr(a, b.to<int>()); },
+        [](APInt const& a, APInt const& b) { return APInt(a == b, 1); },
+        [](APInt const& a, APInt const& b) { return APInt(a != b, 1); },
+        [](APInt const& a, APInt const& b) {
+            return APInt(ucmp(a, b) < 0, 1);
+        },
+        [](APInt const& a, APInt const& b) {
+            return APInt(ucmp(a, b) <= 0, 1);
+        },
+        [](APInt const& a, APInt const& b) {
+            return APInt(ucmp(a, b) > 0, 1);
+        },
+        [](APInt const& a, APInt const& b) {
+            return APInt(ucmp(a, b) >= 0, 1);
+        },
+        [](APInt const& a, APInt const& b) {
+            return APInt(scmp(a, b) < 0, 1);
+        },
+        [](APInt const& a, APInt const& b) {
+            return APInt(scmp(a, b) <= 0, 1);
+        },
+        [](APInt const& a, APInt const& b) {
+            return APInt(scmp(a, b) > 0, 1);
+        },
+        [](APInt const& a, APInt const& b) {
+            return APInt(scmp(a, b) >= 0, 1);
+        },
+    };
+    size_t const numOps = std::size(reference);
+    static_assert(std::size(reference) == (size_t)APIntOp::CmpSGE + 1);
+    std::vector<APInt> lhs, rhs;
+    for (size_t i = 0; i < 10 * numOps; ++i) {
+        lhs.push_back(randomAPInt(rng, bitwidth));
+        rhs.push_back(APInt(1 + rng() % (bitwidth - 1), bitwidth));
+    }
+    std::vector<APIntOperation> operations;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        operations.push_back({ APIntOp(i % numOps), &lhs[i], &rhs[i] });
+    }
+    std::vector<APInt> results(operations.size());
+    evaluate(operations, results);
+    for (size_t i = 0; i < operations.size(); ++i) {
+        APInt const& a = lhs[i];
+        APInt const& b = rhs[i];
+        APInt const expected = reference[i % numOps](a, b);
+        INFO("i = " << i);
+        CHECK(results[i] == expected);
+    }
+    setParallelOptions({});
+}
+
+TEST_CASE("Batch evaluate APFloat") {
+    setParallelOptions({ .numThreads = 3, .batchSize = 5 });
+    using FloatFn = APFloat (*)(APFloat const&, APFloat const&);
+    FloatFn const reference[] = {
+        [](APFloat const& a, APFloat const& b) { return add(a, b); },
+        [](APFloat const& a, APFloat const& b) { return sub(a, b); },
+        [](APFloat const& a, APFloat const& b) { return mul(a, b); },
+        [](APFloat const& a, APFloat const& b) { return div(a, b); },
+        [](APFloat const& a, APFloat const& b) { return pow(a, b); },
+        [](APFloat const& a, APFloat const& b) { return hypot(a, b); },
+    };
+    std::vector<APFloat> lhs, rhs;
+    for (int i = 1; i <= 60; ++i) {
+        lhs.push_back(APFloat(i * 0.75, APFloatPrec::Double()));
+        rhs.push_back(APFloat(1.0 / i, APFloatPrec::Double()));
+    }
+    std::vector<APFloatOperation> operations;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        operations.push_back({ APFloatOp(i % 6), &lhs[i], &rhs[i] });
+    }
+    std::vector<APFloat> results(operations.size());
+    evaluate(operations, results);
+    for (size_t i = 0; i < operations.size(); ++i) {
+        APFloat const& a = lhs[i];
+        APFloat const& b = rhs[i];
+        APFloat const expected = reference[i % 6](a, b);
+        INFO("i = " << i);
+        CHECK(cmp(results[i], expected) == 0);
+    }
+    setParallelOptions({});
+}
@@ -0,0 +1,204 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+#include <APMath/ConstantFold.h>
+#include <APMath/Parallel.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+/// Evaluates the single operation `op(lhs, rhs)`
+static FoldValue fold(FoldOp op, APInt const& lhs, APInt const& rhs,
+                      FoldFlags flags = {}) {
+    FoldDAG dag;
+    FoldNode const node =
+        dag.binary(op, dag.constant(lhs), dag.constant(rhs), flags);
+    FoldResults results;
+    evaluate(dag, results);
+    return results[node];
+}
+
+TEST_CASE("ConstantFold arithmetic") {
+    size_t const bitwidth = GENERATE(1u, 8u, 64u, 65u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    for (int i = 0; i < 10; ++i) {
+        APInt const a = randomAPInt(rng, bitwidth);
+        APInt const b = btwor(randomAPInt(rng, bitwidth), APInt(1, bitwidth));
+        CHECK(fold(FoldOp::Add, a, b).intValue == add(a, b));
+        CHECK(fold(FoldOp::Sub, a, b).intValue == sub(a, b));
+        CHECK(fold(FoldOp::Mul, a, b).intValue == mul(a, b));
+        CHECK(fold(FoldOp::UDiv, a, b).intValue == udiv(a, b));
+        CHECK(fold(FoldOp::URem, a, b).intValue == urem(a, b));
+        CHECK(fold(FoldOp::Xor, a, b).intValue == btwxor(a, b));
+        CHECK(fold(FoldOp::ICmpULT, a, b).intValue ==
+              APInt(ucmp(a, b) < 0, 1));
+        CHECK(fold(FoldOp::ICmpSGE, a, b).intValue ==
+              APInt(scmp(a, b) >= 0, 1));
+        APInt const amount(rng() % bitwidth, bitwidth);
+        int const n = static_cast<int>(amount.to<uint64_t>());
+        CHECK(fold(FoldOp::Shl, a, amount).intValue == lshl(a, n));
+        CHECK(fold(FoldOp::AShr, a, amount).intValue == ashr(a, n));
+    }
+}
+
+TEST_CASE("ConstantFold poison") {
+    APInt const i8max = APInt::SMax(8);
+    APInt const one(1, 8);
+    CHECK(!fold(FoldOp::Add, i8max, one).poison);
+    CHECK(fold(FoldOp::Add, i8max, one, { .nsw = true }).poison);
+    CHECK(!fold(FoldOp::Add, i8max, one, { .nuw = true }).poison);
+    CHECK(fold(FoldOp::Add, APInt::UMax(8), one, { .nuw = true }).poison);
+    CHECK(fold(FoldOp::Sub, APInt(0, 8), one, { .nuw = true }).poison);
+    CHECK(fold(FoldOp::Sub, APInt::SMin(8), one, { .nsw = true }).poison);
+    CHECK(fold(FoldOp::Mul, APInt(16, 8), APInt(16, 8), { .nuw = true })
+              .poison);
+    CHECK(!fold(FoldOp::Mul, APInt(15, 8), APInt(17, 8), { .nuw = true })
+               .poison);
+    CHECK(fold(FoldOp::Mul, APInt(16, 8), APInt(8, 8), { .nsw = true })
+              .poison);
+    CHECK(!fold(FoldOp::Mul, APInt(16, 8), negate(APInt(8, 8)),
+                { .nsw = true })
+               .poison);
+    CHECK(fold(FoldOp::UDiv, one, APInt(0, 8)).poison);
+    CHECK(fold(FoldOp::SRem, APInt::SMin(8), APInt::UMax(8)).poison);
+    CHECK(fold(FoldOp::UDiv, APInt(7, 8), APInt(2, 8), { .exact = true })
+              .poison);
+    CHECK(!fold(FoldOp::UDiv, APInt(8, 8), APInt(2, 8), { .exact = true })
+               .poison);
+    CHECK(fold(FoldOp::Shl, one, APInt(8, 8)).poison);
+    CHECK(fold(FoldOp::Shl, APInt(0x40, 8), one, { .nsw = true }).poison);
+    CHECK(!fold(FoldOp::Shl, APInt(0x40, 8), one, { .nuw = true }).poison);
+    CHECK(fold(FoldOp::LShr, APInt(3, 8), one, { .exact = true }).poison);
+    CHECK(!fold(FoldOp::LShr, APInt(2, 8), one, { .exact = true }).poison);
+
+    /// Poison propagates through operations but not through the unselected
+    /// operand of a select
+    FoldDAG dag;
+    FoldNode const poison = dag.binary(FoldOp::UDiv, dag.constant(one),
+                                       dag.constant(APInt(0, 8)));
+    FoldNode const sum = dag.binary(FoldOp::Add, poison, dag.constant(one));
+    FoldNode const zero = dag.constant(APInt(0, 1));
+    FoldNode const selected =
+        dag.select(zero, poison, dag.constant(APInt(42, 8)));
+    FoldNode const selectedPoison =
+        dag.select(dag.constant(APInt(1, 1)), poison, sum);
+    FoldResults results;
+    evaluate(dag, results);
+    CHECK(results[sum].poison);
+    CHECK(!results[selected].poison);
+    CHECK(results[selected].intValue == APInt(42, 8));
+    CHECK(results[selectedPoison].poison);
+}
+
+TEST_CASE("ConstantFold casts and floats") {
+    FoldDAG dag;
+    auto const Double = APFloatPrec::Double();
+    auto const Single = APFloatPrec::Single();
+    FoldNode const x = dag.constant(APFloat(2.5, Double));
+    FoldNode const y = dag.constant(APFloat(-4.0, Double));
+    FoldNode const nan = dag.binary(FoldOp::FDiv,
+                                    dag.constant(APFloat(0.0, Double)),
+                                    dag.constant(APFloat(0.0, Double)));
+    FoldNode const product = dag.binary(FoldOp::FMul, x, y);
+    FoldNode const toInt = dag.cast(FoldOp::FPToSI, product, FoldType::Int(32));
+    FoldNode const toUInt =
+        dag.cast(FoldOp::FPToUI, product, FoldType::Int(32));
+    FoldNode const tooLarge =
+        dag.cast(FoldOp::FPToSI,
+                 dag.constant(APFloat(300.0, Double)),
+                 FoldType::Int(8));
+    FoldNode const nanToInt = dag.cast(FoldOp::FPToSI, nan, FoldType::Int(8));
+    FoldNode const ordered = dag.binary(FoldOp::FCmpOLT, nan, x);
+    FoldNode const less = dag.binary(FoldOp::FCmpOLT, y, x);
+    FoldNode const single =
+        dag.cast(FoldOp::FPCast, x, FoldType::Float(Single));
+    FoldNode const back = dag.cast(FoldOp::SIToFP, toInt,
+                                   FoldType::Float(Double));
+    FoldNode const bits = dag.cast(FoldOp::BitCast, single, FoldType::Int(32));
+    FoldNode const wide = dag.cast(FoldOp::SExt, toInt, FoldType::Int(100));
+    FoldNode const narrow = dag.cast(FoldOp::Trunc, wide, FoldType::Int(8));
+    FoldNode const narrowNSW = dag.cast(FoldOp::Trunc, wide, FoldType::Int(8),
+                                        { .nsw = true });
+    FoldNode const narrowNUW = dag.cast(FoldOp::Trunc, wide, FoldType::Int(8),
+                                        { .nuw = true });
+    FoldResults results;
+    evaluate(dag, results);
+    CHECK(results[product].floatValue.to<double>() == -10.0);
+    CHECK(results[toInt].intValue == negate(APInt(10, 32)));
+    CHECK(results[toUInt].poison);
+    CHECK(results[tooLarge].poison);
+    CHECK(results[nanToInt].poison);
+    CHECK(results[ordered].intValue == APInt(0, 1));
+    CHECK(results[less].intValue == APInt(1, 1));
+    CHECK(results[single].floatValue.precision() == Single);
+    CHECK(results[back].floatValue.to<double>() == -10.0);
+    CHECK(results[bits].intValue == APInt(0x4020'0000, 32));
+    CHECK(results[wide].intValue == negate(APInt(10, 100)));
+    CHECK(results[narrow].intValue == negate(APInt(10, 8)));
+    CHECK(!results[narrowNSW].poison);
+    CHECK(results[narrowNUW].poison);
+}
+
+TEST_CASE("ConstantFold CSE") {
+    FoldDAG dag;
+    FoldNode const a = dag.constant(APInt(3, 64));
+    FoldNode const b = dag.constant(APInt(5, 64));
+    CHECK(dag.constant(APInt(3, 64)) == a);
+    CHECK(dag.constant(APInt(3, 32)) != a);
+    FoldNode const sum = dag.binary(FoldOp::Add, a, b);
+    /// Commutative operands are canonicalized
+    CHECK(dag.binary(FoldOp::Add, b, a) == sum);
+    CHECK(dag.binary(FoldOp::Sub, a, b) != dag.binary(FoldOp::Sub, b, a));
+    /// Flags distinguish nodes
+    CHECK(dag.binary(FoldOp::Add, a, b, { .nsw = true }) != sum);
+    CHECK(dag.constant(APFloat(0.0, APFloatPrec::Double())) !=
+          dag.constant(APFloat(-0.0, APFloatPrec::Double())));
+    size_t const size = dag.size();
+    FoldNode const product = dag.binary(FoldOp::Mul, sum, sum);
+    CHECK(dag.binary(FoldOp::Mul,
+                     dag.binary(FoldOp::Add, b, a),
+                     dag.binary(FoldOp::Add, a, b)) == product);
+    CHECK(dag.size() == size + 1);
+    FoldResults results;
+    evaluate(dag, results);
+    CHECK(results[product].intValue == APInt(64, 64));
+}
+
+TEST_CASE("ConstantFold parallel") {
+    unsigned const numThreads = GENERATE(1u, 4u);
+    setParallelOptions({ .numThreads = numThreads, .batchSize = 16 });
+    std::mt19937_64 rng(numThreads);
+    std::vector<FoldDAG> dags(50);
+    std::vector<FoldNode> roots;
+    std::vector<APInt> expected;
+    for (auto& dag: dags) {
+        APInt const a = randomAPInt(rng, 130);
+        APInt const b = randomAPInt(rng, 130);
+        APInt const c = randomAPInt(rng, 130);
+        FoldNode const x = dag.constant(a);
+        FoldNode const y = dag.constant(b);
+        FoldNode const z = dag.constant(c);
+        FoldNode const product = dag.binary(FoldOp::Mul, y, x);
+        FoldNode const root =
+            dag.binary(FoldOp::Xor, dag.binary(FoldOp::Mul, x, y),
+                       dag.binary(FoldOp::Sub, z, product));
+        roots.push_back(root);
+        expected.push_back(btwxor(mul(a, b), sub(c, mul(a, b))));
+    }
+    std::vector<FoldResults> results(dags.size());
+    evaluate(std::span<FoldDAG const>(dags), results);
+    /// Evaluating again reuses the results
+    evaluate(std::span<FoldDAG const>(dags), results);
+    for (size_t i = 0; i < dags.size(); ++i) {
+        CHECK(results[i][roots[i]].intValue == expected[i]);
+        CHECK(results[i].size() == dags[i].size());
+    }
+    setParallelOptions({});
+}
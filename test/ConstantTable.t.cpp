@@ -0,0 +1,79 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/ConstantTable.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+static std::vector<APInt> randomValues(size_t count) {
+    std::mt19937_64 rng(count);
+    std::vector<APInt> values;
+    for (size_t i = 0; i < count; ++i) {
+        values.push_back(randomAPInt(rng, 1 + rng() % 500));
+    }
+    return values;
+}
+
+TEST_CASE("ConstantTable from bytes") {
+    size_t const count = GENERATE(0u, 1u, 3u, 100u);
+    auto const values = randomValues(count);
+    auto const bytes = writeConstantTable(values);
+    auto const table = ConstantTable::fromBytes(bytes);
+    REQUIRE(table);
+    REQUIRE(table->size() == values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        APIntView const entry = (*table)[i];
+        CHECK(entry.bitwidth() == values[i].bitwidth());
+        CHECK(entry == APIntView(values[i]));
+        /// Entries are views into the buffer
+        CHECK(entry.limbs().data() >=
+              reinterpret_cast<uint64_t const*>(bytes.data()));
+    }
+}
+
+TEST_CASE("ConstantTable invalid") {
+    auto const values = randomValues(10);
+    auto bytes = writeConstantTable(values);
+    /// Truncated tables
+    for (size_t size: { size_t(0), size_t(8), size_t(40), bytes.size() - 8 }) {
+        CHECK(!ConstantTable::fromBytes({ bytes.data(), size }));
+    }
+    /// Wrong magic
+    auto badMagic = bytes;
+    badMagic[0] = std::byte('X');
+    CHECK(!ConstantTable::fromBytes(badMagic));
+    /// Bits above the bitwidth of the last entry
+    auto badLimb = bytes;
+    badLimb.back() = std::byte(0xFF);
+    if (values.back().bitwidth() % 64 != 0) {
+        CHECK(!ConstantTable::fromBytes(badLimb));
+    }
+}
+
+TEST_CASE("ConstantTable file") {
+    auto const values = randomValues(50);
+    auto const path = std::filesystem::temp_directory_path() /
+                      "APMath-ConstantTable-test.bin";
+    REQUIRE(writeConstantTable(values, path.string()));
+    {
+        auto table = ConstantTable::open(path.string());
+        REQUIRE(table);
+        REQUIRE(table->size() == values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            CHECK((*table)[i].toAPInt() == values[i]);
+        }
+        ConstantTable moved = std::move(*table);
+        CHECK(moved[7] == APIntView(values[7]));
+    }
+    std::filesystem::remove(path);
+    CHECK(!ConstantTable::open(path.string()));
+}
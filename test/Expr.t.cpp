@@ -0,0 +1,102 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/Expr.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+TEST_CASE("Expr elementwise") {
+    size_t const bitwidth = GENERATE(1u, 7u, 64u, 65u, 128u, 300u);
+    std::mt19937_64 rng(bitwidth);
+    for (int i = 0; i < 20; ++i) {
+        APInt const a = randomAPInt(rng, bitwidth);
+        APInt const b = randomAPInt(rng, bitwidth);
+        APInt const c = randomAPInt(rng, bitwidth);
+        CHECK(expr::evaluate(expr::add(a, b)) == add(a, b));
+        CHECK(expr::evaluate(expr::sub(a, b)) == sub(a, b));
+        CHECK(expr::evaluate(expr::btwnot(a)) == btwnot(a));
+        CHECK(expr::evaluate(expr::btwxor(expr::btwor(a, b), c)) ==
+              btwxor(btwor(a, b), c));
+        CHECK(expr::evaluate(expr::sub(expr::add(a, expr::btwnot(b)),
+                                       expr::btwand(b, c))) ==
+              sub(add(a, btwnot(b)), btwand(b, c)));
+        /// Carries through all limbs
+        APInt const max = APInt::UMax(bitwidth);
+        APInt const one(1, bitwidth);
+        CHECK(expr::evaluate(expr::add(max, one)) == APInt(0, bitwidth));
+        CHECK(expr::evaluate(expr::sub(APInt(0, bitwidth), one)) == max);
+    }
+}
+
+TEST_CASE("Expr shifts") {
+    size_t const bitwidth = GENERATE(8u, 64u, 65u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const a = randomAPInt(rng, bitwidth);
+    APInt const b = randomAPInt(rng, bitwidth);
+    for (int n: { 0, 1, 7, 63, 64, 65, 130, 199 }) {
+        if ((size_t)n >= bitwidth) {
+            continue;
+        }
+        CHECK(expr::evaluate(expr::lshl(a, n)) == lshl(a, n));
+        CHECK(expr::evaluate(expr::lshr(a, n)) == lshr(a, n));
+        CHECK(expr::evaluate(expr::ashr(a, n)) == ashr(a, n));
+        CHECK(expr::evaluate(expr::ashr(APInt::SMin(bitwidth), n)) ==
+              ashr(APInt::SMin(bitwidth), n));
+        /// Shifts of compound expressions
+        CHECK(expr::evaluate(expr::lshr(expr::add(a, b), n)) ==
+              lshr(add(a, b), n));
+        CHECK(expr::evaluate(expr::ashr(expr::btwnot(a), n)) ==
+              ashr(btwnot(a), n));
+        CHECK(expr::evaluate(expr::btwor(expr::lshl(a, n), expr::lshr(b, n))) ==
+              btwor(lshl(a, n), lshr(b, n)));
+    }
+}
+
+TEST_CASE("Expr mul and div") {
+    size_t const bitwidth = GENERATE(32u, 64u, 130u, 256u);
+    std::mt19937_64 rng(bitwidth);
+    APInt const a = randomAPInt(rng, bitwidth);
+    APInt const b = randomAPInt(rng, bitwidth);
+    APInt const c = randomAPInt(rng, bitwidth);
+    APInt const d = btwor(randomAPInt(rng, bitwidth), APInt(1, bitwidth));
+    CHECK(expr::evaluate(expr::add(expr::mul(a, b), expr::btwand(c, d))) ==
+          add(mul(a, b), btwand(c, d)));
+    CHECK(expr::evaluate(expr::udiv(expr::add(a, b), d)) ==
+          udiv(add(a, b), d));
+    CHECK(expr::evaluate(expr::urem(a, d)) == urem(a, d));
+    CHECK(expr::evaluate(expr::sdiv(a, d)) == sdiv(a, d));
+    CHECK(expr::evaluate(expr::srem(a, d)) == srem(a, d));
+    CHECK(expr::evaluate(expr::lshr(expr::mul(a, b), 3)) ==
+          lshr(mul(a, b), 3));
+}
+
+TEST_CASE("Expr assign") {
+    size_t const bitwidth = GENERATE(64u, 200u);
+    std::mt19937_64 rng(bitwidth);
+    APInt a = randomAPInt(rng, bitwidth);
+    APInt const b = randomAPInt(rng, bitwidth);
+    APInt const a0 = a;
+    /// Destination as elementwise operand
+    expr::assign(a, expr::btwxor(expr::add(a, b), b));
+    CHECK(a == btwxor(add(a0, b), b));
+    /// Destination as shift operand
+    a = a0;
+    int const n = static_cast<int>(bitwidth / 2 + 3);
+    expr::assign(a, expr::btwor(expr::lshl(a, n), expr::lshr(a, 3)));
+    CHECK(a == btwor(lshl(a0, n), lshr(a0, 3)));
+    /// Destination as mul operand
+    a = a0;
+    expr::assign(a, expr::sub(expr::mul(a, a), a));
+    CHECK(a == sub(mul(a0, a0), a0));
+    /// Destination of different width
+    APInt dest(5, 8);
+    expr::assign(dest, expr::add(a0, b));
+    CHECK(dest == add(a0, b));
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+#include <APMath/Instrumentation.h>
+
+using namespace APMath;
+
+TEST_CASE("Instrumentation counters") {
+    resetInstrumentation();
+    {
+        APInt const a(7, 200);
+        APInt const b(3, 200);
+        APInt c = add(a, b);
+        c = mul(c, b);
+        auto [q, r] = sdivrem(c, negate(b));
+        (void)q;
+        (void)r;
+        (void)divExact(c, b);
+        (void)sdivExact(c, negate(b));
+        APFloat const x(1.5, APFloatPrec::Double());
+        (void)add(x, x);
+    }
+    auto const snapshot = instrumentationSnapshot();
+    if constexpr (!InstrumentationEnabled) {
+        CHECK(snapshot[InstrumentedOp::Add].calls == 0);
+        CHECK(snapshot.allocations == 0);
+        return;
+    }
+    CHECK(snapshot[InstrumentedOp::Add].calls >= 1);
+    CHECK(snapshot[InstrumentedOp::Mul].calls == 1);
+    CHECK(snapshot[InstrumentedOp::SDivRem].calls == 1);
+    /// Signed division is implemented with unsigned division
+    CHECK(snapshot[InstrumentedOp::UDivRem].calls == 1);
+    /// Each exact division is counted once
+    CHECK(snapshot[InstrumentedOp::DivExact].calls == 2);
+    CHECK(snapshot[InstrumentedOp::FAdd].calls == 1);
+    /// 200 bits lie in the bucket `(128, 256]`
+    CHECK(snapshot[InstrumentedOp::Mul].bitwidthHistogram[8] == 1);
+    CHECK(snapshot[InstrumentedOp::FAdd].bitwidthHistogram[6] == 1);
+    CHECK(snapshot.allocations > 0);
+    CHECK(snapshot.allocations == snapshot.deallocations);
+    CHECK(snapshot.currentBytes == 0);
+    CHECK(snapshot.peakBytes >= 3 * 32);
+    auto const json = snapshot.toJSON();
+    CHECK(json.find("\"Mul\":{\"calls\":1,") != std::string::npos);
+    CHECK(json.find("\"256\":1") != std::string::npos);
+    CHECK(json.find("\"BtwAnd\"") == std::string::npos);
+}
+
+TEST_CASE("Instrumentation reset per thread") {
+    resetInstrumentation();
+    (void)mul(APInt(3, 64), APInt(5, 64));
+    std::thread([] {
+        resetInstrumentation();
+        (void)mul(APInt(3, 64), APInt(5, 64));
+        (void)mul(APInt(3, 64), APInt(5, 64));
+    }).join();
+    auto snapshot = instrumentationSnapshot();
+    CHECK(snapshot[InstrumentedOp::Mul].calls ==
+          (InstrumentationEnabled ? 1 : 0));
+    resetInstrumentation();
+    snapshot = instrumentationSnapshot();
+    CHECK(snapshot[InstrumentedOp::Mul].calls == 0);
+    CHECK(snapshot.toJSON().starts_with("{\"operations\":{}"));
+}
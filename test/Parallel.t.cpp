@@ -0,0 +1,56 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <APMath/APInt.h>
+#include <APMath/Parallel.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+TEST_CASE("Parallel options") {
+    setParallelOptions({ .numThreads = 3, .cutoff = 100 });
+    CHECK(parallelOptions().numThreads == 3);
+    CHECK(parallelOptions().cutoff == 100);
+    setParallelOptions({ .numThreads = 0 });
+    CHECK(parallelOptions().numThreads >= 1);
+    setParallelOptions({});
+    CHECK(parallelOptions().numThreads == 1);
+}
+
+TEST_CASE("Parallel mul and toString") {
+    size_t const numLimbs = GENERATE(300u, 5000u);
+    std::mt19937_64 rng(numLimbs);
+    size_t const bitwidth = 128 * numLimbs;
+    APInt const a = zext(randomAPInt(rng, 64 * numLimbs), bitwidth);
+    APInt const b = zext(randomAPInt(rng, 64 * numLimbs - 3), bitwidth);
+    APInt const product = mul(a, b);
+    APInt const square = mul(a, a);
+    std::string const str = product.toString(10);
+    setParallelOptions({ .numThreads = 4, .cutoff = 40 });
+    CHECK(mul(a, b) == product);
+    CHECK(mul(a, a) == square);
+    CHECK(product.toString(10) == str);
+    setParallelOptions({});
+}
+
+TEST_CASE("Parallel mul below cutoff") {
+    /// With a pool but a cutoff above the operand size the NTT residues are
+    /// computed on the calling thread and share their scratch space
+    size_t const numLimbs = 5000;
+    std::mt19937_64 rng(numLimbs);
+    size_t const bitwidth = 128 * numLimbs;
+    APInt const a = zext(randomAPInt(rng, 64 * numLimbs), bitwidth);
+    APInt const b = zext(randomAPInt(rng, 64 * numLimbs), bitwidth);
+    APInt const product = mul(a, b);
+    APInt const square = mul(a, a);
+    setParallelOptions({ .numThreads = 4, .cutoff = 1 << 20 });
+    CHECK(mul(a, b) == product);
+    CHECK(mul(a, a) == square);
+    setParallelOptions({});
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+#include <APMath/Conversion.h>
+#include <APMath/Serialize.h>
+
+#include "Test.h"
+
+using namespace APMath;
+using test::randomAPInt;
+
+static std::vector<std::byte> serialize(APInt const& value) {
+    std::vector<std::byte> buffer(serializedSize(value));
+    CHECK(serialize(value, buffer) == buffer.size());
+    return buffer;
+}
+
+TEST_CASE("Serialize APInt - 1") {
+    /// 64 bit zero: Header, payload size and no payload bytes
+    CHECK(serialize(APInt(0, 64)) ==
+          std::vector{ std::byte(0x80), std::byte(0x01), std::byte(0) });
+    /// 8 bit 5
+    CHECK(serialize(APInt(5, 8)) ==
+          std::vector{ std::byte(16), std::byte(1), std::byte(5) });
+    /// -1 of any width is stored as complement without payload bytes
+    CHECK(serialize(APInt::UMax(4096)).size() == 2 + 1);
+    CHECK(serialize(negate(APInt(2, 1000))).size() == 2 + 1 + 1);
+    CHECK(serialize(APInt(300, 1000)).size() == 2 + 1 + 2);
+}
+
+TEST_CASE("Serialize APInt - 2") {
+    size_t const bitwidth = GENERATE(1u, 7u, 8u, 63u, 64u, 65u, 200u, 4096u);
+    std::mt19937_64 rng(bitwidth);
+    std::vector<APInt> values = { APInt(0, bitwidth),
+                                  APInt(1, bitwidth),
+                                  APInt::UMax(bitwidth),
+                                  APInt::SMin(bitwidth),
+                                  APInt::SMax(bitwidth) };
+    for (int i = 0; i < 20; ++i) {
+        values.push_back(randomAPInt(rng, bitwidth));
+        values.push_back(lshr(randomAPInt(rng, bitwidth), rng() % bitwidth));
+        values.push_back(ashr(randomAPInt(rng, bitwidth), rng() % bitwidth));
+    }
+    for (auto& value: values) {
+        auto const buffer = serialize(value);
+        std::span<std::byte const> bytes = buffer;
+        auto const result = deserializeAPInt(bytes);
+        REQUIRE(result);
+        CHECK(*result == value);
+        CHECK(result->bitwidth() == bitwidth);
+        CHECK(bytes.empty());
+    }
+    auto const bulk = serialize(std::span<APInt const>(values));
+    auto const result = deserializeAPInts(bulk);
+    REQUIRE(result);
+    CHECK(*result == values);
+}
+
+TEST_CASE("Serialize APInt invalid") {
+    auto buffer = serialize(APInt(0x1234, 16));
+    for (size_t size = 0; size < buffer.size(); ++size) {
+        std::span<std::byte const> bytes(buffer.data(), size);
+        CHECK(!deserializeAPInt(bytes));
+        CHECK(bytes.size() == size);
+    }
+    /// Payload bits above the bitwidth
+    std::vector const tooWide = { std::byte(2 * 4), std::byte(1),
+                                  std::byte(0x10) };
+    std::span<std::byte const> bytes = tooWide;
+    CHECK(!deserializeAPInt(bytes));
+    /// Zero bitwidth
+    std::vector const zeroWidth = { std::byte(0), std::byte(0) };
+    bytes = zeroWidth;
+    CHECK(!deserializeAPInt(bytes));
+    /// Trailing bytes in bulk encoding
+    auto bulk = serialize(std::vector{ APInt(1, 8) });
+    bulk.push_back(std::byte(0));
+    CHECK(!deserializeAPInts(bulk));
+}
+
+TEST_CASE("Serialize APFloat") {
+    std::vector<APFloat> values = { APFloat(1.5, APFloatPrec::Double()),
+                                    APFloat(-0.0, APFloatPrec::Double()),
+                                    APFloat(3.25, APFloatPrec::Single()),
+                                    APFloat(1e300, APFloatPrec::Double()) };
+    for (auto& value: values) {
+        std::vector<std::byte> buffer(serializedSize(value));
+        CHECK(serialize(value, buffer) == buffer.size());
+        std::span<std::byte const> bytes = buffer;
+        auto const result = deserializeAPFloat(bytes);
+        REQUIRE(result);
+        CHECK(result->precision() == value.precision());
+        CHECK(bitcast<APInt>(*result) == bitcast<APInt>(value));
+        CHECK(bytes.empty());
+    }
+    CHECK(serializedSize(values[0]) == 2 + 8);
+    CHECK(serializedSize(values[2]) == 2 + 4);
+    auto const bulk = serialize(std::span<APFloat const>(values));
+    auto const result = deserializeAPFloats(bulk);
+    REQUIRE(result);
+    CHECK(result->size() == values.size());
+}
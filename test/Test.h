@@ -0,0 +1,26 @@
+#ifndef APMATH_TEST_TEST_H_
+#define APMATH_TEST_TEST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <APMath/APInt.h>
+
+/// Helpers shared by the tests.
+
+namespace APMath::test {
+
+/// \Returns a uniformly distributed \p bitwidth bit integer
+inline APInt randomAPInt(std::mt19937_64& rng, std::size_t bitwidth) {
+    std::vector<std::uint64_t> limbs((bitwidth + 63) / 64);
+    for (auto& limb: limbs) {
+        limb = rng();
+    }
+    return APInt(limbs, bitwidth);
+}
+
+} // namespace APMath::test
+
+#endif // APMATH_TEST_TEST_H_
@@ -0,0 +1,109 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <APMath/APFloat.h>
+#include <APMath/APInt.h>
+#include <APMath/Instrumentation.h>
+#include <APMath/Serialize.h>
+#include <APMath/Trace.h>
+
+using namespace APMath;
+
+/// Encodes a trace of the operations \p ops with the operands \p operands
+static std::vector<std::byte> encodeTrace(std::vector<APIntOp> const& ops,
+                                          std::vector<APInt> const& operands) {
+    std::vector<std::byte> bytes(8);
+    std::memcpy(bytes.data(), "APMTRC1", 8);
+    for (size_t i = 0; i < ops.size(); ++i) {
+        bytes.push_back(std::byte(ops[i]));
+        for (auto const& operand: { operands[2 * i], operands[2 * i + 1] }) {
+            size_t const pos = bytes.size();
+            bytes.resize(pos + serializedSize(operand));
+            serialize(operand, std::span(bytes).subspan(pos));
+        }
+    }
+    return bytes;
+}
+
+TEST_CASE("Trace recording") {
+    auto const path = std::filesystem::temp_directory_path() /
+                      "APMath-Trace-recording.trace";
+    if constexpr (!InstrumentationEnabled) {
+        CHECK(!startTrace(path.string()));
+        return;
+    }
+    APInt const a(1000, 100);
+    APInt const b(-7, 100);
+    APFloat const x(2.0, APFloatPrec::Double());
+    REQUIRE(startTrace(path.string()));
+    CHECK(!startTrace(path.string()));
+    (void)mul(a, b);
+    /// Recorded as one `SDiv`, the nested unsigned division is not recorded
+    (void)sdivrem(a, b);
+    (void)lshr(a, 3);
+    (void)pow(x, x);
+    REQUIRE(stopTrace());
+    (void)add(a, b);
+    auto const trace = Trace::read(path.string());
+    std::filesystem::remove(path);
+    REQUIRE(trace);
+    REQUIRE(trace->entries.size() == 4);
+    auto const mulOp = trace->intOperation(trace->entries[0]);
+    CHECK(mulOp.op == APIntOp::Mul);
+    CHECK(*mulOp.lhs == a);
+    CHECK(*mulOp.rhs == b);
+    CHECK(trace->intOperation(trace->entries[1]).op == APIntOp::SDiv);
+    auto const shiftOp = trace->intOperation(trace->entries[2]);
+    CHECK(shiftOp.op == APIntOp::LShr);
+    CHECK(*shiftOp.rhs == APInt(3, 100));
+    REQUIRE(trace->entries[3].isFloat);
+    CHECK(trace->floatOperation(trace->entries[3]).op == APFloatOp::Pow);
+}
+
+TEST_CASE("Trace invalid") {
+    std::vector<APInt> const operands = { APInt(5, 64), APInt(0, 64) };
+    CHECK(Trace::fromBytes(encodeTrace({ APIntOp::Add }, operands)));
+    /// Division by zero
+    CHECK(!Trace::fromBytes(encodeTrace({ APIntOp::UDiv }, operands)));
+    /// Shift amount out of range
+    CHECK(!Trace::fromBytes(encodeTrace({ APIntOp::LShl },
+                                        { operands[1], APInt(64, 64) })));
+    auto bytes = encodeTrace({ APIntOp::Add }, operands);
+    bytes.pop_back();
+    CHECK(!Trace::fromBytes(bytes));
+    bytes = encodeTrace({ APIntOp::Add }, operands);
+    bytes[0] = std::byte('X');
+    CHECK(!Trace::fromBytes(bytes));
+    /// Unknown opcode
+    bytes = encodeTrace({ APIntOp::Add }, operands);
+    bytes[8] = std::byte(0x7F);
+    CHECK(!Trace::fromBytes(bytes));
+}
+
+TEST_CASE("Trace replay") {
+    std::vector<APInt> const operands = { APInt(123456789, 200),
+                                          APInt(987, 200),
+                                          APInt(123456789, 200),
+                                          APInt(987, 200),
+                                          APInt(5, 8),
+                                          APInt(3, 8) };
+    auto const trace = Trace::fromBytes(
+        encodeTrace({ APIntOp::Mul, APIntOp::UDiv, APIntOp::LShl }, operands));
+    REQUIRE(trace);
+    auto const statistics = replay(*trace, 5);
+    CHECK(statistics.numOperations == 15);
+    REQUIRE(statistics.operations.size() == 3);
+    CHECK(statistics.operations[0].name == "APInt.Mul");
+    CHECK(statistics.operations[1].name == "APInt.UDiv");
+    CHECK(statistics.operations[2].name == "APInt.LShl");
+    for (auto& op: statistics.operations) {
+        CHECK(op.count == 5);
+        CHECK(op.p50 <= op.p90);
+        CHECK(op.p90 <= op.p99);
+        CHECK(op.p99 <= op.max);
+    }
+    CHECK(statistics.toString().find("APInt.UDiv") != std::string::npos);
+}
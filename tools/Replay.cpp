@@ -0,0 +1,33 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <APMath/Trace.h>
+
+/// Replays a trace recorded with `APMath::startTrace()` and prints throughput
+/// and latency percentiles per operation.
+///
+/// Usage: replay <trace-file> [repetitions]
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "Usage: %s <trace-file> [repetitions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::size_t repetitions = 1;
+    if (argc == 3) {
+        repetitions = std::strtoul(argv[2], nullptr, 10);
+        if (repetitions == 0) {
+            std::fprintf(stderr, "Invalid repetition count: %s\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+    }
+    auto const trace = APMath::Trace::read(argv[1]);
+    if (!trace) {
+        std::fprintf(stderr, "Failed to read trace: %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    auto const statistics = APMath::replay(*trace, repetitions);
+    std::fputs(statistics.toString().c_str(), stdout);
+    return EXIT_SUCCESS;
+}